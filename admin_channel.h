@@ -0,0 +1,213 @@
+#ifndef ADMIN_CHANNEL_H
+#define ADMIN_CHANNEL_H
+
+#include <string>
+#include <atomic>
+#include <cstring>
+#include <cerrno>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "line_reader.h"
+
+// Komutu işleyip yanıt metnini döner; yönetim bağlantısının thread'inde çağrılır.
+typedef std::string (*AdminCommandFn)(const std::string& command);
+
+// Sunucunun yerel Unix soketi üzerinden yönetimi. Her bağlantı kendi thread'inde
+// satır satır komut okur; her yanıtın sonunda tek başına "." satırı gelir ("." ile
+// başlayan yanıt satırları ".." olarak kaçırılır). Soket yalnızca sahibine açıktır.
+//   socat - UNIX-CONNECT:borsa_admin.sock   veya   ./admin_cli ISTATISTIK
+class AdminChannel {
+private:
+    static const int MAX_CONNECTIONS = 64;
+
+    AdminCommandFn handler;
+    std::string path;
+    int listenSocket;
+    pthread_t acceptThread;
+    bool started;
+    std::atomic<bool> running;
+    std::atomic<int> connections;
+    std::atomic<int> busy;              // yanıtı hazırlanan veya gönderilen komut
+    std::atomic<long long> commands;
+    std::atomic<long long> refused;
+
+    AdminChannel(const AdminChannel&);
+    AdminChannel& operator=(const AdminChannel&);
+
+    struct Connection {
+        AdminChannel* channel;
+        int socket;
+    };
+
+    static void* acceptMain(void* arg) {
+        ((AdminChannel*)arg)->acceptLoop();
+        return NULL;
+    }
+
+    static void* connectionMain(void* arg) {
+        Connection* connection = (Connection*)arg;
+        connection->channel->serve(connection->socket);
+        delete connection;
+        return NULL;
+    }
+
+    static bool sendAll(int socket, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(socket, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            sent += n;
+        }
+        return true;
+    }
+
+    static std::string frame(const std::string& reply) {
+        std::string out;
+        out.reserve(reply.size() + 8);
+        size_t start = 0;
+        while (start < reply.size()) {
+            size_t newline = reply.find('\n', start);
+            size_t end = newline == std::string::npos ? reply.size() : newline;
+            if (reply[start] == '.') out += '.';
+            out.append(reply, start, end - start);
+            out += '\n';
+            start = end + 1;
+        }
+        out += ".\n";
+        return out;
+    }
+
+    void acceptLoop() {
+        while (running.load()) {
+            int socket = accept(listenSocket, NULL, NULL);
+            if (socket < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                break;
+            }
+            if (connections.load() >= MAX_CONNECTIONS) {
+                refused.fetch_add(1);
+                sendAll(socket, frame("HATA|Yonetim baglanti siniri dolu"));
+                close(socket);
+                continue;
+            }
+
+            Connection* connection = new Connection();
+            connection->channel = this;
+            connection->socket = socket;
+            connections.fetch_add(1);
+            pthread_t thread;
+            if (pthread_create(&thread, NULL, connectionMain, connection) != 0) {
+                connections.fetch_sub(1);
+                close(socket);
+                delete connection;
+                continue;
+            }
+            pthread_detach(thread);
+        }
+    }
+
+    void serve(int socket) {
+        LineReader reader(false);
+        std::string line;
+        char buffer[1024];
+        bool open = true;
+        while (open && running.load()) {
+            ssize_t n = recv(socket, buffer, sizeof(buffer), 0);
+            if (n <= 0 || !reader.append(buffer, n)) break;
+
+            while (open && reader.next(line)) {
+                if (line == "quit") {
+                    open = false;
+                    break;
+                }
+                busy.fetch_add(1);
+                commands.fetch_add(1, std::memory_order_relaxed);
+                open = sendAll(socket, frame(handler(line)));
+                busy.fetch_sub(1);
+            }
+        }
+        close(socket);
+        connections.fetch_sub(1);
+    }
+
+public:
+    explicit AdminChannel(AdminCommandFn commandHandler)
+        : handler(commandHandler), listenSocket(-1), started(false), running(false),
+          connections(0), busy(0), commands(0), refused(0) {}
+
+    bool start(const std::string& socketPath) {
+        if (started || socketPath.empty()) return false;
+
+        struct sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path)) return false;
+        strcpy(address.sun_path, socketPath.c_str());
+
+        listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenSocket < 0) return false;
+
+        // Önceki çalışmadan kalan soket dosyası silinir.
+        unlink(socketPath.c_str());
+        mode_t previous = umask(0077);
+        bool bound = bind(listenSocket, (struct sockaddr*)&address, sizeof(address)) == 0;
+        umask(previous);
+        if (!bound || listen(listenSocket, 16) < 0) {
+            close(listenSocket);
+            listenSocket = -1;
+            return false;
+        }
+
+        path = socketPath;
+        running.store(true);
+        if (pthread_create(&acceptThread, NULL, acceptMain, this) != 0) {
+            running.store(false);
+            close(listenSocket);
+            unlink(path.c_str());
+            return false;
+        }
+        started = true;
+        return true;
+    }
+
+    // Yeni bağlantı alınmaz; yanıtı gönderilmekte olan komutlar en fazla waitMs beklenir.
+    void stop(int waitMs) {
+        if (!started) return;
+        running.store(false);
+        shutdown(listenSocket, SHUT_RDWR);
+        pthread_join(acceptThread, NULL);
+        close(listenSocket);
+        unlink(path.c_str());
+        started = false;
+
+        for (int waited = 0; busy.load() > 0 && waited < waitMs; waited += 10) {
+            usleep(10000);
+        }
+    }
+
+    bool active() const {
+        return started;
+    }
+
+    const std::string& socketPath() const {
+        return path;
+    }
+
+    int connectionCount() const {
+        return connections.load();
+    }
+
+    long long commandCount() const {
+        return commands.load();
+    }
+
+    long long refusedCount() const {
+        return refused.load();
+    }
+};
+
+#endif
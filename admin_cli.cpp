@@ -0,0 +1,71 @@
+// Derleme: g++ -std=c++17 -O2 admin_cli.cpp -o admin_cli
+// Kullanım: ./admin_cli ISTATISTIK | ./admin_cli "DEFTER|THYAO|10" | ./admin_cli (stdin'den komutlar)
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "config_reader.h"
+#include "line_reader.h"
+
+using namespace std;
+
+// Yanıt "." satırıyla biter; ".." ile başlayan satırın ilk noktası kaçış karakteridir.
+bool readReply(int sock, LineReader& reader) {
+    string line;
+    char buffer[4096];
+    while (true) {
+        while (reader.next(line)) {
+            if (line == ".") return true;
+            cout << (line[0] == '.' ? line.substr(1) : line) << endl;
+        }
+        ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+        if (n <= 0 || !reader.append(buffer, n)) return false;
+    }
+}
+
+bool runCommand(int sock, LineReader& reader, const string& command) {
+    string line = command + "\n";
+    if (send(sock, line.c_str(), line.length(), MSG_NOSIGNAL) < 0) return false;
+    return readReply(sock, reader);
+}
+
+int main(int argc, char* argv[]) {
+    ConfigReader config;
+    config.load("config.ini");
+    string path = config.get("admin", "socket", "borsa_admin.sock");
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0 || connect(sock, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        cerr << "Yönetim soketine bağlanılamadı: " << path << endl;
+        return 1;
+    }
+
+    LineReader reader(false);
+    bool ok = true;
+    if (argc > 1) {
+        string command = argv[1];
+        for (int i = 2; i < argc; i++) {
+            command += string(" ") + argv[i];
+        }
+        ok = runCommand(sock, reader, command);
+    } else {
+        string command;
+        while (ok && getline(cin, command)) {
+            if (!command.empty()) ok = runCommand(sock, reader, command);
+        }
+    }
+
+    close(sock);
+    if (!ok) {
+        cerr << "Bağlantı kapandı." << endl;
+        return 1;
+    }
+    return 0;
+}
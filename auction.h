@@ -0,0 +1,91 @@
+#ifndef AUCTION_H
+#define AUCTION_H
+
+#include <vector>
+#include <utility>
+#include <cmath>
+
+// Fiyat seviyesi: (fiyat, toplam miktar). Alışlar azalan, satışlar artan fiyatla sıralı olmalıdır.
+typedef std::pair<double, long long> AuctionLevel;
+
+struct AuctionResult {
+    bool crossed;
+    double price;
+    long long volume;
+    long long buyVolume;
+    long long sellVolume;
+};
+
+// Denge fiyatı: işlem görebilecek hacmi (min(kümülatif alış, kümülatif satış))
+// en büyükleyen fiyat. Eşitlikte önce dengesizliği en küçük olan, sonra
+// referans fiyata en yakın olan seçilir. Aday fiyatlar yalnızca mevcut limit
+// fiyatlarıdır; iki taraf tek geçişte kümülatif olarak taranır.
+inline AuctionResult computeEquilibrium(const std::vector<AuctionLevel>& bids,
+                                        const std::vector<AuctionLevel>& asks,
+                                        double referencePrice) {
+    AuctionResult result;
+    result.crossed = false;
+    result.price = 0;
+    result.volume = 0;
+    result.buyVolume = 0;
+    result.sellVolume = 0;
+
+    if (bids.empty() || asks.empty() || bids.front().first < asks.front().first) {
+        return result;
+    }
+
+    // Aday fiyatlar artan sırada: satış fiyatları zaten artan, alışlar ters çevrilir.
+    std::vector<double> candidates;
+    size_t a = 0;
+    size_t b = bids.size();
+    while (a < asks.size() || b > 0) {
+        double next;
+        if (b == 0 || (a < asks.size() && asks[a].first <= bids[b - 1].first)) {
+            next = asks[a++].first;
+        } else {
+            next = bids[--b].first;
+        }
+        if (candidates.empty() || candidates.back() != next) candidates.push_back(next);
+    }
+
+    long long totalBuy = 0;
+    for (size_t i = 0; i < bids.size(); i++) totalBuy += bids[i].second;
+
+    // Fiyat arttıkça kümülatif alış azalır (p'den düşük limitli alışlar düşer),
+    // kümülatif satış artar (p'ye kadar olan satışlar eklenir).
+    long long cumulativeBuy = totalBuy;
+    long long cumulativeSell = 0;
+    size_t bidIndex = bids.size();
+    size_t askIndex = 0;
+    long long bestImbalance = 0;
+
+    for (size_t i = 0; i < candidates.size(); i++) {
+        double price = candidates[i];
+        while (bidIndex > 0 && bids[bidIndex - 1].first < price) {
+            cumulativeBuy -= bids[--bidIndex].second;
+        }
+        while (askIndex < asks.size() && asks[askIndex].first <= price) {
+            cumulativeSell += asks[askIndex++].second;
+        }
+
+        long long executable = cumulativeBuy < cumulativeSell ? cumulativeBuy : cumulativeSell;
+        if (executable <= 0) continue;
+
+        long long imbalance = std::llabs(cumulativeBuy - cumulativeSell);
+        bool better = executable > result.volume
+            || (executable == result.volume && imbalance < bestImbalance)
+            || (executable == result.volume && imbalance == bestImbalance
+                && std::fabs(price - referencePrice) < std::fabs(result.price - referencePrice));
+        if (better) {
+            result.crossed = true;
+            result.price = price;
+            result.volume = executable;
+            result.buyVolume = cumulativeBuy;
+            result.sellVolume = cumulativeSell;
+            bestImbalance = imbalance;
+        }
+    }
+    return result;
+}
+
+#endif
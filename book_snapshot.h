@@ -0,0 +1,132 @@
+#ifndef BOOK_SNAPSHOT_H
+#define BOOK_SNAPSHOT_H
+
+#include <string>
+#include <map>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+
+const int BOOK_SNAPSHOT_DEPTH = 10;
+
+struct BookLevel {
+    double price;
+    int quantity;
+    int orderCount;
+};
+
+struct BookSnapshot {
+    char symbol[16];
+    uint64_t version;
+    int64_t timestampNs;
+    int bidCount;
+    int askCount;
+    BookLevel bids[BOOK_SNAPSHOT_DEPTH];
+    BookLevel asks[BOOK_SNAPSHOT_DEPTH];
+};
+
+// Çift tamponlu seqlock: yazar pasif tampona yazıp aktif indeksi çevirir,
+// okuyucu kopyaladığı tamponun sıra numarası değişmemişse kopyayı kabul eder.
+class SnapshotSlot {
+private:
+    std::atomic<uint64_t> seq[2];
+    BookSnapshot buffers[2];
+    std::atomic<uint32_t> current;
+
+public:
+    SnapshotSlot() : current(0) {
+        seq[0].store(0);
+        seq[1].store(0);
+        memset(buffers, 0, sizeof(buffers));
+    }
+
+    void publish(const BookSnapshot& snapshot) {
+        uint32_t next = current.load(std::memory_order_relaxed) ^ 1;
+        seq[next].fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&buffers[next], &snapshot, sizeof(BookSnapshot));
+        seq[next].fetch_add(1, std::memory_order_release);
+        current.store(next, std::memory_order_release);
+    }
+
+    bool read(BookSnapshot& out) const {
+        for (int attempt = 0; attempt < 64; attempt++) {
+            uint32_t index = current.load(std::memory_order_acquire);
+            uint64_t before = seq[index].load(std::memory_order_acquire);
+            if (before & 1) continue;
+
+            memcpy(&out, &buffers[index], sizeof(BookSnapshot));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (seq[index].load(std::memory_order_relaxed) == before) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// Sembol yuvaları yalnızca eklenir; okuyucular count() kadarını kilitsiz gezer.
+// Yeni sembol ekleme ve publish tek yazar (eşleştirme tarafı) tarafından yapılır.
+class SnapshotRegistry {
+private:
+    static const int CHUNK_SIZE = 1024;
+    static const int MAX_CHUNKS = 128;
+
+    std::atomic<SnapshotSlot*> chunks[MAX_CHUNKS];
+    std::atomic<int> slotCount;
+    std::map<std::string, int> index;
+
+    SnapshotSlot* slotAt(int i) const {
+        return &chunks[i / CHUNK_SIZE].load(std::memory_order_acquire)[i % CHUNK_SIZE];
+    }
+
+public:
+    SnapshotRegistry() : slotCount(0) {
+        for (int i = 0; i < MAX_CHUNKS; i++) {
+            chunks[i].store(NULL);
+        }
+    }
+
+    ~SnapshotRegistry() {
+        for (int i = 0; i < MAX_CHUNKS; i++) {
+            delete[] chunks[i].load();
+        }
+    }
+
+    int slotFor(const std::string& symbol) {
+        std::map<std::string, int>::iterator it = index.find(symbol);
+        if (it != index.end()) return it->second;
+
+        int i = slotCount.load(std::memory_order_relaxed);
+        if (i >= CHUNK_SIZE * MAX_CHUNKS) return -1;
+
+        if (i % CHUNK_SIZE == 0) {
+            chunks[i / CHUNK_SIZE].store(new SnapshotSlot[CHUNK_SIZE], std::memory_order_release);
+        }
+
+        BookSnapshot empty;
+        memset(&empty, 0, sizeof(empty));
+        strncpy(empty.symbol, symbol.c_str(), sizeof(empty.symbol) - 1);
+        slotAt(i)->publish(empty);
+
+        index[symbol] = i;
+        slotCount.store(i + 1, std::memory_order_release);
+        return i;
+    }
+
+    void publish(int slot, const BookSnapshot& snapshot) {
+        if (slot >= 0) slotAt(slot)->publish(snapshot);
+    }
+
+    int count() const {
+        return slotCount.load(std::memory_order_acquire);
+    }
+
+    bool read(int slot, BookSnapshot& out) const {
+        if (slot < 0 || slot >= count()) return false;
+        return slotAt(slot)->read(out);
+    }
+};
+
+#endif
@@ -13,20 +13,139 @@
 #include <limits>
 #include <cmath>
 #include <sys/time.h>
+#include <pthread.h>
+#include <map>
+#include <deque>
+#include <fstream>
+#include <termios.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/file.h>
 #include "config_reader.h"
 #include "json_parser.h"
 #include "order_manager.h"
+#include "line_reader.h"
+#include "terminal_screen.h"
+#include "strategy_runner.h"
+#include "momentum_strategy.h"
+#include "random_token.h"
 
 using namespace std;
 
 class StockClient {
 private:
+    // Yerel emir kaydı ve server bildirimlerinden biriken dolum bilgisi.
+    struct TrackedOrder {
+        Order record;
+        string ref;
+        string wire;            // yeniden bağlanınca aynı referansla tekrar gönderilir
+        int filledQuantity;
+        double filledAmount;
+    };
+    
+    // Canlı ekran için abonelik mesajlarından tutulan sembol görünümü.
+    struct SymbolView {
+        map<double, pair<int, int>, greater<double> > bids;     // fiyat -> (adet, emir sayısı)
+        map<double, pair<int, int> > asks;
+        uint64_t version;
+        double lastPrice;
+        int lastQuantity;
+        long long volume;       // abonelikten bu yana
+        int trades;
+        int direction;          // son işlem fiyatı yönü: 1, -1, 0
+        
+        SymbolView() : version(0), lastPrice(0), lastQuantity(0), volume(0), trades(0), direction(0) {}
+    };
+    
+    // Stratejinin gönderdiği emir; yanıt gelene kadar referansın yuvasında tutulur.
+    struct StrategySlot {
+        int ref;
+        char symbol[STRATEGY_SYMBOL_SIZE];
+        bool buy;
+        double price;
+        int quantity;
+    };
+    
+    // Strateji yalnızca bu arayüz üzerinden emir gönderir.
+    class StrategyPort : public StrategyContext {
+    private:
+        StockClient& client;
+        
+    public:
+        explicit StrategyPort(StockClient& owner) : client(owner) {}
+        
+        int sendOrder(const char* symbol, bool buy, double price, int quantity, const char* tif) {
+            return client.sendStrategyOrder(symbol, buy, price, quantity, tif);
+        }
+        
+        bool cancelOrder(const char* orderId) {
+            return client.sendStrategyCancel(orderId);
+        }
+        
+        void setTimer(int intervalMs) {
+            client.strategyRunner->setTimer(intervalMs);
+        }
+        
+        int64_t nowNs() const {
+            return StrategyRunner::monotonicNanos();
+        }
+    };
+    
+    static const int STRATEGY_SLOTS = 1024;
+    
     int clientSocket;
-    string clientId;
+    string clientId;            // kalıcı oturum anahtarı
+    string sessionToken;        // server'ın oturum açılışında verdiği sahiplik kanıtı
+    string sessionFile;
+    int sessionLock;            // sessionFile üzerinde tutulan flock; süreç boyunca bırakılmaz
+    string serverIp;
+    int serverPort;
+    int reconnectTimeout;
     vector<Stock> stocks;
     StockConfigParser parser;
     OrderManager orderManager;
     
+    // Aşağıdaki alanlar okuma thread'i ile paylaşılır, stateMutex ile korunur.
+    pthread_t readerThread;
+    bool readerStarted;
+    pthread_mutex_t stateMutex;
+    pthread_cond_t stateChanged;
+    bool connected;
+    bool shuttingDown;
+    bool readerDone;
+    bool goodbyeReceived;
+    int maxOutstanding;
+    int nextRef;
+    uint64_t lastSeq;                             // son işlenen server mesaj numarası
+    map<string, TrackedOrder> awaitingAck;        // referans -> yanıt bekleyen emir
+    map<string, TrackedOrder> trackedOrders;      // emir ID -> kabul edilen emir
+    map<string, vector<string> > earlyEvents;     // kabulden önce gelen bildirimler
+    deque<string> replies;                        // sorgu yanıt satırları
+    map<string, SymbolView> market;
+    deque<string> recentEvents;                   // saatli son bildirimler
+    bool dashboardActive;
+    bool dashboardDirty;
+    long long marketMessages;
+    int dashboardFps;
+    
+    // Otomatik strateji. Emir yuvaları strateji thread'inde yazılır, okuma thread'inde
+    // okunur; ikisi de stateMutex altında.
+    Strategy* strategy;
+    void* strategyLibrary;
+    string strategyName;
+    StrategyRunner* strategyRunner;
+    StrategyPort strategyPort;
+    StrategySlot strategySlots[STRATEGY_SLOTS];
+    int nextStrategyRef;
+    int strategyAwaiting;                         // yanıtı gelmemiş strateji emirleri
+    map<string, StrategySlot> strategyOrders;     // emir ID -> kabul edilen emir (quantity: kalan)
+    string strategyRefPrefix;
+    long long strategyOrdersSent;
+    long long strategyCancelsSent;
+    int64_t receivedNs;                           // son okunan paketin geliş anı
+    
     string toUpper(string str) {
         transform(str.begin(), str.end(), str.begin(), ::toupper);
         return str;
@@ -38,17 +157,34 @@ private:
     }
     
     bool isConnected() {
-        if (clientSocket < 0) return false;
-        
-        int error = 0;
-        socklen_t len = sizeof(error);
-        int retval = getsockopt(clientSocket, SOL_SOCKET, SO_ERROR, &error, &len);
-        
-        if (retval != 0 || error != 0) {
-            return false;
-        }
-        
-        return true;
+        pthread_mutex_lock(&stateMutex);
+        bool alive = connected;
+        pthread_mutex_unlock(&stateMutex);
+        return alive;
+    }
+    
+    // Okuma thread'i yeniden bağlanmaktan vazgeçtiyse true.
+    bool connectionLost() {
+        pthread_mutex_lock(&stateMutex);
+        bool lost = readerDone;
+        pthread_mutex_unlock(&stateMutex);
+        return lost;
+    }
+    
+    // stateMutex tutularak çağrılır; yeniden bağlanma sırasında soket değişebilir.
+    bool sendLocked(const char* data, size_t length) {
+        return connected && send(clientSocket, data, length, MSG_NOSIGNAL) == (ssize_t)length;
+    }
+    
+    bool sendLocked(const string& line) {
+        return sendLocked(line.data(), line.length());
+    }
+    
+    bool sendLine(const string& line) {
+        pthread_mutex_lock(&stateMutex);
+        bool sent = sendLocked(line);
+        pthread_mutex_unlock(&stateMutex);
+        return sent;
     }
     
     void displayStocks() {
@@ -188,108 +324,1210 @@ private:
             validQuantity = true;
         }
         
-        Order order = orderManager.createOrder(clientId, selectedStock.symbol, 
-                                             orderType, price, quantity, "EXECUTED");
+        pthread_mutex_lock(&stateMutex);
+        if (!connected || (int)awaitingAck.size() >= maxOutstanding) {
+            if (connected) {
+                cout << "Yanıt bekleyen " << awaitingAck.size() << " emir var, sıra bekleniyor..." << endl;
+            } else {
+                cout << "Bağlantı yeniden kuruluyor, bekleniyor..." << endl;
+            }
+            struct timespec deadline = deadlineAfter(5);
+            while (!readerDone && (!connected || (int)awaitingAck.size() >= maxOutstanding)) {
+                if (pthread_cond_timedwait(&stateChanged, &stateMutex, &deadline) == ETIMEDOUT) break;
+            }
+        }
+        if (!connected || (int)awaitingAck.size() >= maxOutstanding) {
+            bool offline = !connected;
+            pthread_mutex_unlock(&stateMutex);
+            if (offline) {
+                cout << "HATA: Server bağlantısı yok, emir gönderilmedi." << endl;
+            } else {
+                cout << "HATA: Yanıt bekleyen emir sınırına (" << maxOutstanding 
+                     << ") ulaşıldı, emir gönderilmedi." << endl;
+            }
+            clearInputBuffer();
+            return;
+        }
+        
+        TrackedOrder tracked;
+        tracked.record = orderManager.createOrder(clientId, selectedStock.symbol, 
+                                                  orderType, price, quantity, "SENT");
+        // Referans oturum boyunca tekildir; server aynı referansla gelen emri bir kez işler.
+        tracked.ref = to_string(++nextRef);
+        tracked.filledQuantity = 0;
+        tracked.filledAmount = 0;
+        
+        // Geçerlilik alanı boş bırakılır (server varsayılanı); son alan yanıt eşleştirme referansıdır.
+        stringstream orderMsg;
+        orderMsg << "EMIR|" << selectedStock.symbol << "|" << orderType 
+                 << "|" << price << "|" << quantity << "||" << tracked.ref << "\n";
+        tracked.wire = orderMsg.str();
+        
+        if (!orderManager.saveOrder(tracked.record)) {
+            pthread_mutex_unlock(&stateMutex);
+            cout << "Emir kayıt hatası!" << endl;
+            clearInputBuffer();
+            return;
+        }
+        awaitingAck[tracked.ref] = tracked;
+        saveSession();
+        // Gönderim koparsa emir bekleyenlerde kalır ve yeniden bağlanınca tekrar gönderilir.
+        bool sent = sendLocked(tracked.wire);
+        pthread_mutex_unlock(&stateMutex);
+        
+        cout << "\n=== EMİR ÖZETİ ===" << endl;
+        cout << "Hisse: " << selectedStock.symbol << endl;
+        cout << "İşlem: " << orderType << endl;
+        cout << "Fiyat: " << fixed << setprecision(2) << price << " TL" << endl;
+        cout << "Miktar: " << quantity << " adet" << endl;
+        cout << "Toplam: " << fixed << setprecision(2) << (price * quantity) << " TL" << endl;
+        
+        if (sent) {
+            cout << "Emir gönderildi (referans #" << tracked.ref 
+                 << "). Server yanıtı geldiğinde bildirilecek." << endl;
+        } else {
+            cout << "Bağlantı koptu; emir (referans #" << tracked.ref 
+                 << ") bağlantı yenilenince gönderilecek." << endl;
+        }
+        clearInputBuffer();
+    }
+    
+    static struct timespec deadlineAfter(int seconds) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += seconds;
+        return deadline;
+    }
+    
+    static void* readerMain(void* arg) {
+        ((StockClient*)arg)->readLoop();
+        return NULL;
+    }
+    
+    int openSocket() {
+        int sock = socket(AF_INET, SOCK_STREAM, 0);
+        if (sock < 0) {
+            return -1;
+        }
+        
+        struct sockaddr_in serverAddress;
+        memset(&serverAddress, 0, sizeof(serverAddress));
+        serverAddress.sin_family = AF_INET;
+        serverAddress.sin_port = htons(serverPort);
+        serverAddress.sin_addr.s_addr = inet_addr(serverIp.c_str());
         
-        if (orderManager.saveOrder(order)) {
-            cout << "\n=== EMİR ÖZETİ ===" << endl;
-            cout << "Hisse: " << selectedStock.symbol << endl;
-            cout << "İşlem: " << orderType << endl;
-            cout << "Fiyat: " << fixed << setprecision(2) << price << " TL" << endl;
-            cout << "Miktar: " << quantity << " adet" << endl;
-            cout << "Toplam: " << fixed << setprecision(2) << (price * quantity) << " TL" << endl;
-            cout << "\nEmir server'a gönderiliyor..." << endl;
+        if (::connect(sock, (struct sockaddr*)&serverAddress, sizeof(serverAddress)) < 0) {
+            close(sock);
+            return -1;
+        }
+        return sock;
+    }
+    
+    // stateMutex tutularak çağrılır. Oturum açılışı bağlantının ilk mesajıdır; yanıt
+    // beklemeden ardından yanıtı gelmemiş emirler aynı referanslarla yeniden gönderilir.
+    void openSession() {
+        sendLocked("OTURUM|" + clientId + "|" + to_string(lastSeq) + "|" + sessionToken + "\n");
+        for (map<string, TrackedOrder>::iterator it = awaitingAck.begin(); it != awaitingAck.end(); ++it) {
+            sendLocked(it->second.wire);
+        }
+        if (marketFeedWanted()) {
+            sendLocked(subscriptionRequest());
+        }
+    }
+    
+    bool marketFeedWanted() const {
+        return dashboardActive || strategyRunner != NULL;
+    }
+    
+    string subscriptionRequest() {
+        string request = "ABONE|";
+        for (size_t i = 0; i < stocks.size(); i++) {
+            if (i > 0) request += ",";
+            request += stocks[i].symbol;
+        }
+        return request + "\n";
+    }
+    
+    // Artan aralıklarla yeniden bağlanır; reconnectTimeout saniye içinde olmazsa vazgeçer.
+    bool reconnect() {
+        pthread_mutex_lock(&stateMutex);
+        notify("*** Server bağlantısı koptu, yeniden bağlanılıyor... ***");
+        pthread_mutex_unlock(&stateMutex);
+        struct timeval started;
+        gettimeofday(&started, NULL);
+        useconds_t delay = 10000;
+        
+        while (true) {
+            pthread_mutex_lock(&stateMutex);
+            bool stop = shuttingDown;
+            pthread_mutex_unlock(&stateMutex);
+            if (stop) {
+                return false;
+            }
+            
+            int sock = openSocket();
+            if (sock >= 0) {
+                pthread_mutex_lock(&stateMutex);
+                if (shuttingDown) {
+                    pthread_mutex_unlock(&stateMutex);
+                    close(sock);
+                    return false;
+                }
+                close(clientSocket);
+                clientSocket = sock;
+                connected = true;
+                openSession();
+                pthread_cond_broadcast(&stateChanged);
+                pthread_mutex_unlock(&stateMutex);
+                return true;
+            }
+            
+            struct timeval now;
+            gettimeofday(&now, NULL);
+            if (now.tv_sec - started.tv_sec >= reconnectTimeout) {
+                return false;
+            }
+            usleep(delay);
+            delay = min(delay * 2, (useconds_t)1000000);
+        }
+    }
+    
+    // Server'dan gelen tüm satırlar burada okunur: emir yanıtları ve bildirimler emir
+    // tablosuna işlenir, sorgu yanıtları bekleyen menü işlemine kuyruklanır. Bağlantı
+    // koparsa oturum sürdürülerek yeniden bağlanılır.
+    void readLoop() {
+        string line;
+        char buffer[4096];
+        
+        while (true) {
+            LineReader reader(false);
+            while (true) {
+                ssize_t bytesReceived = recv(clientSocket, buffer, sizeof(buffer), 0);
+                if (bytesReceived <= 0 || !reader.append(buffer, bytesReceived)) {
+                    break;
+                }
+                int64_t arrived = StrategyRunner::monotonicNanos();
+                
+                pthread_mutex_lock(&stateMutex);
+                receivedNs = arrived;
+                while (reader.next(line)) {
+                    handleServerLine(line);
+                }
+                pthread_cond_broadcast(&stateChanged);
+                pthread_mutex_unlock(&stateMutex);
+            }
             
-            stringstream orderMsg;
-            orderMsg << "EMIR|" << selectedStock.symbol << "|" << orderType 
-                    << "|" << price << "|" << quantity;
+            pthread_mutex_lock(&stateMutex);
+            connected = false;
+            bool stop = shuttingDown;
+            pthread_cond_broadcast(&stateChanged);
+            pthread_mutex_unlock(&stateMutex);
             
-            string message = orderMsg.str();
-            ssize_t bytesSent = send(clientSocket, message.c_str(), message.length(), 0);
+            if (stop || !reconnect()) {
+                break;
+            }
+        }
+        
+        pthread_mutex_lock(&stateMutex);
+        readerDone = true;
+        pthread_cond_broadcast(&stateChanged);
+        pthread_mutex_unlock(&stateMutex);
+    }
+    
+    static vector<string> splitFields(const string& line) {
+        vector<string> fields;
+        stringstream ss(line);
+        string field;
+        while (getline(ss, field, '|')) {
+            fields.push_back(field);
+        }
+        return fields;
+    }
+    
+    // Referanssız yanıt (eski server) en eski bekleyen emre aittir.
+    map<string, TrackedOrder>::iterator findAwaiting(const vector<string>& fields, size_t refIndex) {
+        if (fields.size() > refIndex) {
+            return awaitingAck.find(fields[refIndex]);
+        }
+        map<string, TrackedOrder>::iterator oldest = awaitingAck.end();
+        for (map<string, TrackedOrder>::iterator it = awaitingAck.begin(); it != awaitingAck.end(); ++it) {
+            if (oldest == awaitingAck.end() || atoi(it->first.c_str()) < atoi(oldest->first.c_str())) {
+                oldest = it;
+            }
+        }
+        return oldest;
+    }
+    
+    // Eşleşen emrin dolumları kabul yanıtından önce gelir.
+    void replayEarlyEvents(const string& orderId) {
+        map<string, vector<string> >::iterator early = earlyEvents.find(orderId);
+        if (early == earlyEvents.end()) return;
+        
+        vector<string> events = early->second;
+        earlyEvents.erase(early);
+        for (size_t i = 0; i < events.size(); i++) {
+            handleServerLine(events[i]);
+        }
+    }
+    
+    bool ordersAwaitingAck() const {
+        return !awaitingAck.empty() || strategyAwaiting > 0;
+    }
+    
+    // Yanıt bekleyen emir kalmadıysa sahipsiz bildirimler önceki oturumun emirlerine aittir.
+    void flushOrphanEvents() {
+        if (ordersAwaitingAck() || earlyEvents.empty()) return;
+        
+        map<string, vector<string> > orphans;
+        orphans.swap(earlyEvents);
+        for (map<string, vector<string> >::iterator it = orphans.begin(); it != orphans.end(); ++it) {
+            for (size_t i = 0; i < it->second.size(); i++) {
+                handleServerLine(it->second[i]);
+            }
+        }
+    }
+    
+    // stateMutex tutularak çağrılır. Canlı ekran açıkken bildirim yalnızca olay listesine
+    // düşer; ekran bir sonraki karede çizer.
+    void notify(const string& text) {
+        time_t now = time(0);
+        struct tm local;
+        localtime_r(&now, &local);
+        char stamp[16];
+        strftime(stamp, sizeof(stamp), "%H:%M:%S", &local);
+        
+        recentEvents.push_back(string(stamp) + " " + text);
+        if (recentEvents.size() > 50) {
+            recentEvents.pop_front();
+        }
+        if (dashboardActive) {
+            dashboardDirty = true;
+        } else {
+            cout << "\n" << text << endl;
+        }
+    }
+    
+    template <typename Levels>
+    static void parseLevels(const string& text, Levels& levels) {
+        levels.clear();
+        stringstream ss(text);
+        string level;
+        while (getline(ss, level, ',')) {
+            double price;
+            int quantity, count;
+            if (sscanf(level.c_str(), "%lf:%d:%d", &price, &quantity, &count) == 3 && quantity > 0) {
+                levels[price] = make_pair(quantity, count);
+            }
+        }
+    }
+    
+    template <typename Levels>
+    static void applyLevel(Levels& levels, double price, int quantity, int count) {
+        if (quantity > 0) {
+            levels[price] = make_pair(quantity, count);
+        } else {
+            levels.erase(price);
+        }
+    }
+    
+    // stateMutex tutularak çağrılır. Piyasa verisi mesajıysa işleyip true döner;
+    // eski sürümlü seviye değişiklikleri atlanır, DERINLIK tabloyu baştan kurar.
+    bool handleMarketData(const string& line) {
+        bool depth = line.compare(0, 9, "DERINLIK|") == 0;
+        bool delta = !depth && line.compare(0, 7, "SEVIYE|") == 0;
+        bool trade = !depth && !delta && line.compare(0, 9, "SONISLEM|") == 0;
+        if (!depth && !delta && !trade) {
+            return line.compare(0, 9, "ABONE_OK|") == 0 || line == "ABONE_IPTAL_OK";
+        }
+        
+        vector<string> fields = splitFields(line);
+        if (fields.size() < 4) return true;
+        SymbolView& view = market[fields[2]];
+        uint64_t version = strtoull(fields[1].c_str(), NULL, 10);
+        
+        if (depth) {
+            parseLevels(fields[3], view.bids);
+            parseLevels(fields.size() >= 5 ? fields[4] : "", view.asks);
+            view.version = version;
+        } else if (delta) {
+            if (version <= view.version) return true;
+            stringstream ss(fields[3]);
+            string level;
+            while (getline(ss, level, ',')) {
+                char side;
+                double price;
+                int quantity, count;
+                if (sscanf(level.c_str(), "%c:%lf:%d:%d", &side, &price, &quantity, &count) != 4) continue;
+                if (side == 'A') {
+                    applyLevel(view.bids, price, quantity, count);
+                } else {
+                    applyLevel(view.asks, price, quantity, count);
+                }
+            }
+            view.version = version;
+        } else if (fields.size() >= 5) {
+            double price = atof(fields[3].c_str());
+            if (view.trades > 0 && price != view.lastPrice) {
+                view.direction = price > view.lastPrice ? 1 : -1;
+            }
+            view.lastPrice = price;
+            view.lastQuantity = atoi(fields[4].c_str());
+            view.volume += view.lastQuantity;
+            view.trades++;
+        }
+        
+        if (strategyRunner != NULL) {
+            pushMarketEvent(fields[2], view, depth ? MARKET_DEPTH : delta ? MARKET_LEVEL : MARKET_TRADE);
+        }
+        marketMessages++;
+        if (dashboardActive) {
+            dashboardDirty = true;
+        }
+        return true;
+    }
+    
+    // stateMutex tutularak çağrılır; kuyruk doluysa olay düşer (StrategyRunner sayar).
+    void pushMarketEvent(const string& symbol, const SymbolView& view, int type) {
+        if (symbol.size() >= STRATEGY_SYMBOL_SIZE) return;
+        StrategyRunner::Event* event = strategyRunner->reserve();
+        if (event == NULL) return;
+        
+        MarketEvent& market = event->market;
+        event->kind = StrategyRunner::EVENT_MARKET;
+        market.type = type;
+        memcpy(market.symbol, symbol.c_str(), symbol.size() + 1);
+        market.bidPrice = view.bids.empty() ? 0 : view.bids.begin()->first;
+        market.bidQuantity = view.bids.empty() ? 0 : view.bids.begin()->second.first;
+        market.askPrice = view.asks.empty() ? 0 : view.asks.begin()->first;
+        market.askQuantity = view.asks.empty() ? 0 : view.asks.begin()->second.first;
+        market.tradePrice = type == MARKET_TRADE ? view.lastPrice : 0;
+        market.tradeQuantity = type == MARKET_TRADE ? view.lastQuantity : 0;
+        market.receivedNs = receivedNs;
+        strategyRunner->publish();
+    }
+    
+    // Emir olayları düşürülmez; kuyruk doluysa StrategyRunner taşma kuyruğunda tutar.
+    void pushOrderEvent(int type, const StrategySlot& slot, const string& orderId, double price, int quantity) {
+        StrategyRunner::Event event = StrategyRunner::Event();
+        OrderEvent& order = event.order;
+        event.kind = StrategyRunner::EVENT_ORDER;
+        order.type = type;
+        order.ref = slot.ref;
+        snprintf(order.orderId, sizeof(order.orderId), "%s", orderId.c_str());
+        memcpy(order.symbol, slot.symbol, sizeof(order.symbol));
+        order.buy = slot.buy;
+        order.price = price;
+        order.quantity = quantity;
+        order.receivedNs = receivedNs;
+        strategyRunner->publishOrder(event);
+    }
+    
+    // stateMutex tutularak çağrılır. Strateji emirlerinin yanıt ve bildirimleri kullanıcıya
+    // gösterilmeden strateji kuyruğuna aktarılır; başka satırlar için false döner.
+    bool handleStrategyLine(const vector<string>& fields) {
+        if (strategyRunner == NULL || fields.empty()) return false;
+        const string& tag = fields[0];
+        
+        if ((tag == "ORDER_ACCEPTED" || tag == "EMIR REDDEDILDI") && fields.size() >= 3) {
+            if (fields[2].compare(0, strategyRefPrefix.size(), strategyRefPrefix) != 0) return false;
+            int ref = atoi(fields[2].c_str() + strategyRefPrefix.size());
+            StrategySlot slot = strategySlots[ref % STRATEGY_SLOTS];
+            strategyAwaiting = max(0, strategyAwaiting - 1);
+            if (slot.ref != ref) return true;
             
-            if (bytesSent <= 0) {
-                cout << "HATA: Server bağlantısı koptu! Emir gönderilemedi." << endl;
-                cout << "Lütfen programı yeniden başlatın." << endl;
-                clearInputBuffer();
+            if (tag == "ORDER_ACCEPTED") {
+                pushOrderEvent(ORDER_ACCEPTED, slot, fields[1], slot.price, slot.quantity);
+                strategyOrders[fields[1]] = slot;
+                replayEarlyEvents(fields[1]);
+            } else {
+                pushOrderEvent(ORDER_REJECTED, slot, "", slot.price, slot.quantity);
+            }
+            flushOrphanEvents();
+            return true;
+        }
+        
+        size_t idIndex = tag == "TRADE" ? 6 : (tag == "EMIR_IPTAL" || tag == "EMIR_SURESI_DOLDU" || tag == "IPTAL_RED") ? 1 : 0;
+        if (idIndex == 0 || fields.size() <= idIndex) return false;
+        map<string, StrategySlot>::iterator it = strategyOrders.find(fields[idIndex]);
+        if (it == strategyOrders.end()) return false;
+        
+        StrategySlot& order = it->second;
+        if (tag == "TRADE") {
+            if (fields.size() < 7) return true;
+            int quantity = atoi(fields[5].c_str());
+            pushOrderEvent(ORDER_FILLED, order, it->first, atof(fields[4].c_str()), quantity);
+            order.quantity -= quantity;
+            if (order.quantity <= 0) strategyOrders.erase(it);
+        } else if (tag == "IPTAL_RED") {
+            pushOrderEvent(ORDER_CANCEL_REJECTED, order, it->first, order.price, order.quantity);
+        } else {
+            int remaining = fields.size() >= 3 ? atoi(fields[2].c_str()) : order.quantity;
+            pushOrderEvent(tag == "EMIR_IPTAL" ? ORDER_CANCELLED : ORDER_EXPIRED, order, it->first, order.price, remaining);
+            strategyOrders.erase(it);
+        }
+        return true;
+    }
+    
+    // Strateji thread'inden çağrılır; gönderim yolu bellek ayırmaz. Referans oturumda
+    // tekil olsun diye önek strateji başlatılırken belirlenir.
+    int sendStrategyOrder(const char* symbol, bool buy, double price, int quantity, const char* tif) {
+        if (symbol == NULL || strlen(symbol) >= STRATEGY_SYMBOL_SIZE || quantity <= 0 || price <= 0) {
+            return -1;
+        }
+        
+        char line[192];
+        pthread_mutex_lock(&stateMutex);
+        int ref = ++nextStrategyRef;
+        int length = snprintf(line, sizeof(line), "EMIR|%s|%s|%.10g|%d|%s|%s%d\n", symbol, buy ? "AL" : "SAT",
+                              price, quantity, tif != NULL ? tif : "", strategyRefPrefix.c_str(), ref);
+        bool sent = length > 0 && length < (int)sizeof(line) && sendLocked(line, length);
+        if (sent) {
+            strategyRunner->orderSent(StrategyRunner::monotonicNanos());
+            StrategySlot& slot = strategySlots[ref % STRATEGY_SLOTS];
+            slot.ref = ref;
+            memcpy(slot.symbol, symbol, strlen(symbol) + 1);
+            slot.buy = buy;
+            slot.price = price;
+            slot.quantity = quantity;
+            strategyAwaiting++;
+            strategyOrdersSent++;
+        }
+        pthread_mutex_unlock(&stateMutex);
+        return sent ? ref : -1;
+    }
+    
+    bool sendStrategyCancel(const char* orderId) {
+        char line[64];
+        int length = snprintf(line, sizeof(line), "IPTAL|%s\n", orderId != NULL ? orderId : "");
+        if (length <= 6 || length >= (int)sizeof(line)) return false;
+        
+        pthread_mutex_lock(&stateMutex);
+        bool sent = sendLocked(line, length);
+        if (sent) {
+            strategyRunner->orderSent(StrategyRunner::monotonicNanos());
+            strategyCancelsSent++;
+        }
+        pthread_mutex_unlock(&stateMutex);
+        return sent;
+    }
+    
+    // stateMutex tutularak çağrılır.
+    void handleServerLine(const string& line) {
+        // Oturum mesajları "S|seq|mesaj" biçimindedir; yeniden gönderilen eski mesajlar atlanır.
+        if (line.compare(0, 2, "S|") == 0) {
+            size_t bar = line.find('|', 2);
+            if (bar == string::npos) return;
+            uint64_t seq = strtoull(line.c_str() + 2, NULL, 10);
+            if (seq <= lastSeq) return;
+            lastSeq = seq;
+            handleServerLine(line.substr(bar + 1));
+            return;
+        }
+        
+        if (handleMarketData(line)) {
+            return;
+        }
+        
+        vector<string> fields = splitFields(line);
+        const string& tag = fields.empty() ? line : fields[0];
+        if (handleStrategyLine(fields)) {
+            return;
+        }
+        
+        if (tag == "OTURUM_OK" && fields.size() >= 3) {
+            // Server oturumu kaybettiyse (yeniden başlatma) numaralar baştan başlar.
+            uint64_t serverSeq = strtoull(fields[2].c_str(), NULL, 10);
+            if (serverSeq < lastSeq) lastSeq = serverSeq;
+            if (fields.size() >= 4 && fields[3] != sessionToken) {
+                sessionToken = fields[3];
+                saveSession();
+            }
+            notify("✓ Oturum açık (Client #" + fields[1] + ", son mesaj " + to_string(serverSeq) + ")");
+        } else if (tag == "OTURUM_RED") {
+            // Token tutmadı (oturum dosyası eski veya başka client'ın); bu bağlantı oturumsuz
+            // sürer, sonraki bağlantı yeni bir anahtarla yeni oturum açar.
+            string fresh = randomToken();
+            if (!fresh.empty()) {
+                clientId = "CLIENT_" + fresh;
+                sessionToken.clear();
+                lastSeq = 0;
+                saveSession();
+            }
+            notify("UYARI: Oturum sürdürülemedi (" + (fields.size() >= 2 ? fields[1] : string("")) + ")");
+        } else if (tag == "OTURUM_BOSLUK" && fields.size() >= 2) {
+            notify("UYARI: " + to_string(lastSeq + 1) + "-" + to_string(strtoull(fields[1].c_str(), NULL, 10) - 1)
+                   + " numaralı server mesajları artık mevcut değil; 'Emirlerim' ile kontrol edin.");
+        } else if (line.compare(0, 22, "Server'a hoş geldiniz") == 0) {
+            return;
+        } else if (tag == "SERVER_KAPANIYOR") {
+            notify("UYARI: Server kapanıyor, yeni emirler kabul edilmeyecek.");
+        } else if (tag == "HIZ_LIMITI" && fields.size() >= 2) {
+            notify("UYARI: Server hız limiti aşıldı (" + fields[1] + ")");
+        } else if (tag == "ORDER_ACCEPTED" && fields.size() >= 2) {
+            map<string, TrackedOrder>::iterator it = findAwaiting(fields, 2);
+            if (it == awaitingAck.end()) {
+                if (fields.size() < 3) notify("[Server] " + line);
                 return;
             }
             
-            cout << "Emir gönderildi, server yanıtı bekleniyor..." << endl;
+            TrackedOrder tracked = it->second;
+            awaitingAck.erase(it);
+            tracked.record.order_id = fields[1];
+            orderManager.updateStatus(tracked.record, "ACCEPTED");
+            trackedOrders[fields[1]] = tracked;
+            notify("✓ Emir #" + tracked.ref + " kabul edildi, Emir ID: " + fields[1]);
+            replayEarlyEvents(fields[1]);
+            flushOrphanEvents();
+        } else if (tag == "EMIR REDDEDILDI") {
+            map<string, TrackedOrder>::iterator it = findAwaiting(fields, 2);
+            string reason = fields.size() >= 2 ? fields[1] : "";
+            if (it == awaitingAck.end()) {
+                if (fields.size() < 3) notify("✗ Emir reddedildi: " + reason);
+                return;
+            }
             
-
-            char buffer[1024];
-            memset(buffer, 0, sizeof(buffer));
+            orderManager.updateStatus(it->second.record, "REJECTED");
+            notify("✗ Emir #" + it->first + " (" + it->second.record.symbol + " " 
+                   + it->second.record.order_type + ") reddedildi: " + reason);
+            awaitingAck.erase(it);
+            flushOrphanEvents();
+        } else if (tag == "EMIR_TEKRAR" && fields.size() >= 2) {
+            // Server emri daha önce işlemiş; yanıtı tampondan geldiyse emir artık beklemede değildir.
+            map<string, TrackedOrder>::iterator it = awaitingAck.find(fields[1]);
+            if (it == awaitingAck.end()) return;
+            notify("UYARI: Emir #" + it->first + " (" + it->second.record.symbol + " " + it->second.record.order_type
+                   + ") server'da zaten işlenmiş, yanıtı kayboldu; 'Emirlerim' ile kontrol edin.");
+            awaitingAck.erase(it);
+            flushOrphanEvents();
+        } else if (tag == "TRADE" && fields.size() >= 7) {
+            map<string, TrackedOrder>::iterator it = trackedOrders.find(fields[6]);
+            if (it == trackedOrders.end()) {
+                if (ordersAwaitingAck()) {
+                    earlyEvents[fields[6]].push_back(line);
+                    return;
+                }
+                notify("★ İşlem: " + fields[3] + (fields[2] == "ALIM" ? " alış " : " satış ")
+                       + fields[5] + " adet @ " + fields[4] + " TL (Emir " + fields[6] + ", önceki oturum)");
+                return;
+            }
+            
+            TrackedOrder& tracked = it->second;
+            int quantity = atoi(fields[5].c_str());
+            tracked.filledQuantity += quantity;
+            tracked.filledAmount += quantity * atof(fields[4].c_str());
+            bool complete = tracked.filledQuantity >= tracked.record.quantity;
+            orderManager.updateStatus(tracked.record, complete ? "FILLED" : "PARTIAL");
+            notify("★ İşlem: " + fields[3] + (fields[2] == "ALIM" ? " alış " : " satış ")
+                   + fields[5] + " adet @ " + fields[4] + " TL (Emir " + fields[6] + ", "
+                   + to_string(tracked.filledQuantity) + "/" + to_string(tracked.record.quantity) + ")");
+        } else if ((tag == "EMIR_IPTAL" || tag == "EMIR_SURESI_DOLDU") && fields.size() >= 2) {
+            bool expired = tag == "EMIR_SURESI_DOLDU";
+            map<string, TrackedOrder>::iterator it = trackedOrders.find(fields[1]);
+            if (it == trackedOrders.end()) {
+                if (ordersAwaitingAck()) {
+                    earlyEvents[fields[1]].push_back(line);
+                    return;
+                }
+                notify("• Emir " + fields[1] + (expired ? " süresi doldu" : " iptal edildi") + " (önceki oturum)");
+                return;
+            }
             
+            orderManager.updateStatus(it->second.record, expired ? "EXPIRED" : "CANCELLED");
+            notify("• Emir " + fields[1] + (expired ? " süresi doldu" : " iptal edildi")
+                   + " (kalan " + (fields.size() >= 3 ? fields[2] : "?") + " adet)");
+        } else if (tag == "EMIRLERIM" || tag == "ACIK" || tag == "POZISYONLAR" || tag == "POZ") {
+            replies.push_back(line);
+        } else if (line == "Görüşmek üzere!") {
+            goodbyeReceived = true;
+        } else {
+            notify("[Server] " + line);
+        }
+    }
 
-            struct timeval timeout;
-            timeout.tv_sec = 5; 
-            timeout.tv_usec = 0;
-            setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    // Sorgu yanıtı: "<başlık>|n" ve ardından n adet "<önek>..." satırı; okuma
+    // thread'inin kuyruğundan alınır. Başlık gelmezse -1 döner.
+    int requestList(const string& request, const string& header, const string& prefix, vector<string>& rows) {
+        pthread_mutex_lock(&stateMutex);
+        replies.clear();
+        pthread_mutex_unlock(&stateMutex);
+        
+        if (!sendLine(request + "\n")) {
+            cout << "HATA: Server bağlantısı koptu!" << endl;
+            return -1;
+        }
+        
+        int expected = -1;
+        struct timespec deadline = deadlineAfter(5);
+        
+        pthread_mutex_lock(&stateMutex);
+        while (expected < 0 || (int)rows.size() < expected) {
+            while (!replies.empty()) {
+                string line = replies.front();
+                replies.pop_front();
+                
+                if (line.compare(0, header.length() + 1, header + "|") == 0) {
+                    expected = atoi(line.c_str() + header.length() + 1);
+                } else if (expected >= 0 && line.compare(0, prefix.length(), prefix) == 0) {
+                    rows.push_back(line);
+                }
+            }
+            if (expected >= 0 && (int)rows.size() >= expected) break;
+            if (!connected || pthread_cond_timedwait(&stateChanged, &stateMutex, &deadline) == ETIMEDOUT) {
+                break;
+            }
+        }
+        pthread_mutex_unlock(&stateMutex);
+        
+        if (expected < 0) {
+            cout << "HATA: Server yanıtı alınamadı (timeout veya bağlantı sorunu)" << endl;
+        }
+        return expected;
+    }
+    
+    void listTrackedOrders() {
+        pthread_mutex_lock(&stateMutex);
+        cout << "\n=== EMİR TAKİBİ ===" << endl;
+        if (awaitingAck.empty() && trackedOrders.empty()) {
+            pthread_mutex_unlock(&stateMutex);
+            cout << "Bu oturumda emir verilmedi." << endl;
+            return;
+        }
+        
+        cout << left << setw(16) << "Emir ID" << setw(8) << "Sembol" << setw(6) << "Tip"
+             << right << setw(10) << "Fiyat" << setw(14) << "Dolan/Adet" << setw(12) << "Ort.Fiyat"
+             << "  " << left << "Durum" << endl;
+        cout << string(74, '-') << endl;
+        
+        for (map<string, TrackedOrder>::iterator it = awaitingAck.begin(); it != awaitingAck.end(); ++it) {
+            const Order& record = it->second.record;
+            cout << left << setw(16) << ("#" + it->first) << setw(8) << record.symbol << setw(6) << record.order_type
+                 << right << setw(10) << fixed << setprecision(2) << record.price
+                 << setw(14) << ("0/" + to_string(record.quantity)) << setw(12) << "-"
+                 << "  " << left << record.status << endl;
+        }
+        for (map<string, TrackedOrder>::iterator it = trackedOrders.begin(); it != trackedOrders.end(); ++it) {
+            const TrackedOrder& tracked = it->second;
+            const Order& record = tracked.record;
+            double average = tracked.filledQuantity > 0 ? tracked.filledAmount / tracked.filledQuantity : 0;
+            cout << left << setw(16) << it->first << setw(8) << record.symbol << setw(6) << record.order_type
+                 << right << setw(10) << fixed << setprecision(2) << record.price
+                 << setw(14) << (to_string(tracked.filledQuantity) + "/" + to_string(record.quantity))
+                 << setw(12) << average << "  " << left << record.status << endl;
+        }
+        cout << right;
+        pthread_mutex_unlock(&stateMutex);
+    }
+    
+    void listOrders() {
+        vector<string> orders;
+        int expected = requestList("EMIRLERIM", "EMIRLERIM", "ACIK|", orders);
+        if (expected < 0) {
+            return;
+        }
+        
+        cout << "\n=== AÇIK EMİRLERİM (" << expected << ") ===" << endl;
+        if (orders.empty()) {
+            cout << "Bekleyen emriniz yok." << endl;
+            return;
+        }
+        
+        cout << left << setw(16) << "Emir ID" << setw(8) << "Sembol" << setw(6) << "Tip"
+             << right << setw(10) << "Fiyat" << setw(12) << "Kalan/Adet" << setw(8) << "Süre" << endl;
+        cout << string(60, '-') << endl;
+        
+        for (size_t i = 0; i < orders.size(); i++) {
+            stringstream ss(orders[i]);
+            string tag, id, symbol, type, price, remaining, quantity, tif, trigger;
+            getline(ss, tag, '|');
+            getline(ss, id, '|');
+            getline(ss, symbol, '|');
+            getline(ss, type, '|');
+            getline(ss, price, '|');
+            getline(ss, remaining, '|');
+            getline(ss, quantity, '|');
+            getline(ss, tif, '|');
+            getline(ss, trigger, '|');
+            
+            if (atof(trigger.c_str()) > 0) {
+                type += "*";
+            }
+            cout << left << setw(16) << id << setw(8) << symbol << setw(6) << type
+                 << right << setw(10) << fixed << setprecision(2) << atof(price.c_str())
+                 << setw(12) << (remaining + "/" + quantity) << setw(8) << tif << endl;
+        }
+        cout << "(* : tetiklenmemiş stop emri)" << endl;
+    }
+    
+    void listPositions() {
+        vector<string> rows;
+        int expected = requestList("POZISYON", "POZISYONLAR", "POZ|", rows);
+        if (expected < 0) {
+            return;
+        }
+        
+        cout << "\n=== POZİSYONLARIM ===" << endl;
+        if (rows.empty()) {
+            cout << "Henüz gerçekleşen işleminiz yok." << endl;
+            return;
+        }
+        
+        cout << left << setw(8) << "Sembol" << right << setw(8) << "Adet" << setw(12) << "Ort.Maliyet"
+             << setw(10) << "Son" << setw(14) << "Gerçekleşen" << setw(12) << "Açık K/Z" << endl;
+        cout << string(64, '-') << endl;
+        
+        double totalRealized = 0, totalUnrealized = 0;
+        for (size_t i = 0; i < rows.size(); i++) {
+            stringstream ss(rows[i]);
+            string tag, symbol, quantity, cost, last, realized, unrealized;
+            getline(ss, tag, '|');
+            getline(ss, symbol, '|');
+            getline(ss, quantity, '|');
+            getline(ss, cost, '|');
+            getline(ss, last, '|');
+            getline(ss, realized, '|');
+            getline(ss, unrealized, '|');
             
-            ssize_t bytesReceived = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
+            totalRealized += atof(realized.c_str());
+            totalUnrealized += atof(unrealized.c_str());
+            cout << left << setw(8) << symbol << right << setw(8) << quantity << setw(12) << cost
+                 << setw(10) << last << setw(14) << realized << setw(12) << unrealized << endl;
+        }
+        cout << string(64, '-') << endl;
+        cout << "Toplam K/Z: " << fixed << setprecision(2) << totalRealized + totalUnrealized
+             << " TL (gerçekleşen " << totalRealized << ", açık " << totalUnrealized << ")" << endl;
+    }
+    
+    // UTF-8 metnin ekranda kapladığı sütun sayısı (devam baytları sayılmaz).
+    static int displayWidth(const string& text) {
+        int width = 0;
+        for (size_t i = 0; i < text.size(); i++) {
+            if ((text[i] & 0xC0) != 0x80) width++;
+        }
+        return width;
+    }
+    
+    static void putRight(TerminalScreen& screen, int row, int endColumn, const string& text, int style = STYLE_NORMAL) {
+        screen.put(row, endColumn - displayWidth(text), text, style);
+    }
+    
+    static string formatNumber(const char* format, double value) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), format, value);
+        return buffer;
+    }
+    
+    static string formatOrderRow(const string& id, const TrackedOrder& tracked) {
+        const Order& record = tracked.record;
+        string filled = to_string(tracked.filledQuantity) + "/" + to_string(record.quantity);
+        char buffer[128];
+        snprintf(buffer, sizeof(buffer), "%-16s%-8s%-6s%10.2f%14s  %s", id.c_str(), record.symbol.c_str(),
+                 record.order_type.c_str(), record.price, filled.c_str(), record.status.c_str());
+        return buffer;
+    }
+    
+    // stateMutex tutularak çağrılır; yalnızca arka tampona çizer.
+    void drawDashboard(TerminalScreen& screen, size_t selected, double updatesPerSecond) {
+        int row = 0;
+        time_t now = time(0);
+        struct tm local;
+        localtime_r(&now, &local);
+        char clock[16];
+        strftime(clock, sizeof(clock), "%H:%M:%S", &local);
+        
+        // Anahtarın tamamı satıra sığmaz; ayırt etmek için baştaki kısmı yeter.
+        screen.put(row, 0, " BORSA CANLI EKRAN  " + clientId.substr(0, 15) + "  " + clock + "  "
+                   + to_string((long long)updatesPerSecond) + " güncelleme/sn  "
+                   + (connected ? "BAĞLI" : "BAĞLANTI YOK"), STYLE_HEADER);
+        screen.fill(row, 0, STYLE_HEADER);
+        row += 2;
+        
+        screen.put(row, 2, "Sembol", STYLE_BOLD);
+        putRight(screen, row, 19, "Son", STYLE_BOLD);
+        putRight(screen, row, 27, "Değ%", STYLE_BOLD);
+        putRight(screen, row, 37, "Alış", STYLE_BOLD);
+        putRight(screen, row, 45, "Adet", STYLE_BOLD);
+        putRight(screen, row, 55, "Satış", STYLE_BOLD);
+        putRight(screen, row, 63, "Adet", STYLE_BOLD);
+        putRight(screen, row, 73, "Hacim", STYLE_BOLD);
+        putRight(screen, row, 80, "İşlem", STYLE_BOLD);
+        row++;
+        
+        for (size_t i = 0; i < stocks.size(); i++, row++) {
+            const Stock& stock = stocks[i];
+            map<string, SymbolView>::const_iterator it = market.find(stock.symbol);
+            if (i == selected) {
+                screen.put(row, 0, ">", STYLE_BOLD);
+            }
+            screen.put(row, 2, stock.symbol, i == selected ? STYLE_BOLD : STYLE_NORMAL);
+            if (it == market.end()) {
+                putRight(screen, row, 19, "-", STYLE_DIM);
+                continue;
+            }
+            
+            const SymbolView& view = it->second;
+            if (view.trades > 0) {
+                int style = view.direction > 0 ? STYLE_UP : view.direction < 0 ? STYLE_DOWN : STYLE_NORMAL;
+                putRight(screen, row, 19, formatNumber("%.2f", view.lastPrice), style);
+                if (stock.base_price > 0) {
+                    double change = (view.lastPrice - stock.base_price) / stock.base_price * 100;
+                    putRight(screen, row, 27, formatNumber("%+.2f", change),
+                             change > 0 ? STYLE_UP : change < 0 ? STYLE_DOWN : STYLE_NORMAL);
+                }
+            } else {
+                putRight(screen, row, 19, "-", STYLE_DIM);
+            }
+            if (!view.bids.empty()) {
+                putRight(screen, row, 37, formatNumber("%.2f", view.bids.begin()->first));
+                putRight(screen, row, 45, to_string(view.bids.begin()->second.first));
+            }
+            if (!view.asks.empty()) {
+                putRight(screen, row, 55, formatNumber("%.2f", view.asks.begin()->first));
+                putRight(screen, row, 63, to_string(view.asks.begin()->second.first));
+            }
+            putRight(screen, row, 73, to_string(view.volume));
+            putRight(screen, row, 80, to_string(view.trades));
+        }
+        row++;
+        
+        if (selected < stocks.size()) {
+            const string& symbol = stocks[selected].symbol;
+            screen.put(row++, 0, "DERİNLİK " + symbol, STYLE_BOLD);
+            putRight(screen, row, 6, "Emir", STYLE_DIM);
+            putRight(screen, row, 16, "Adet", STYLE_DIM);
+            putRight(screen, row, 27, "Alış", STYLE_DIM);
+            putRight(screen, row, 40, "Satış", STYLE_DIM);
+            putRight(screen, row, 50, "Adet", STYLE_DIM);
+            putRight(screen, row, 56, "Emir", STYLE_DIM);
+            row++;
             
-            if (bytesReceived > 0) {
-                buffer[bytesReceived] = '\0';
-                string response(buffer);
+            map<string, SymbolView>::const_iterator it = market.find(symbol);
+            const int depthRows = 5;
+            for (int level = 0; level < depthRows; level++, row++) {
+                screen.put(row, 29, "|", STYLE_DIM);
+                if (it == market.end()) continue;
                 
-                if (response.find("ORDER_ACCEPTED") != string::npos) {
-                    cout << "✓ Emir başarıyla server'a iletildi!" << endl;
-                    
-                    size_t pipePos = response.find('|');
-                    if (pipePos != string::npos && pipePos + 1 < response.length()) {
-                        string orderId = response.substr(pipePos + 1);
-                        orderId.erase(remove(orderId.begin(), orderId.end(), '\n'), orderId.end());
-                        orderId.erase(remove(orderId.begin(), orderId.end(), '\r'), orderId.end());
-                        cout << "Emir ID: " << orderId << endl;
+                map<double, pair<int, int>, greater<double> >::const_iterator bid = it->second.bids.begin();
+                map<double, pair<int, int> >::const_iterator ask = it->second.asks.begin();
+                advance(bid, min(level, (int)it->second.bids.size()));
+                advance(ask, min(level, (int)it->second.asks.size()));
+                if (bid != it->second.bids.end()) {
+                    putRight(screen, row, 6, to_string(bid->second.second));
+                    putRight(screen, row, 16, to_string(bid->second.first));
+                    putRight(screen, row, 27, formatNumber("%.2f", bid->first), STYLE_UP);
+                }
+                if (ask != it->second.asks.end()) {
+                    putRight(screen, row, 40, formatNumber("%.2f", ask->first), STYLE_DOWN);
+                    putRight(screen, row, 50, to_string(ask->second.first));
+                    putRight(screen, row, 56, to_string(ask->second.second));
+                }
+            }
+            row++;
+        }
+        
+        // Açık emirler: yanıt bekleyenler ve tamamı dolmamış kabul edilenler.
+        vector<string> open;
+        for (map<string, TrackedOrder>::const_iterator it = awaitingAck.begin(); it != awaitingAck.end(); ++it) {
+            open.push_back(formatOrderRow("#" + it->first, it->second));
+        }
+        for (map<string, TrackedOrder>::const_iterator it = trackedOrders.begin(); it != trackedOrders.end(); ++it) {
+            const string& status = it->second.record.status;
+            if (status == "ACCEPTED" || status == "PARTIAL") {
+                open.push_back(formatOrderRow(it->first, it->second));
+            }
+        }
+        
+        int bottom = screen.height() - 1;
+        screen.put(row++, 0, "AÇIK EMİRLERİM (" + to_string(open.size()) + ")", STYLE_BOLD);
+        int orderRows = min((int)open.size(), max(0, (bottom - row) / 2));
+        for (int i = 0; i < orderRows; i++) {
+            screen.put(row++, 2, open[i]);
+        }
+        row++;
+        
+        screen.put(row++, 0, "OLAYLAR", STYLE_BOLD);
+        for (deque<string>::const_reverse_iterator it = recentEvents.rbegin(); it != recentEvents.rend() && row < bottom; ++it) {
+            screen.put(row++, 2, *it);
+        }
+        
+        screen.put(bottom, 0, " q: çıkış   n/p: sembol seç", STYLE_DIM);
+    }
+    
+    // Piyasa verisine abone olur ve ekranı en fazla dashboardFps kare/sn ile yalnızca
+    // değişen hücreleri yazarak günceller. Okuma thread'i mesajları işlerken yalnızca
+    // tabloyu günceller; çizim ve terminal yazımı bu thread'dedir.
+    void runDashboard() {
+        pthread_mutex_lock(&stateMutex);
+        market.clear();
+        dashboardActive = true;
+        dashboardDirty = true;
+        sendLocked(subscriptionRequest());
+        pthread_mutex_unlock(&stateMutex);
+        
+        struct termios saved;
+        bool raw = isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &saved) == 0;
+        if (raw) {
+            struct termios settings = saved;
+            settings.c_lflag &= ~(ICANON | ECHO);
+            settings.c_cc[VMIN] = 0;
+            settings.c_cc[VTIME] = 0;
+            tcsetattr(STDIN_FILENO, TCSANOW, &settings);
+        }
+        cout << "\x1b[?1049h\x1b[?25l" << flush;
+        
+        TerminalScreen screen;
+        size_t selected = 0;
+        int frameMs = 1000 / max(1, dashboardFps);
+        time_t drawnSecond = 0;
+        time_t rateSecond = time(0);
+        long long rateMessages = 0;
+        double updatesPerSecond = 0;
+        string frame;
+        bool running = true;
+        
+        while (running) {
+            struct pollfd input;
+            input.fd = STDIN_FILENO;
+            input.events = POLLIN;
+            input.revents = 0;
+            bool keyPressed = false;
+            
+            if (poll(&input, 1, frameMs) > 0) {
+                char keys[32];
+                ssize_t count = read(STDIN_FILENO, keys, sizeof(keys));
+                if (count <= 0) {
+                    running = false;
+                }
+                for (ssize_t i = 0; i < count; i++) {
+                    char key = keys[i];
+                    if (key == 'q' || key == 'Q') {
+                        running = false;
+                    } else if ((key == 'n' || key == '\t') && !stocks.empty()) {
+                        selected = (selected + 1) % stocks.size();
+                    } else if (key == 'p' && !stocks.empty()) {
+                        selected = (selected + stocks.size() - 1) % stocks.size();
                     }
-                } else {
-                    cout << "Server yanıtı: " << response << endl;
+                    keyPressed = true;
                 }
-            } else if (bytesReceived == 0) {
-                cout << "HATA: Server bağlantısı kapandı!" << endl;
-                cout << "Lütfen programı yeniden başlatın." << endl;
-            } else {
-                cout << "HATA: Server yanıtı alınamadı (timeout veya bağlantı sorunu)" << endl;
-                cout << "Emir server'a ulaşmış olabilir, 'bekleyen' komutu ile kontrol edin." << endl;
             }
+            if (!running || connectionLost()) break;
+            
+            struct winsize size;
+            int rows = 24, cols = 80;
+            if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0) {
+                rows = size.ws_row;
+                cols = size.ws_col;
+            }
+            bool resized = rows != screen.height() || cols != screen.width();
+            screen.resize(rows, cols);
             
-            timeout.tv_sec = 0;
-            timeout.tv_usec = 0;
-            setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            time_t now = time(0);
+            frame.clear();
+            pthread_mutex_lock(&stateMutex);
+            if (now != rateSecond) {
+                updatesPerSecond = (double)(marketMessages - rateMessages) / (now - rateSecond);
+                rateMessages = marketMessages;
+                rateSecond = now;
+            }
+            if (dashboardDirty || keyPressed || resized || now != drawnSecond) {
+                dashboardDirty = false;
+                drawnSecond = now;
+                screen.clear();
+                drawDashboard(screen, selected, updatesPerSecond);
+                screen.render(frame);
+            }
+            pthread_mutex_unlock(&stateMutex);
             
-        } else {
-            cout << "Emir kayıt hatası!" << endl;
+            for (size_t written = 0; written < frame.size(); ) {
+                ssize_t n = write(STDOUT_FILENO, frame.data() + written, frame.size() - written);
+                if (n <= 0) {
+                    if (n < 0 && errno == EINTR) continue;
+                    break;
+                }
+                written += n;
+            }
         }
         
-        clearInputBuffer();
+        cout << "\x1b[0m\x1b[?25h\x1b[?1049l" << flush;
+        if (raw) {
+            tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+        }
+        
+        pthread_mutex_lock(&stateMutex);
+        dashboardActive = false;
+        dashboardDirty = false;
+        if (!marketFeedWanted()) {
+            sendLocked("ABONE_IPTAL\n");
+        }
+        pthread_mutex_unlock(&stateMutex);
+    }
+
+    static double micros(int64_t ns) {
+        return ns / 1000.0;
+    }
+    
+    void showStrategyStatus() {
+        cout << "\n=== STRATEJİ DURUMU ===" << endl;
+        if (strategy == NULL) {
+            cout << "Strateji yüklü değil (config.ini [strategy] name)." << endl;
+            return;
+        }
+        
+        pthread_mutex_lock(&stateMutex);
+        long long orders = strategyOrdersSent;
+        long long cancels = strategyCancelsSent;
+        int awaiting = strategyAwaiting;
+        size_t open = strategyOrders.size();
+        pthread_mutex_unlock(&stateMutex);
+        
+        const LatencyHistogram& latency = strategyRunner->latency();
+        const LatencyHistogram& queue = strategyRunner->queueLatency();
+        cout << "Strateji: " << strategyName << (strategyRunner->active() ? " (çalışıyor)" : " (durdu)") << endl;
+        cout << "İşlenen olay: " << strategyRunner->processedCount()
+             << ", kuyruk dolu nedeniyle düşen piyasa verisi: " << strategyRunner->droppedCount()
+             << ", taşma kuyruğuna alınan emir olayı: " << strategyRunner->overflowCount() << endl;
+        cout << "Gönderilen emir: " << orders << ", iptal: " << cancels
+             << ", yanıt bekleyen: " << awaiting << ", açık: " << open << endl;
+        cout << fixed << setprecision(1);
+        cout << "Olay -> emir gecikmesi (µs, " << latency.count() << " ölçüm): min " << micros(latency.minimum())
+             << "  ort " << micros(latency.average()) << "  p50 " << micros(latency.percentile(0.50))
+             << "  p99 " << micros(latency.percentile(0.99)) << "  max " << micros(latency.maximum()) << endl;
+        cout << "  bunun kuyruk bekleme kısmı (tüm olaylar): p50 " << micros(queue.percentile(0.50))
+             << "  p99 " << micros(queue.percentile(0.99)) << "  max " << micros(queue.maximum()) << endl;
+        cout << "(yüzdelikler 2'nin kuvveti kova üst sınırıdır)" << endl;
+    }
+    
+    void startStrategy() {
+        if (strategy == NULL) return;
+        
+        pthread_mutex_lock(&stateMutex);
+        strategyRunner = new StrategyRunner();
+        strategyRefPrefix = "A" + to_string(time(0)) + ".";
+        if (!dashboardActive) {
+            sendLocked(subscriptionRequest());
+        }
+        pthread_mutex_unlock(&stateMutex);
+        
+        if (strategyRunner->start(strategy, &strategyPort)) {
+            cout << "Strateji başlatıldı: " << strategyName << endl;
+        } else {
+            cout << "Strateji thread'i başlatılamadı!" << endl;
+        }
+    }
+    
+    // Okuma thread'i durduktan sonra çağrılır; kuyrukta kalan olaylar işlenmez.
+    void unloadStrategy() {
+        delete strategyRunner;
+        strategyRunner = NULL;
+        delete strategy;
+        strategy = NULL;
+        if (strategyLibrary != NULL) {
+            dlclose(strategyLibrary);
+            strategyLibrary = NULL;
+        }
     }
 
 public:
-    StockClient(const string& id) : clientId(id), clientSocket(-1) {}
+    StockClient(const string& id, int outstandingLimit, int reconnectSeconds) 
+        : clientSocket(-1), clientId(id), sessionLock(-1), serverPort(0), reconnectTimeout(reconnectSeconds),
+          readerStarted(false), connected(false), shuttingDown(false), readerDone(false), goodbyeReceived(false),
+          maxOutstanding(outstandingLimit > 0 ? outstandingLimit : 1), nextRef(0), lastSeq(0),
+          dashboardActive(false), dashboardDirty(false), marketMessages(0), dashboardFps(10),
+          strategy(NULL), strategyLibrary(NULL), strategyRunner(NULL), strategyPort(*this),
+          nextStrategyRef(0), strategyAwaiting(0), strategyOrdersSent(0), strategyCancelsSent(0), receivedNs(0) {
+        pthread_mutex_init(&stateMutex, NULL);
+        pthread_cond_init(&stateChanged, NULL);
+    }
+    
+    ~StockClient() {
+        unloadStrategy();
+        if (sessionLock >= 0) close(sessionLock);
+        pthread_mutex_destroy(&stateMutex);
+        pthread_cond_destroy(&stateChanged);
+    }
     
     bool loadStocks(const string& filename) {
         stocks = parser.loadStocks(filename);
         return !stocks.empty();
     }
     
-    bool connect(const string& serverIp, int serverPort) {
-        clientSocket = socket(AF_INET, SOCK_STREAM, 0);
-        if (clientSocket < 0) {
-            return false;
+    // Oturum dosyası: anahtar|son mesaj numarası|son emir referansı|token. Yoksa mevcut
+    // ID anahtar olarak kaydedilir; program yeniden başlatılsa da aynı oturum sürer.
+    // Dosya kilitlenir; aynı dizinde başka client çalışıyorsa sıradaki dosyaya (.1, .2 ...)
+    // geçilir, iki süreç aynı oturumu birbirinden almaz.
+    void loadSession(const string& filename) {
+        for (int slot = 0; slot < 100 && sessionLock < 0; slot++) {
+            string candidate = slot == 0 ? filename : filename + "." + to_string(slot);
+            int fd = open(candidate.c_str(), O_RDWR | O_CREAT, 0600);
+            if (fd < 0) break;
+            if (flock(fd, LOCK_EX | LOCK_NB) == 0) {
+                sessionLock = fd;
+                sessionFile = candidate;
+            } else {
+                close(fd);
+            }
+        }
+        if (sessionLock < 0) {
+            cout << "Oturum dosyası kilitlenemedi; oturum kaydedilmeyecek." << endl;
+            return;
+        }
+        if (sessionFile != filename) {
+            cout << filename << " başka bir client'ta açık, " << sessionFile << " kullanılıyor." << endl;
+        }
+        ifstream file(sessionFile.c_str());
+        string line;
+        if (file.is_open() && getline(file, line)) {
+            vector<string> fields = splitFields(line);
+            if (fields.size() >= 3 && !fields[0].empty()) {
+                clientId = fields[0];
+                lastSeq = strtoull(fields[1].c_str(), NULL, 10);
+                nextRef = atoi(fields[2].c_str());
+                sessionToken = fields.size() >= 4 ? fields[3] : "";
+                return;
+            }
+        }
+        saveSession();
+    }
+    
+    // Referans sayacı her emirde kaydedilir; yeniden başlayan client eski referansı
+    // tekrar kullanırsa server emri tekrar sayıp yok sayardı.
+    void saveSession() {
+        if (sessionFile.empty()) return;
+        ofstream file(sessionFile.c_str(), ios::trunc);
+        file << clientId << "|" << lastSeq << "|" << nextRef << "|" << sessionToken << endl;
+    }
+    
+    // ".so" ile biten ad paylaşımlı kütüphane olarak yüklenir, diğerleri derlemeye dahil stratejilerdir.
+    bool loadStrategy(const string& name, const string& params) {
+        CreateStrategyFn create = NULL;
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, ".so") == 0) {
+            strategyLibrary = dlopen(name.c_str(), RTLD_NOW | RTLD_LOCAL);
+            if (strategyLibrary == NULL) {
+                cout << "Strateji kütüphanesi yüklenemedi: " << dlerror() << endl;
+                return false;
+            }
+            create = (CreateStrategyFn)dlsym(strategyLibrary, STRATEGY_FACTORY_SYMBOL);
+        } else if (name == "momentum") {
+            create = createMomentumStrategy;
         }
         
-        struct sockaddr_in serverAddress;
-        memset(&serverAddress, 0, sizeof(serverAddress));
-        serverAddress.sin_family = AF_INET;
-        serverAddress.sin_port = htons(serverPort);
-        serverAddress.sin_addr.s_addr = inet_addr(serverIp.c_str());
-        
-        if (::connect(clientSocket, (struct sockaddr*)&serverAddress, sizeof(serverAddress)) < 0) {
-            close(clientSocket);
+        if (create == NULL) {
+            cout << "Strateji bulunamadı: " << name << endl;
             return false;
         }
-        
-        return true;
+        strategy = create(params.c_str());
+        strategyName = name;
+        return strategy != NULL;
+    }
+    
+    void setDashboardFps(int fps) {
+        dashboardFps = fps > 0 ? fps : 1;
+    }
+    
+    bool connect(const string& ip, int port) {
+        serverIp = ip;
+        serverPort = port;
+        clientSocket = openSocket();
+        return clientSocket >= 0;
     }
     
     void run() {
@@ -308,10 +1546,22 @@ public:
         buffer[welcomeBytes] = '\0';
         cout << "Server: " << buffer << endl;
         
+        pthread_mutex_lock(&stateMutex);
+        connected = true;
+        openSession();
+        pthread_mutex_unlock(&stateMutex);
+        
+        if (pthread_create(&readerThread, NULL, readerMain, this) != 0) {
+            cout << "Okuma thread'i başlatılamadı!" << endl;
+            return;
+        }
+        readerStarted = true;
+        startStrategy();
+        
         string command;
         while (true) {
-            if (!isConnected()) {
-                cout << "\n*** UYARI: Server bağlantısı kopmuş! ***" << endl;
+            if (connectionLost()) {
+                cout << "\n*** UYARI: Server'a " << reconnectTimeout << " sn içinde yeniden bağlanılamadı! ***" << endl;
                 cout << "Lütfen programı yeniden başlatın." << endl;
                 break;
             }
@@ -319,7 +1569,12 @@ public:
             cout << "\n===== MENÜ =====" << endl;
             cout << "[1] Hisse Listesi" << endl;
             cout << "[2] Emir Ver" << endl;
-            cout << "[3] Çıkış" << endl;
+            cout << "[3] Emirlerim" << endl;
+            cout << "[4] Pozisyonlarım" << endl;
+            cout << "[5] Emir Takibi" << endl;
+            cout << "[6] Canlı Ekran" << endl;
+            cout << "[7] Strateji Durumu" << endl;
+            cout << "[8] Çıkış" << endl;
             cout << "Seçim: ";
             
             getline(cin, command);
@@ -331,34 +1586,66 @@ public:
             if (command == "1") {
                 displayStocks();
             } else if (command == "2") {
+                placeOrder();
+            } else if (command == "3") {
                 if (!isConnected()) {
-                    cout << "HATA: Server bağlantısı kopuk! Emir verilemez." << endl;
+                    cout << "HATA: Server bağlantısı kopuk, yeniden bağlanılıyor!" << endl;
                     continue;
                 }
-                placeOrder();
-            } else if (command == "3" || toUpper(command) == "EXIT" || toUpper(command) == "QUIT") {
+                listOrders();
+            } else if (command == "4") {
+                if (!isConnected()) {
+                    cout << "HATA: Server bağlantısı kopuk, yeniden bağlanılıyor!" << endl;
+                    continue;
+                }
+                listPositions();
+            } else if (command == "5") {
+                listTrackedOrders();
+            } else if (command == "6") {
+                runDashboard();
+            } else if (command == "7") {
+                showStrategyStatus();
+            } else if (command == "8" || toUpper(command) == "EXIT" || toUpper(command) == "QUIT") {
                 cout << "Çıkış yapılıyor..." << endl;
+                // Stratejinin onStop'ta gönderdikleri quit'ten önce gitsin.
+                if (strategyRunner != NULL) {
+                    strategyRunner->stop();
+                }
                 
-                if (isConnected()) {
-                    send(clientSocket, "quit", 4, 0);
-                    
-                    struct timeval timeout;
-                    timeout.tv_sec = 2;
-                    timeout.tv_usec = 0;
-                    setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-                    
-                    memset(buffer, 0, sizeof(buffer));
-                    recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
+                pthread_mutex_lock(&stateMutex);
+                shuttingDown = true;
+                if (sendLocked("quit\n")) {
+                    struct timespec deadline = deadlineAfter(2);
+                    while (connected && !goodbyeReceived) {
+                        if (pthread_cond_timedwait(&stateChanged, &stateMutex, &deadline) == ETIMEDOUT) break;
+                    }
                 }
+                pthread_mutex_unlock(&stateMutex);
                 break;
             } else {
-                cout << "Geçersiz seçim! Lütfen 1, 2 veya 3 giriniz." << endl;
+                cout << "Geçersiz seçim! Lütfen 1-8 arası giriniz." << endl;
             }
         }
         
+        if (strategyRunner != NULL) {
+            strategyRunner->stop();
+        }
+        pthread_mutex_lock(&stateMutex);
+        shuttingDown = true;
+        if (clientSocket >= 0) {
+            shutdown(clientSocket, SHUT_RDWR);
+        }
+        pthread_mutex_unlock(&stateMutex);
+        
+        if (readerStarted) {
+            pthread_join(readerThread, NULL);
+        }
         if (clientSocket >= 0) {
             close(clientSocket);
+            clientSocket = -1;
         }
+        saveSession();
+        unloadStrategy();
     }
 };
 
@@ -368,10 +1655,25 @@ int main() {
     
     string serverIp = config.get("client", "server_ip", "127.0.0.1");
     int serverPort = config.getInt("client", "server_port", 5001);
+    int maxOutstanding = config.getInt("client", "max_outstanding", 8);
+    int reconnectTimeout = config.getInt("client", "reconnect_timeout", 30);
     
-    string clientId = "CLIENT_" + to_string(time(0) % 10000);
+    // Anahtar tahmin edilemez olmalıdır; aynı saniyede başlayan client'lar çakışmaz.
+    string sessionKey = randomToken();
+    if (sessionKey.empty()) {
+        cout << "Oturum anahtarı üretilemedi (/dev/urandom okunamadı)!" << endl;
+        return 1;
+    }
+    string clientId = "CLIENT_" + sessionKey;
+    
+    StockClient client(clientId, maxOutstanding, reconnectTimeout);
+    client.loadSession(config.get("client", "session_file", "client_session.dat"));
+    client.setDashboardFps(config.getInt("client", "dashboard_fps", 10));
     
-    StockClient client(clientId);
+    string strategyName = config.get("strategy", "name", "");
+    if (!strategyName.empty() && !client.loadStrategy(strategyName, config.get("strategy", "params", ""))) {
+        return 1;
+    }
     
     if (!client.loadStocks("stocks_config.json")) {
         cout << "Hisse listesi yüklenemedi!" << endl;
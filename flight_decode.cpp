@@ -0,0 +1,142 @@
+// Derleme: g++ -std=c++17 -O2 flight_decode.cpp -o flight_decode
+// Kullanım: ./flight_decode [flight_recorder.bin] [-n son N olay] [-c client] [SYM]
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include "flight_recorder.h"
+
+using namespace std;
+
+struct DecodedEvent {
+    FlightRecord record;
+    int tid;
+};
+
+bool earlier(const DecodedEvent& a, const DecodedEvent& b) {
+    return a.record.timestampNs < b.record.timestampNs;
+}
+
+string formatNanos(int64_t nanos) {
+    time_t seconds = nanos / 1000000000LL;
+    struct tm* timeinfo = localtime(&seconds);
+    char buffer[20];
+    strftime(buffer, sizeof(buffer), "%H:%M:%S", timeinfo);
+    stringstream ss;
+    ss << buffer << "." << setfill('0') << setw(9) << nanos % 1000000000LL;
+    return ss.str();
+}
+
+int main(int argc, char* argv[]) {
+    string filename = "flight_recorder.bin";
+    string symbolFilter;
+    size_t last = 0;
+    int clientFilter = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            last = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            clientFilter = atoi(argv[++i]);
+        } else if (strstr(argv[i], ".bin") != NULL) {
+            filename = argv[i];
+        } else {
+            symbolFilter = argv[i];
+        }
+    }
+
+    ifstream file(filename.c_str(), ios::binary);
+    if (!file.is_open()) {
+        cerr << "Dosya açılamadı: " << filename << endl;
+        return 1;
+    }
+
+    FlightDumpHeader header;
+    if (!file.read((char*)&header, sizeof(header)) || memcmp(header.magic, FLIGHT_MAGIC, sizeof(header.magic)) != 0) {
+        cerr << "Uçuş kaydı dosyası değil: " << filename << endl;
+        return 1;
+    }
+    if (header.recordSize != sizeof(FlightRecord)) {
+        cerr << "Kayıt boyutu uyuşmuyor (" << header.recordSize << " != " << sizeof(FlightRecord) << ")" << endl;
+        return 1;
+    }
+
+    vector<DecodedEvent> events;
+    vector<FlightRecord> records;
+    long skipped = 0;
+    for (uint32_t r = 0; r < header.ringCount; r++) {
+        FlightRingHeader ring;
+        if (!file.read((char*)&ring, sizeof(ring))) {
+            cerr << "Dosya kesik: " << r << "/" << header.ringCount << " halka okundu" << endl;
+            break;
+        }
+        records.resize(ring.capacity);
+        if (!file.read((char*)records.data(), sizeof(FlightRecord) * ring.capacity)) {
+            cerr << "Dosya kesik: " << r << "/" << header.ringCount << " halka okundu" << endl;
+            break;
+        }
+
+        uint64_t first = ring.head > ring.capacity ? ring.head - ring.capacity : 0;
+        for (uint64_t position = first; position < ring.head; position++) {
+            const FlightRecord& record = records[position % ring.capacity];
+            if (record.sequence != (uint32_t)position || record.type == 0) {
+                skipped++;
+                continue;
+            }
+            if (clientFilter != 0 && record.clientId != clientFilter && record.counterpartyId != clientFilter) continue;
+            if (!symbolFilter.empty() && symbolFilter != record.symbol) continue;
+
+            DecodedEvent event;
+            event.record = record;
+            event.tid = ring.tid;
+            events.push_back(event);
+        }
+    }
+
+    stable_sort(events.begin(), events.end(), earlier);
+    size_t start = last > 0 && events.size() > last ? events.size() - last : 0;
+
+    cout << "Uçuş kaydı: pid " << header.pid << ", " << formatNanos(header.dumpNs) << ", "
+         << (header.signal != 0 ? "sinyal " + to_string(header.signal) : string("konsol")) << ", "
+         << header.ringCount << " thread, " << events.size() << " olay" << endl;
+
+    for (size_t i = start; i < events.size(); i++) {
+        const FlightRecord& record = events[i].record;
+        cout << formatNanos(record.timestampNs) << " " << setw(7) << events[i].tid << " "
+             << left << setw(9) << flightEventName(record.type) << right;
+
+        switch (record.type) {
+            case FLIGHT_CONNECT:
+            case FLIGHT_DISCONNECT:
+                cout << "Client#" << record.clientId;
+                if (record.reference[0] != '\0') cout << " (" << record.reference << ")";
+                break;
+            case FLIGHT_FILL:
+                cout << record.reference << " " << record.symbol << " " << record.quantity << " @ "
+                     << fixed << setprecision(2) << record.price << " (Client#" << record.clientId
+                     << " <- Client#" << record.counterpartyId << ")";
+                break;
+            default:
+                cout << "Client#" << record.clientId << " " << record.symbol << " "
+                     << (record.side == 1 ? "AL" : (record.side == 2 ? "SAT" : "-")) << " "
+                     << record.quantity << " @ " << fixed << setprecision(2) << record.price;
+                if (record.type != FLIGHT_INGRESS && record.type != FLIGHT_REJECT) {
+                    cout << " kalan " << record.remaining;
+                }
+                if (record.reference[0] != '\0') cout << " [" << record.reference << "]";
+                break;
+        }
+        cout << endl;
+    }
+
+    if (skipped > 0) {
+        cout << "*** " << skipped << " yarım yazılmış kayıt atlandı ***" << endl;
+    }
+    return 0;
+}
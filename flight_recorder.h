@@ -0,0 +1,284 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <string>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <ctime>
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+const char FLIGHT_MAGIC[8] = { 'B', 'R', 'S', 'F', 'L', 'T', '0', '1' };
+
+enum FlightEventType {
+    FLIGHT_CONNECT = 1,
+    FLIGHT_DISCONNECT = 2,
+    FLIGHT_INGRESS = 3,     // emir satırı okundu
+    FLIGHT_REJECT = 4,
+    FLIGHT_ACCEPT = 5,
+    FLIGHT_MATCH = 6,       // eşleştirme bitti; remaining kitaba kalan
+    FLIGHT_FILL = 7,        // clientId alıcı, counterpartyId satıcı
+    FLIGHT_CANCEL = 8,
+    FLIGHT_EXPIRE = 9
+};
+
+inline const char* flightEventName(int type) {
+    static const char* names[] = { "?", "BAGLANTI", "AYRILDI", "GIRIS", "RED", "KABUL",
+                                   "ESLESME", "ISLEM", "IPTAL", "SURE" };
+    return type > 0 && type <= FLIGHT_EXPIRE ? names[type] : names[0];
+}
+
+// 64 baytlık sabit kayıt; dökümde bellekteki haliyle yazılır.
+struct FlightRecord {
+    int64_t timestampNs;        // CLOCK_REALTIME
+    uint32_t sequence;          // halkadaki sıra; yarım yazılmış kaydı ayıklamak için
+    uint16_t type;
+    uint16_t side;              // 1: AL, 2: SAT, 0: yok
+    int32_t clientId;
+    int32_t counterpartyId;
+    int32_t quantity;
+    int32_t remaining;
+    double price;
+    char symbol[8];             // sonu her zaman NUL
+    char reference[16];         // emir/işlem numarası veya red sebebi (kırpılmış)
+};
+
+struct FlightDumpHeader {
+    char magic[8];
+    uint32_t recordSize;
+    uint32_t ringCount;
+    int64_t dumpNs;
+    int32_t pid;
+    int32_t signal;             // 0: konsol komutu
+};
+
+struct FlightRingHeader {
+    int32_t tid;
+    uint32_t capacity;
+    uint64_t head;              // halkaya yazılmış toplam kayıt
+};
+
+// Her thread'in son N olayını tutan uçuş kaydedici. Thread kendi halkasına kilitsiz
+// yazar: kayıt başına bir saat okuması ve 64 baytlık kopya. Döküm yalnızca open/write
+// kullandığından sinyal işleyicisinden güvenle çağrılır; yazılmakta olan kayıt yarım
+// görünebilir, çözücü sırası tutmayan kaydı atlar. Halkalar bir kez ayrılır ve
+// bitmiş thread'in halkası (içindeki geçmişle) sonraki thread'e geçer; dökümdeki
+// thread numarası halkanın son sahibidir.
+class FlightRecorder {
+private:
+    struct Ring {
+        FlightRecord* records;
+        uint32_t capacity;
+        std::atomic<uint64_t> head;
+        std::atomic<bool> owned;
+        int tid;
+    };
+
+    struct ThreadState {
+        Ring* ring;
+
+        ~ThreadState() {
+            if (ring != NULL) ring->owned.store(false);
+        }
+    };
+
+    static const int MAX_RINGS = 256;
+
+    Ring* rings[MAX_RINGS];
+    std::atomic<int> ringCount;
+    std::atomic<uint64_t> overflow;     // halka tablosu doluyken düşen kayıt
+    uint32_t capacity;
+    pthread_mutex_t ringsMutex;
+    char signalPath[256];
+
+    FlightRecorder(const FlightRecorder&);
+    FlightRecorder& operator=(const FlightRecorder&);
+
+    static ThreadState& state() {
+        static thread_local ThreadState current = { NULL };
+        return current;
+    }
+
+    Ring* acquireRing() {
+        pthread_mutex_lock(&ringsMutex);
+        Ring* result = NULL;
+        int count = ringCount.load();
+        for (int i = 0; i < count && result == NULL; i++) {
+            bool expected = false;
+            if (rings[i]->owned.compare_exchange_strong(expected, true)) result = rings[i];
+        }
+        if (result == NULL && count < MAX_RINGS) {
+            result = new Ring();
+            result->capacity = capacity;
+            result->records = new FlightRecord[capacity]();
+            result->head.store(0);
+            result->owned.store(true);
+            rings[count] = result;
+            ringCount.store(count + 1, std::memory_order_release);
+        }
+        if (result != NULL) result->tid = (int)syscall(SYS_gettid);
+        pthread_mutex_unlock(&ringsMutex);
+        return result;
+    }
+
+    static bool writeAll(int fd, const void* data, size_t size) {
+        const char* p = (const char*)data;
+        while (size > 0) {
+            ssize_t written = write(fd, p, size);
+            if (written <= 0) return false;
+            p += written;
+            size -= written;
+        }
+        return true;
+    }
+
+    static void signalHandler(int sig);
+
+public:
+    FlightRecorder() : ringCount(0), overflow(0), capacity(0) {
+        pthread_mutex_init(&ringsMutex, NULL);
+        signalPath[0] = '\0';
+    }
+
+    // Thread'ler kayda başlamadan çağrılır; 0 kaydediciyi kapatır.
+    void configure(int recordsPerThread) {
+        capacity = recordsPerThread > 0 ? (uint32_t)recordsPerThread : 0;
+    }
+
+    bool enabled() const {
+        return capacity > 0;
+    }
+
+    void record(int type, int clientId, const std::string& symbol, const std::string& side,
+                double price, int quantity, int remaining, const std::string& reference,
+                int counterpartyId = 0) {
+        if (capacity == 0) return;
+        ThreadState& current = state();
+        if (current.ring == NULL) {
+            current.ring = acquireRing();
+            if (current.ring == NULL) {
+                overflow.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        Ring* ring = current.ring;
+
+        uint64_t position = ring->head.load(std::memory_order_relaxed);
+        FlightRecord& entry = ring->records[position % ring->capacity];
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        entry.timestampNs = (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+        entry.sequence = (uint32_t)position;
+        entry.type = (uint16_t)type;
+        entry.side = side == "AL" ? 1 : (side == "SAT" ? 2 : 0);
+        entry.clientId = clientId;
+        entry.counterpartyId = counterpartyId;
+        entry.quantity = quantity;
+        entry.remaining = remaining;
+        entry.price = price;
+        strncpy(entry.symbol, symbol.c_str(), sizeof(entry.symbol) - 1);
+        strncpy(entry.reference, reference.c_str(), sizeof(entry.reference) - 1);
+        ring->head.store(position + 1, std::memory_order_release);
+    }
+
+    // Sinyal işleyicisinden çağrılabilir: bellek ayırmaz, kilit almaz.
+    // Yazılan kayıt sayısını, açılamazsa -1 döner.
+    long dump(const char* path, int sig) {
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return -1;
+
+        int count = ringCount.load(std::memory_order_acquire);
+        FlightDumpHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, FLIGHT_MAGIC, sizeof(header.magic));
+        header.recordSize = sizeof(FlightRecord);
+        header.ringCount = count;
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        header.dumpNs = (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+        header.pid = getpid();
+        header.signal = sig;
+
+        long records = 0;
+        bool ok = writeAll(fd, &header, sizeof(header));
+        for (int i = 0; i < count && ok; i++) {
+            Ring* ring = rings[i];
+            FlightRingHeader ringHeader;
+            ringHeader.tid = ring->tid;
+            ringHeader.capacity = ring->capacity;
+            ringHeader.head = ring->head.load(std::memory_order_acquire);
+            ok = writeAll(fd, &ringHeader, sizeof(ringHeader))
+                 && writeAll(fd, ring->records, sizeof(FlightRecord) * ring->capacity);
+            records += ringHeader.head < ring->capacity ? (long)ringHeader.head : (long)ring->capacity;
+        }
+        close(fd);
+        return ok ? records : -1;
+    }
+
+    // SIGUSR1 dökümü alıp devam eder; SIGSEGV/SIGABRT/SIGBUS/SIGFPE dökümden sonra
+    // varsayılan davranışla (core) sonlanır.
+    void installSignalHandlers(const std::string& path) {
+        snprintf(signalPath, sizeof(signalPath), "%s", path.c_str());
+
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = signalHandler;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        sigaction(SIGUSR1, &action, NULL);
+
+        action.sa_flags = SA_RESETHAND;
+        int fatal[] = { SIGSEGV, SIGABRT, SIGBUS, SIGFPE };
+        for (size_t i = 0; i < sizeof(fatal) / sizeof(fatal[0]); i++) {
+            sigaction(fatal[i], &action, NULL);
+        }
+    }
+
+    const char* signalDumpPath() const {
+        return signalPath;
+    }
+
+    int threadCount() const {
+        return ringCount.load();
+    }
+
+    uint32_t recordsPerThread() const {
+        return capacity;
+    }
+
+    uint64_t overflowCount() const {
+        return overflow.load();
+    }
+};
+
+extern FlightRecorder flightRecorder;
+
+inline void FlightRecorder::signalHandler(int sig) {
+    int savedErrno = errno;
+    long records = flightRecorder.dump(flightRecorder.signalPath, sig);
+
+    char message[320];
+    size_t length = 0;
+    const char* parts[] = { records >= 0 ? "\n*** Uçuş kaydı yazıldı: " : "\n*** Uçuş kaydı yazılamadı: ",
+                            flightRecorder.signalPath, "\n" };
+    for (size_t i = 0; i < 3; i++) {
+        size_t part = strlen(parts[i]);
+        if (length + part > sizeof(message)) part = sizeof(message) - length;
+        memcpy(message + length, parts[i], part);
+        length += part;
+    }
+    if (write(STDERR_FILENO, message, length) < 0) {}
+
+    if (sig != SIGUSR1) {
+        raise(sig);
+    }
+    errno = savedErrno;
+}
+
+#endif
@@ -0,0 +1,292 @@
+// Derleme: g++ -std=c++17 -O2 -pthread gateway.cpp -o gateway
+// Kullanım: ./gateway <index>   (server config.ini'de [gateway] count > index ile başlatılmış olmalı)
+#include <iostream>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cstring>
+#include <pthread.h>
+#include <cstdlib>
+#include <ctime>
+#include <sstream>
+#include <map>
+#include "config_reader.h"
+#include "json_parser.h"
+#include "gateway_protocol.h"
+#include "line_reader.h"
+
+using namespace std;
+
+struct SessionData {
+    int socket;
+    int id;
+};
+
+GatewayQueue inbound;
+GatewayQueue outbound;
+pthread_mutex_t inboundMutex = PTHREAD_MUTEX_INITIALIZER;
+
+map<int, int> sessionSockets;
+pthread_mutex_t sessionMutex = PTHREAD_MUTEX_INITIALIZER;
+
+const int SOCKET_LOCK_STRIPES = 64;
+pthread_mutex_t socketWriteMutex[SOCKET_LOCK_STRIPES];
+
+map<string, pair<double, double> > stockPriceLimits;
+int gatewayIndex = 0;
+
+string getTimestamp() {
+    time_t now = time(0);
+    struct tm* timeinfo = localtime(&now);
+    char buffer[20];
+    strftime(buffer, sizeof(buffer), "%H:%M:%S", timeinfo);
+    return string(buffer);
+}
+
+void sendToSession(int socket, const string& message) {
+    string msg = message + "\n";
+    pthread_mutex_t* lock = &socketWriteMutex[socket % SOCKET_LOCK_STRIPES];
+    pthread_mutex_lock(lock);
+    send(socket, msg.c_str(), msg.length(), MSG_NOSIGNAL);
+    pthread_mutex_unlock(lock);
+}
+
+void pushToEngine(const GatewayMessage& message) {
+    pthread_mutex_lock(&inboundMutex);
+    while (!inbound.push(message)) {
+        pthread_mutex_unlock(&inboundMutex);
+        usleep(50);
+        pthread_mutex_lock(&inboundMutex);
+    }
+    pthread_mutex_unlock(&inboundMutex);
+}
+
+void* engineReader(void*) {
+    GatewayMessage message;
+    int idleSpins = 0;
+
+    while (true) {
+        if (!outbound.pop(message)) {
+            if (++idleSpins > 1000) {
+                usleep(50);
+            }
+            continue;
+        }
+        idleSpins = 0;
+
+        if (message.type != GW_TEXT && message.type != GW_SESSION_CLOSE) continue;
+
+        // Kilit gönderim bitene kadar tutulur: oturum thread'i soketi kaydı silmeden
+        // kapatamaz, numara yeniden kullanılıp başka client'a yazılmaz.
+        pthread_mutex_lock(&sessionMutex);
+        map<int, int>::iterator it = sessionSockets.find(message.sessionId);
+        if (it != sessionSockets.end()) {
+            if (message.type == GW_SESSION_CLOSE) {
+                // Oturum thread'i okumadan çıkar ve motora olağan kapanışı bildirir.
+                shutdown(it->second, SHUT_RDWR);
+            } else {
+                sendToSession(it->second, message.text);
+            }
+        }
+        pthread_mutex_unlock(&sessionMutex);
+    }
+    return NULL;
+}
+
+void* handleSession(void* arg) {
+    SessionData* sessionData = (SessionData*)arg;
+    int socket = sessionData->socket;
+    int sessionId = sessionData->id;
+    delete sessionData;
+
+    pthread_mutex_lock(&sessionMutex);
+    sessionSockets[sessionId] = socket;
+    pthread_mutex_unlock(&sessionMutex);
+
+    GatewayMessage message;
+    memset(&message, 0, sizeof(message));
+    message.type = GW_SESSION_OPEN;
+    message.sessionId = sessionId;
+    pushToEngine(message);
+
+    LineReader reader;
+    string msg;
+    bool quit = false;
+    char buffer[4096];
+    while (!quit) {
+        ssize_t bytesReceived = recv(socket, buffer, sizeof(buffer), 0);
+        if (bytesReceived <= 0 || !reader.append(buffer, bytesReceived)) {
+            break;
+        }
+
+        while (reader.next(msg)) {
+            if (msg == "quit") {
+                sendToSession(socket, "Görüşmek üzere!");
+                quit = true;
+                break;
+            }
+
+            if (msg.substr(0, 5) == "EMIR|") {
+                stringstream ss(msg);
+                string cmd, symbol, type, priceStr, quantityStr, tifStr, refStr;
+                getline(ss, cmd, '|');
+                getline(ss, symbol, '|');
+                getline(ss, type, '|');
+                getline(ss, priceStr, '|');
+                getline(ss, quantityStr, '|');
+                getline(ss, tifStr, '|');
+                getline(ss, refStr, '|');
+
+                double price = atof(priceStr.c_str());
+                int quantity = atoi(quantityStr.c_str());
+                // Yerel redler motorun yanıtlarını sıradan çıkarabilir; referans geri yollanır.
+                string ref = refStr.empty() ? "" : "|" + refStr;
+
+                // Kırpılan satır referansı bozar; motor yanlış referansla yanıt verirdi.
+                if (msg.length() >= sizeof(message.text)) {
+                    sendToSession(socket, "HATA|Mesaj cok uzun");
+                    continue;
+                }
+
+                if (symbol.empty() || symbol.length() >= sizeof(message.symbol)
+                    || (type != "AL" && type != "SAT") || quantity <= 0) {
+                    sendToSession(socket, "EMIR REDDEDILDI|Gecersiz emir" + ref);
+                    continue;
+                }
+
+                map<string, pair<double, double> >::const_iterator limits = stockPriceLimits.find(symbol);
+                if (limits != stockPriceLimits.end()
+                    && (price < limits->second.second || price > limits->second.first)) {
+                    sendToSession(socket, "EMIR REDDEDILDI|Fiyat limitinin disinda" + ref);
+                    continue;
+                }
+
+                memset(&message, 0, sizeof(message));
+                message.type = GW_NEW_ORDER;
+                message.sessionId = sessionId;
+                strncpy(message.symbol, symbol.c_str(), sizeof(message.symbol) - 1);
+                strncpy(message.side, type.c_str(), sizeof(message.side) - 1);
+                message.price = price;
+                message.quantity = quantity;
+                setGatewayText(message, msg);
+                pushToEngine(message);
+            } else if (msg == "EMIRLERIM" || msg == "POZISYON" || msg.compare(0, 5, "STOP|") == 0
+                       || msg.compare(0, 10, "STOPLIMIT|") == 0 || msg.compare(0, 6, "IPTAL|") == 0) {
+                if (msg.length() >= sizeof(message.text)) {
+                    sendToSession(socket, "HATA|Mesaj cok uzun");
+                    continue;
+                }
+                memset(&message, 0, sizeof(message));
+                message.type = GW_TEXT;
+                message.sessionId = sessionId;
+                setGatewayText(message, msg);
+                pushToEngine(message);
+            } else {
+                // Oturum sürdürme ve piyasa verisi aboneliği bağlantıya bağlıdır, gateway'de yoktur.
+                sendToSession(socket, "HATA|Desteklenmiyor");
+            }
+        }
+    }
+
+    pthread_mutex_lock(&sessionMutex);
+    sessionSockets.erase(sessionId);
+    pthread_mutex_unlock(&sessionMutex);
+
+    memset(&message, 0, sizeof(message));
+    message.type = GW_SESSION_CLOSE;
+    message.sessionId = sessionId;
+    pushToEngine(message);
+
+    close(socket);
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        gatewayIndex = atoi(argv[1]);
+    }
+
+    ConfigReader config;
+    config.load("config.ini");
+
+    int port = config.getInt("gateway", "port_base", 5100) + gatewayIndex;
+    int maxClients = config.getInt("server", "max_clients", 10);
+    string prefix = config.get("gateway", "queue_prefix", "/borsa_gw");
+
+    while (!inbound.attach(gatewayInboundName(prefix, gatewayIndex))
+           || !outbound.attach(gatewayOutboundName(prefix, gatewayIndex))) {
+        cerr << "Engine kuyrukları bulunamadı, bekleniyor..." << endl;
+        sleep(1);
+    }
+
+    for (int i = 0; i < SOCKET_LOCK_STRIPES; i++) {
+        pthread_mutex_init(&socketWriteMutex[i], NULL);
+    }
+
+    StockConfigParser parser;
+    vector<Stock> stocks = parser.loadStocks("stocks_config.json");
+    for (size_t i = 0; i < stocks.size(); i++) {
+        stockPriceLimits[stocks[i].symbol] = make_pair(stocks[i].max, stocks[i].min);
+    }
+
+    int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (serverSocket < 0) {
+        cerr << "Socket oluşturma hatası!" << endl;
+        return 1;
+    }
+
+    int opt = 1;
+    setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_in serverAddress;
+    memset(&serverAddress, 0, sizeof(serverAddress));
+    serverAddress.sin_family = AF_INET;
+    serverAddress.sin_addr.s_addr = INADDR_ANY;
+    serverAddress.sin_port = htons(port);
+
+    if (::bind(serverSocket, (struct sockaddr*)&serverAddress, sizeof(serverAddress)) < 0) {
+        cerr << "Port " << port << " kullanımda!" << endl;
+        close(serverSocket);
+        return 1;
+    }
+
+    if (listen(serverSocket, maxClients) < 0) {
+        cerr << "Listen hatası!" << endl;
+        close(serverSocket);
+        return 1;
+    }
+
+    cout << "\n==== GATEWAY #" << gatewayIndex << " ====" << endl;
+    cout << "Port: " << port << endl;
+    cout << "===================" << endl;
+
+    pthread_t readerThread;
+    pthread_create(&readerThread, NULL, engineReader, NULL);
+    pthread_detach(readerThread);
+
+    int sessionCounter = 1;
+
+    while (true) {
+        struct sockaddr_in clientAddress;
+        socklen_t clientAddressLength = sizeof(clientAddress);
+
+        int clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddress, &clientAddressLength);
+        if (clientSocket < 0) {
+            continue;
+        }
+
+        cout << "[" << getTimestamp() << "] Oturum #" << sessionCounter << " bağlandı" << endl;
+
+        SessionData* sessionData = new SessionData;
+        sessionData->socket = clientSocket;
+        sessionData->id = sessionCounter++;
+
+        pthread_t thread;
+        pthread_create(&thread, NULL, handleSession, sessionData);
+        pthread_detach(thread);
+    }
+
+    close(serverSocket);
+    return 0;
+}
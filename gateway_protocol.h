@@ -0,0 +1,45 @@
+#ifndef GATEWAY_PROTOCOL_H
+#define GATEWAY_PROTOCOL_H
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include "shm_queue.h"
+
+enum GatewayMessageType {
+    GW_SESSION_OPEN = 1,
+    GW_SESSION_CLOSE = 2,
+    GW_NEW_ORDER = 3,
+    GW_TEXT = 4
+};
+
+// Gateway -> engine: oturum açma/kapama, doğrulanmış emirler ve GW_TEXT ile
+// motorda doğrulanan satırlar (EMIRLERIM, POZISYON, STOP, STOPLIMIT, IPTAL).
+// Engine -> gateway: GW_TEXT ile oturuma iletilecek hazır protokol satırı;
+// GW_SESSION_CLOSE ile oturumun bağlantısı kapatılır (hız limiti aşımı).
+struct GatewayMessage {
+    uint32_t type;
+    int32_t sessionId;
+    char symbol[16];
+    char side[4];
+    double price;
+    int32_t quantity;
+    char text[220];
+};
+
+typedef ShmSpscQueue<GatewayMessage> GatewayQueue;
+
+inline std::string gatewayInboundName(const std::string& prefix, int index) {
+    return prefix + std::to_string(index) + "_in";
+}
+
+inline std::string gatewayOutboundName(const std::string& prefix, int index) {
+    return prefix + std::to_string(index) + "_out";
+}
+
+inline void setGatewayText(GatewayMessage& message, const std::string& text) {
+    strncpy(message.text, text.c_str(), sizeof(message.text) - 1);
+    message.text[sizeof(message.text) - 1] = '\0';
+}
+
+#endif
@@ -0,0 +1,92 @@
+// Derleme: g++ -std=c++17 -O2 json_bench.cpp -o json_bench
+// Kullanım: ./json_bench [sembol sayısı] [tekrar]
+// Sentetik bir hisse evreni üretir (girintili ve tek satır), loadStocks ile
+// yükleme süresini ölçer ve örnek bir kaydı doğrular.
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include "json_parser.h"
+
+using namespace std;
+
+double elapsedMs(const struct timespec& start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) * 1000.0 + (now.tv_nsec - start.tv_nsec) / 1000000.0;
+}
+
+string symbolName(int i) {
+    string name = "S";
+    for (int n = i; ; n /= 26) {
+        name += (char)('A' + n % 26);
+        if (n < 26) break;
+    }
+    return name;
+}
+
+void writeUniverse(const string& filename, int count, bool pretty) {
+    ofstream file(filename.c_str());
+    const char* nl = pretty ? "\n" : "";
+    const char* indent = pretty ? "            " : "";
+    
+    file << "{" << nl << (pretty ? "    " : "") << "\"stocks\": [" << nl;
+    for (int i = 0; i < count; i++) {
+        double base = 10 + (i % 5000) * 0.37;
+        file << (pretty ? "        " : "") << "{" << nl
+             << indent << "\"symbol\": \"" << symbolName(i) << "\"," << nl
+             << indent << "\"name\": \"Sentetik \\u015eirket " << i << "\"," << nl
+             << indent << "\"base_price\": " << fixed << setprecision(2) << base << "," << nl
+             << indent << "\"tick_size\": 0.01," << nl
+             << indent << "\"min\": " << base * 0.9 << "," << nl
+             << indent << "\"max\": " << base * 1.1 << nl
+             << (pretty ? "        " : "") << "}" << (i + 1 < count ? "," : "") << nl;
+    }
+    file << (pretty ? "    " : "") << "]" << nl << "}" << nl;
+}
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 100000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 5;
+    if (count <= 0 || rounds <= 0) {
+        cerr << "Kullanım: ./json_bench [sembol sayısı] [tekrar]" << endl;
+        return 1;
+    }
+    
+    const char* variants[2] = { "girintili", "tek satır" };
+    for (int v = 0; v < 2; v++) {
+        string filename = "/tmp/json_bench_" + to_string(getpid()) + "_" + to_string(v) + ".json";
+        writeUniverse(filename, count, v == 0);
+        
+        ifstream sizeCheck(filename.c_str(), ios::ate | ios::binary);
+        double megabytes = sizeCheck.tellg() / 1048576.0;
+        
+        StockConfigParser parser;
+        double best = 0, total = 0;
+        size_t loaded = 0;
+        vector<Stock> stocks;
+        for (int r = 0; r < rounds; r++) {
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            stocks = parser.loadStocks(filename);
+            double ms = elapsedMs(start);
+            total += ms;
+            if (r == 0 || ms < best) best = ms;
+            loaded = stocks.size();
+        }
+        
+        bool valid = loaded == (size_t)count && stocks.back().symbol == symbolName(count - 1)
+                     && stocks[0].name == "Sentetik \xC5\x9E" "irket 0" && stocks[0].tick_size == 0.01;
+        cout << fixed << setprecision(2)
+             << variants[v] << ": " << loaded << " sembol, " << megabytes << " MB, en iyi " << best
+             << " ms, ortalama " << total / rounds << " ms (" << setprecision(0)
+             << loaded / (best / 1000.0) << " sembol/sn)" << (valid ? "" : " DOĞRULAMA HATASI") << endl;
+        unlink(filename.c_str());
+    }
+    return 0;
+}
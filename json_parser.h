@@ -3,9 +3,14 @@
 
 #include <string>
 #include <vector>
-#include <fstream>
+#include <iostream>
 #include <sstream>
-#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 struct Stock {
     std::string symbol;
@@ -16,87 +21,329 @@ struct Stock {
     double max;
 };
 
+// Tek geçişli JSON okuyucu: dosya belleğe eşlenir, imleç baytlar üzerinde bir kez
+// ilerler. Biçimlendirmeden (tek satır, girintili, alan sırası) bağımsızdır;
+// bilinmeyen alanlar iç içe değerleriyle birlikte atlanır. Sayılar from_chars ile
+// ara string oluşturmadan çevrilir. Hata konumu satır:sütun olarak raporlanır.
 class StockConfigParser {
 private:
-    std::string trim(const std::string& str) {
-        size_t first = str.find_first_not_of(" \t\n\r\"");
-        size_t last = str.find_last_not_of(" \t\n\r\",");
-        return (first == std::string::npos) ? "" : str.substr(first, last - first + 1);
-    }
-    
-    std::string extractValue(const std::string& line, const std::string& key) {
-        size_t pos = line.find("\"" + key + "\"");
-        if (pos == std::string::npos) return "";
-        
-        pos = line.find(":", pos);
-        if (pos == std::string::npos) return "";
-        
-        pos++;
-        size_t start = line.find_first_not_of(" \t", pos);
-        size_t end = line.find_first_of(",}", start);
-        
-        if (start == std::string::npos || end == std::string::npos) 
-            return trim(line.substr(start));
-        
-        return trim(line.substr(start, end - start));
+    const char* begin;
+    const char* end;
+    const char* cursor;
+    std::string errorMessage;
+
+    bool fail(const std::string& message) {
+        if (!errorMessage.empty()) return false;
+
+        int line = 1, column = 1;
+        for (const char* p = begin; p < cursor && p < end; p++) {
+            if (*p == '\n') {
+                line++;
+                column = 1;
+            } else {
+                column++;
+            }
+        }
+        std::ostringstream out;
+        out << line << ":" << column << ": " << message;
+        errorMessage = out.str();
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (cursor < end && (*cursor == ' ' || *cursor == '\n' || *cursor == '\r' || *cursor == '\t')) {
+            cursor++;
+        }
+    }
+
+    bool expect(char c) {
+        skipWhitespace();
+        if (cursor >= end || *cursor != c) {
+            return fail(std::string("'") + c + "' bekleniyordu");
+        }
+        cursor++;
+        return true;
+    }
+
+    // Sonraki anlamlı karakter c ise tüketir.
+    bool consume(char c) {
+        skipWhitespace();
+        if (cursor < end && *cursor == c) {
+            cursor++;
+            return true;
+        }
+        return false;
+    }
+
+    static void appendUtf8(std::string& out, unsigned code) {
+        if (code < 0x80) {
+            out += (char)code;
+        } else if (code < 0x800) {
+            out += (char)(0xC0 | (code >> 6));
+            out += (char)(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += (char)(0xE0 | (code >> 12));
+            out += (char)(0x80 | ((code >> 6) & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        } else {
+            out += (char)(0xF0 | (code >> 18));
+            out += (char)(0x80 | ((code >> 12) & 0x3F));
+            out += (char)(0x80 | ((code >> 6) & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+    }
+
+    bool parseHex4(unsigned& code) {
+        if (end - cursor < 4) return fail("eksik \\u kaçışı");
+        code = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = *cursor++;
+            code <<= 4;
+            if (c >= '0' && c <= '9') code |= c - '0';
+            else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+            else return fail("geçersiz \\u kaçışı");
+        }
+        return true;
+    }
+
+    // out NULL ise string yalnızca atlanır.
+    bool parseString(std::string* out) {
+        if (!expect('"')) return false;
+
+        while (true) {
+            const char* run = cursor;
+            while (cursor < end && *cursor != '"' && *cursor != '\\' && (unsigned char)*cursor >= 0x20) {
+                cursor++;
+            }
+            if (out) out->append(run, cursor - run);
+
+            if (cursor >= end) return fail("kapanmamış string");
+            char c = *cursor;
+            if (c == '"') {
+                cursor++;
+                return true;
+            }
+            if (c != '\\') return fail("string içinde kontrol karakteri");
+
+            if (++cursor >= end) return fail("kapanmamış string");
+            char escaped = *cursor++;
+            char plain = 0;
+            switch (escaped) {
+                case '"': plain = '"'; break;
+                case '\\': plain = '\\'; break;
+                case '/': plain = '/'; break;
+                case 'b': plain = '\b'; break;
+                case 'f': plain = '\f'; break;
+                case 'n': plain = '\n'; break;
+                case 'r': plain = '\r'; break;
+                case 't': plain = '\t'; break;
+                case 'u': {
+                    unsigned code = 0;
+                    if (!parseHex4(code)) return false;
+                    if (code >= 0xD800 && code < 0xDC00 && end - cursor >= 6 && cursor[0] == '\\' && cursor[1] == 'u') {
+                        cursor += 2;
+                        unsigned low = 0;
+                        if (!parseHex4(low)) return false;
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    if (out) appendUtf8(*out, code);
+                    continue;
+                }
+                default:
+                    cursor--;
+                    return fail("geçersiz kaçış karakteri");
+            }
+            if (out) *out += plain;
+        }
+    }
+
+    bool parseNumber(double& value) {
+        skipWhitespace();
+        const char* start = cursor;
+        std::from_chars_result result = std::from_chars(cursor, end, value);
+        if (result.ec != std::errc() || result.ptr == start) {
+            return fail("sayı bekleniyordu");
+        }
+        cursor = result.ptr;
+        return true;
+    }
+
+    bool skipLiteral(const char* literal) {
+        size_t length = strlen(literal);
+        if ((size_t)(end - cursor) < length || memcmp(cursor, literal, length) != 0) {
+            return fail("geçersiz değer");
+        }
+        cursor += length;
+        return true;
+    }
+
+    // Herhangi bir JSON değerini atlar; iç içe yapılar için özyinelemelidir.
+    bool skipValue() {
+        skipWhitespace();
+        if (cursor >= end) return fail("değer bekleniyordu");
+
+        switch (*cursor) {
+            case '"':
+                return parseString(NULL);
+            case '{':
+                cursor++;
+                if (consume('}')) return true;
+                do {
+                    if (!parseString(NULL) || !expect(':') || !skipValue()) return false;
+                } while (consume(','));
+                return expect('}');
+            case '[':
+                cursor++;
+                if (consume(']')) return true;
+                do {
+                    if (!skipValue()) return false;
+                } while (consume(','));
+                return expect(']');
+            case 't':
+                return skipLiteral("true");
+            case 'f':
+                return skipLiteral("false");
+            case 'n':
+                return skipLiteral("null");
+            default: {
+                double ignored;
+                return parseNumber(ignored);
+            }
+        }
+    }
+
+    // Anahtarlar kaçış içermiyorsa kopyalanmadan doğrudan bellekten karşılaştırılır.
+    bool parseKey(std::string& scratch, const char*& key, size_t& length) {
+        skipWhitespace();
+        const char* start = cursor + 1;
+        if (cursor < end && *cursor == '"') {
+            const char* p = start;
+            while (p < end && *p != '"' && *p != '\\' && (unsigned char)*p >= 0x20) p++;
+            if (p < end && *p == '"') {
+                key = start;
+                length = p - start;
+                cursor = p + 1;
+                return expect(':');
+            }
+        }
+        scratch.clear();
+        if (!parseString(&scratch)) return false;
+        key = scratch.data();
+        length = scratch.size();
+        return expect(':');
+    }
+
+    static bool keyIs(const char* key, size_t length, const char* name) {
+        return strlen(name) == length && memcmp(key, name, length) == 0;
+    }
+
+    bool parseStock(Stock& stock) {
+        if (!expect('{')) return false;
+        if (consume('}')) return true;
+
+        std::string scratch;
+        do {
+            const char* key;
+            size_t length;
+            if (!parseKey(scratch, key, length)) return false;
+
+            bool ok;
+            if (keyIs(key, length, "symbol")) ok = parseString(&stock.symbol);
+            else if (keyIs(key, length, "name")) ok = parseString(&stock.name);
+            else if (keyIs(key, length, "base_price")) ok = parseNumber(stock.base_price);
+            else if (keyIs(key, length, "tick_size")) ok = parseNumber(stock.tick_size);
+            else if (keyIs(key, length, "min")) ok = parseNumber(stock.min);
+            else if (keyIs(key, length, "max")) ok = parseNumber(stock.max);
+            else ok = skipValue();
+            if (!ok) return false;
+        } while (consume(','));
+        return expect('}');
+    }
+
+    bool parseDocument(std::vector<Stock>& stocks) {
+        if (!expect('{')) return false;
+        if (consume('}')) return true;
+
+        std::string key;
+        do {
+            key.clear();
+            if (!parseString(&key) || !expect(':')) return false;
+            if (key != "stocks") {
+                if (!skipValue()) return false;
+                continue;
+            }
+
+            if (!expect('[')) return false;
+            if (consume(']')) continue;
+            do {
+                stocks.emplace_back();
+                if (!parseStock(stocks.back())) return false;
+                if (stocks.back().symbol.empty()) {
+                    stocks.pop_back();
+                }
+            } while (consume(','));
+            if (!expect(']')) return false;
+        } while (consume(','));
+
+        if (!expect('}')) return false;
+        skipWhitespace();
+        if (cursor != end) return fail("belge sonunda fazladan veri");
+        return true;
     }
 
 public:
+    StockConfigParser() : begin(NULL), end(NULL), cursor(NULL) {}
+
+    // Bellekteki JSON metnini ayrıştırır; hata olursa boş liste döner.
+    std::vector<Stock> parse(const char* data, size_t length) {
+        std::vector<Stock> stocks;
+        begin = cursor = data;
+        end = data + length;
+        errorMessage.clear();
+
+        if (!parseDocument(stocks)) {
+            stocks.clear();
+        }
+        return stocks;
+    }
+
     std::vector<Stock> loadStocks(const std::string& filename) {
         std::vector<Stock> stocks;
-        std::ifstream file(filename);
-        
-        if (!file.is_open()) {
+        errorMessage.clear();
+
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
             std::cerr << "JSON dosyası açılamadı: " << filename << std::endl;
             return stocks;
         }
-        
-        std::string line;
-        Stock currentStock;
-        bool inStock = false;
-        
-        while (std::getline(file, line)) {
-            if (line.find("{") != std::string::npos && line.find("\"stocks\"") == std::string::npos) {
-                inStock = true;
-                currentStock = Stock();
-            }
-            
-            if (inStock) {
-                if (line.find("\"symbol\"") != std::string::npos) {
-                    currentStock.symbol = extractValue(line, "symbol");
-                }
-                else if (line.find("\"name\"") != std::string::npos) {
-                    currentStock.name = extractValue(line, "name");
-                }
-                else if (line.find("\"base_price\"") != std::string::npos) {
-                    std::string priceStr = extractValue(line, "base_price");
-                    currentStock.base_price = std::stod(priceStr);
-                }
-                else if (line.find("\"tick_size\"") != std::string::npos) {
-                    std::string tickStr = extractValue(line, "tick_size");
-                    currentStock.tick_size = std::stod(tickStr);
-                }
-                else if (line.find("\"min\"") != std::string::npos) {
-                    std::string minStr = extractValue(line, "min");
-                    currentStock.min = std::stod(minStr);
-                }
-                else if (line.find("\"max\"") != std::string::npos) {
-                    std::string maxStr = extractValue(line, "max");
-                    currentStock.max = std::stod(maxStr);
-                }
-                
-                    if (line.find("}") != std::string::npos && line.find("{") == std::string::npos) {
-                    if (!currentStock.symbol.empty()) {
-                        stocks.push_back(currentStock);
-                    }
-                    inStock = false;
-                }
-            }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            close(fd);
+            std::cerr << "JSON dosyası boş: " << filename << std::endl;
+            return stocks;
+        }
+
+        void* mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "JSON dosyası belleğe eşlenemedi: " << filename << std::endl;
+            return stocks;
+        }
+
+        stocks = parse((const char*)mapped, info.st_size);
+        munmap(mapped, info.st_size);
+
+        if (!errorMessage.empty()) {
+            std::cerr << "JSON hatası " << filename << ":" << errorMessage << std::endl;
         }
-        
-        file.close();
         return stocks;
     }
+
+    const std::string& error() const {
+        return errorMessage;
+    }
 };
 
 #endif
@@ -0,0 +1,56 @@
+#ifndef LINE_READER_H
+#define LINE_READER_H
+
+#include <string>
+#include <cstddef>
+
+// TCP akışını satırlara böler. Tek recv birden çok mesaj (ardışık gönderim) veya
+// bir mesajın yalnızca bir kısmını getirebilir; tamamlanmamış satır bir sonraki
+// okumaya kadar bekletilir. Eski client'lar mesajı satır sonu olmadan tek send ile
+// yollar: sunucu tarafında bağlantıda satır sonu görülene kadar her okuma tek
+// mesaj sayılır. Client tarafı her zaman satır sonu bekler.
+class LineReader {
+private:
+    std::string pending;
+    size_t start;
+    bool framed;
+    size_t maxLine;
+
+public:
+    explicit LineReader(bool acceptUnframed = true, size_t maxLineLength = 65536)
+        : start(0), framed(!acceptUnframed), maxLine(maxLineLength) {}
+
+    // Satır sonu gelmeden sınır aşılırsa false döner; çağıran bağlantıyı kapatır.
+    bool append(const char* data, size_t length) {
+        if (start > 0) {
+            pending.erase(0, start);
+            start = 0;
+        }
+        pending.append(data, length);
+
+        if (!framed) {
+            if (pending.find('\n') != std::string::npos) {
+                framed = true;
+            } else {
+                pending += '\n';
+            }
+        }
+        return pending.size() <= maxLine || pending.find('\n') != std::string::npos;
+    }
+
+    // Sondaki \r atılır; boş satırlar atlanır.
+    bool next(std::string& line) {
+        while (true) {
+            size_t newline = pending.find('\n', start);
+            if (newline == std::string::npos) return false;
+
+            size_t end = newline;
+            if (end > start && pending[end - 1] == '\r') end--;
+            line.assign(pending, start, end - start);
+            start = newline + 1;
+            if (!line.empty()) return true;
+        }
+    }
+};
+
+#endif
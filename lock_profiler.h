@@ -0,0 +1,255 @@
+#ifndef LOCK_PROFILER_H
+#define LOCK_PROFILER_H
+
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <pthread.h>
+
+// Sunucunun global kilitleri için sarmalayıcı. LOCK_PROFILING tanımlıysa
+// (g++ -DLOCK_PROFILING) her kilit alma sayısını, bekleme ve tutma süresi
+// dağılımını ve en uzun tutan çağrı yerlerini kaydeder; tanımlı değilse
+// pthread_mutex çağrılarına birebir iner. Kayıtlar kilidin kendisi tutulurken
+// güncellendiği için ayrıca senkronizasyon gerekmez.
+#define MUTEX_LOCK(m) (m).lock(__func__, __LINE__)
+#define MUTEX_UNLOCK(m) (m).unlock()
+
+#ifdef LOCK_PROFILING
+
+// Nanosaniye cinsinden log2 kovalı süre histogramı. Çekişmesiz kilit tutma süreleri
+// çoğunlukla 1 us'nin altındadır; kovalar 1 ns'den başlar ki yüzdelikler ayrışsın.
+class LockTimeStats {
+private:
+    static const int BUCKETS = 48;
+    long long buckets[BUCKETS];
+    long long count;
+    int64_t sumNs;
+    int64_t maxNs;
+
+    static std::string duration(double ns) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(ns < 1000 ? 0 : 1);
+        if (ns < 1000) out << ns << "ns";
+        else out << ns / 1000.0 << "us";
+        return out.str();
+    }
+
+public:
+    LockTimeStats() {
+        reset();
+    }
+
+    void reset() {
+        for (int i = 0; i < BUCKETS; i++) buckets[i] = 0;
+        count = 0;
+        sumNs = 0;
+        maxNs = 0;
+    }
+
+    void add(int64_t ns) {
+        if (ns < 0) ns = 0;
+        int bucket = 0;
+        while (bucket < BUCKETS - 1 && ((int64_t)1 << bucket) < ns) bucket++;
+        buckets[bucket]++;
+        count++;
+        sumNs += ns;
+        if (ns > maxNs) maxNs = ns;
+    }
+
+    // Kova üst sınırı döner; en büyük ölçümü geçmez.
+    int64_t percentileNs(double p) const {
+        long long target = (long long)(count * p);
+        long long seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen > target) return std::min((int64_t)1 << i, maxNs);
+        }
+        return maxNs;
+    }
+
+    std::string summary() const {
+        std::ostringstream out;
+        out << "n=" << count << " ort=" << duration(count > 0 ? (double)sumNs / count : 0)
+            << " p50<=" << duration(percentileNs(0.5)) << " p99<=" << duration(percentileNs(0.99))
+            << " max=" << duration(maxNs);
+        return out.str();
+    }
+};
+
+class ProfiledMutex {
+private:
+    struct Site {
+        const char* function;
+        int line;
+        long long acquisitions;
+        long long contended;
+        int64_t totalHoldNs;
+        int64_t maxHoldNs;
+        int64_t totalWaitNs;
+    };
+
+    static const int MAX_SITES = 48;
+
+    pthread_mutex_t mutex;
+    const char* name;
+    long long acquisitions;
+    long long contended;
+    LockTimeStats waits;
+    LockTimeStats holds;
+    Site sites[MAX_SITES];
+    int siteCount;
+    long long unknownSites;
+    int holderSite;             // -1: tabloya sığmayan çağrı yeri
+    int64_t acquiredNs;
+
+    ProfiledMutex(const ProfiledMutex&);
+    ProfiledMutex& operator=(const ProfiledMutex&);
+
+    static int64_t now() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+
+    int findSite(const char* function, int line) {
+        for (int i = 0; i < siteCount; i++) {
+            if (sites[i].line == line && sites[i].function == function) return i;
+        }
+        if (siteCount == MAX_SITES) return -1;
+
+        Site& site = sites[siteCount];
+        site.function = function;
+        site.line = line;
+        site.acquisitions = 0;
+        site.contended = 0;
+        site.totalHoldNs = 0;
+        site.maxHoldNs = 0;
+        site.totalWaitNs = 0;
+        return siteCount++;
+    }
+
+    static bool longerHold(const Site& a, const Site& b) {
+        return a.maxHoldNs > b.maxHoldNs;
+    }
+
+public:
+    explicit ProfiledMutex(const char* mutexName)
+        : name(mutexName), acquisitions(0), contended(0), siteCount(0), unknownSites(0),
+          holderSite(-1), acquiredNs(0) {
+        pthread_mutex_init(&mutex, NULL);
+    }
+
+    void lock(const char* function, int line) {
+        int64_t waitNs = 0;
+        bool waited = pthread_mutex_trylock(&mutex) != 0;
+        if (waited) {
+            int64_t started = now();
+            pthread_mutex_lock(&mutex);
+            acquiredNs = now();
+            waitNs = acquiredNs - started;
+        } else {
+            acquiredNs = now();
+        }
+
+        acquisitions++;
+        waits.add(waitNs);
+        holderSite = findSite(function, line);
+        if (holderSite < 0) {
+            unknownSites++;
+        } else {
+            Site& site = sites[holderSite];
+            site.acquisitions++;
+            site.totalWaitNs += waitNs;
+            if (waited) site.contended++;
+        }
+        if (waited) contended++;
+    }
+
+    void unlock() {
+        int64_t holdNs = now() - acquiredNs;
+        holds.add(holdNs);
+        if (holderSite >= 0) {
+            Site& site = sites[holderSite];
+            site.totalHoldNs += holdNs;
+            if (holdNs > site.maxHoldNs) site.maxHoldNs = holdNs;
+        }
+        pthread_mutex_unlock(&mutex);
+    }
+
+    void reset() {
+        pthread_mutex_lock(&mutex);
+        acquisitions = 0;
+        contended = 0;
+        waits.reset();
+        holds.reset();
+        siteCount = 0;
+        unknownSites = 0;
+        pthread_mutex_unlock(&mutex);
+    }
+
+    // Kilit alınarak kopyalanır; raporun kendisi kilit dışında hazırlanır.
+    std::string report(int topSites) {
+        pthread_mutex_lock(&mutex);
+        long long count = acquisitions;
+        long long contendedCount = contended;
+        LockTimeStats waitCopy = waits;
+        LockTimeStats holdCopy = holds;
+        Site copy[MAX_SITES];
+        int copied = siteCount;
+        std::copy(sites, sites + siteCount, copy);
+        long long overflow = unknownSites;
+        pthread_mutex_unlock(&mutex);
+
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1);
+        out << name << ": " << count << " alım, " << contendedCount << " beklemeli ("
+            << (count > 0 ? 100.0 * contendedCount / count : 0.0) << "%)" << std::endl;
+        out << "  bekleme: " << waitCopy.summary() << std::endl;
+        out << "  tutma:   " << holdCopy.summary() << std::endl;
+
+        std::sort(copy, copy + copied, longerHold);
+        for (int i = 0; i < copied && i < topSites; i++) {
+            const Site& site = copy[i];
+            out << "    " << std::left << std::setw(28) << (std::string(site.function) + ":" + std::to_string(site.line))
+                << std::right << " n=" << site.acquisitions
+                << " tutma ort=" << (site.acquisitions > 0 ? site.totalHoldNs / 1000.0 / site.acquisitions : 0.0)
+                << "us max=" << site.maxHoldNs / 1000.0
+                << "us bekleme ort=" << (site.acquisitions > 0 ? site.totalWaitNs / 1000.0 / site.acquisitions : 0.0)
+                << "us (" << site.contended << " kez)" << std::endl;
+        }
+        if (overflow > 0) {
+            out << "    (çağrı yeri tablosu dolu, " << overflow << " alım yersiz)" << std::endl;
+        }
+        return out.str();
+    }
+};
+
+#else
+
+class ProfiledMutex {
+private:
+    pthread_mutex_t mutex;
+
+    ProfiledMutex(const ProfiledMutex&);
+    ProfiledMutex& operator=(const ProfiledMutex&);
+
+public:
+    explicit ProfiledMutex(const char*) {
+        pthread_mutex_init(&mutex, NULL);
+    }
+
+    void lock(const char*, int) {
+        pthread_mutex_lock(&mutex);
+    }
+
+    void unlock() {
+        pthread_mutex_unlock(&mutex);
+    }
+};
+
+#endif
+
+#endif
@@ -0,0 +1,402 @@
+#ifndef MARKET_DATA_H
+#define MARKET_DATA_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+#include <memory>
+#include <atomic>
+#include <sstream>
+#include <iomanip>
+#include <cerrno>
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+#include "book_snapshot.h"
+
+// Mesajlar (satır sonu ile biter, seq sembol bazında book versiyonudur):
+//   DERINLIK|seq|SYM|fiyat:adet:emir,...|fiyat:adet:emir,...   (alış | satış)
+//   SEVIYE|seq|SYM|A:fiyat:adet:emir,S:fiyat:adet:emir           (adet 0 = seviye silindi)
+//   SONISLEM|seq|SYM|fiyat|adet
+inline void appendLevels(std::ostringstream& out, const BookLevel* levels, int count) {
+    for (int i = 0; i < count; i++) {
+        if (i > 0) out << ",";
+        out << levels[i].price << ":" << levels[i].quantity << ":" << levels[i].orderCount;
+    }
+}
+
+inline std::string formatDepth(const BookSnapshot& snapshot) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "DERINLIK|" << snapshot.version << "|" << snapshot.symbol << "|";
+    appendLevels(out, snapshot.bids, snapshot.bidCount);
+    out << "|";
+    appendLevels(out, snapshot.asks, snapshot.askCount);
+    out << "\n";
+    return out.str();
+}
+
+inline void appendSideDelta(std::ostringstream& out, bool& first, char side,
+                            const BookLevel* before, int beforeCount,
+                            const BookLevel* after, int afterCount) {
+    for (int i = 0; i < afterCount; i++) {
+        int j = 0;
+        while (j < beforeCount && before[j].price != after[i].price) j++;
+        if (j < beforeCount && before[j].quantity == after[i].quantity
+            && before[j].orderCount == after[i].orderCount) {
+            continue;
+        }
+        if (!first) out << ",";
+        first = false;
+        out << side << ":" << after[i].price << ":" << after[i].quantity << ":" << after[i].orderCount;
+    }
+
+    for (int j = 0; j < beforeCount; j++) {
+        int i = 0;
+        while (i < afterCount && after[i].price != before[j].price) i++;
+        if (i < afterCount) continue;
+        if (!first) out << ",";
+        first = false;
+        out << side << ":" << before[j].price << ":0:0";
+    }
+}
+
+inline bool sameLevels(const BookSnapshot& a, const BookSnapshot& b) {
+    if (a.bidCount != b.bidCount || a.askCount != b.askCount) return false;
+    for (int i = 0; i < a.bidCount; i++) {
+        if (a.bids[i].price != b.bids[i].price || a.bids[i].quantity != b.bids[i].quantity
+            || a.bids[i].orderCount != b.bids[i].orderCount) return false;
+    }
+    for (int i = 0; i < a.askCount; i++) {
+        if (a.asks[i].price != b.asks[i].price || a.asks[i].quantity != b.asks[i].quantity
+            || a.asks[i].orderCount != b.asks[i].orderCount) return false;
+    }
+    return true;
+}
+
+inline std::string formatLevelDelta(const BookSnapshot& before, const BookSnapshot& after) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "SEVIYE|" << after.version << "|" << after.symbol << "|";
+    bool first = true;
+    appendSideDelta(out, first, 'A', before.bids, before.bidCount, after.bids, after.bidCount);
+    appendSideDelta(out, first, 'S', before.asks, before.askCount, after.asks, after.askCount);
+    out << "\n";
+    return out.str();
+}
+
+inline std::string formatLastTrade(uint64_t seq, const std::string& symbol, double price, int quantity) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "SONISLEM|" << seq << "|" << symbol << "|" << price << "|" << quantity << "\n";
+    return out.str();
+}
+
+struct MarketDataEvent {
+    std::string symbol;
+    uint64_t seq;
+    std::shared_ptr<const std::string> message;
+};
+
+struct MarketDataSubscriber {
+    int socket;
+    std::set<std::string> symbols;
+    std::set<std::string> needsSnapshot;
+    std::map<std::string, uint64_t> baseline;
+    std::deque<MarketDataEvent> queue;
+    bool broken;
+    long long conflations;
+};
+
+// Eşleştirme tarafı publish() ile yalnızca kısa bir kuyruğa ekleme yapar;
+// abonelere dağıtım ve gönderim ayrı bir dağıtıcı thread'de yapılır.
+// Geride kalan abonenin kuyruğu boşaltılır, sembolleri için taze DERINLIK gönderilir.
+class MarketDataHub {
+private:
+    const SnapshotRegistry& snapshots;
+    pthread_mutex_t* (*writeLockFor)(int);
+    size_t maxQueue;
+    int socketBuffer;
+
+    pthread_mutex_t inboxMutex;
+    pthread_cond_t inboxCond;
+    std::vector<MarketDataEvent> inbox;
+
+    pthread_mutex_t subscriberMutex;
+    std::map<int, MarketDataSubscriber> subscribers;
+    std::map<std::string, std::set<int> > bySymbol;
+    std::map<std::string, int> slotBySymbol;
+
+    std::atomic<int> subscriberCount;
+    std::atomic<bool> running;
+    pthread_t thread;
+
+    int findSlot(const std::string& symbol) {
+        std::map<std::string, int>::iterator it = slotBySymbol.find(symbol);
+        if (it != slotBySymbol.end()) return it->second;
+
+        BookSnapshot snapshot;
+        for (int slot = 0; slot < snapshots.count(); slot++) {
+            if (snapshots.read(slot, snapshot) && symbol == snapshot.symbol) {
+                slotBySymbol[symbol] = slot;
+                return slot;
+            }
+        }
+        return -1;
+    }
+
+    uint64_t appendSnapshot(const std::string& symbol, std::string& out) {
+        BookSnapshot snapshot;
+        int slot = findSlot(symbol);
+        if (slot < 0 || !snapshots.read(slot, snapshot)) {
+            memset(&snapshot, 0, sizeof(snapshot));
+            strncpy(snapshot.symbol, symbol.c_str(), sizeof(snapshot.symbol) - 1);
+        }
+        out += formatDepth(snapshot);
+        return snapshot.version;
+    }
+
+    // -1: bağlantı hatası, 0: hiç yazılamadı (abone geride), 1: tamamı yazıldı.
+    // Satır ortasında kalınırsa aynı soketteki diğer yazarlar araya girmesin diye
+    // kalan kısım kısa bir süre beklenerek tamamlanır.
+    int writeAll(int fd, const char* data, size_t length) {
+        size_t sent = 0;
+        while (sent < length) {
+            ssize_t n = send(fd, data + sent, length - sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (n > 0) {
+                sent += n;
+                continue;
+            }
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                return -1;
+            }
+            if (sent == 0) {
+                return 0;
+            }
+            struct pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLOUT;
+            if (poll(&pfd, 1, 50) <= 0) {
+                return -1;
+            }
+        }
+        return 1;
+    }
+
+    size_t sendCapacity(int fd) {
+        int bufferSize = 0;
+        socklen_t len = sizeof(bufferSize);
+        int queued = 0;
+        if (getsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufferSize, &len) != 0
+            || ioctl(fd, SIOCOUTQ, &queued) != 0) {
+            return 0;
+        }
+        int available = bufferSize / 4 - queued;
+        return available > 0 ? available : 0;
+    }
+
+    void flush(MarketDataSubscriber& sub) {
+        if (sub.broken || (sub.queue.empty() && sub.needsSnapshot.empty())) return;
+
+        pthread_mutex_t* lock = writeLockFor(sub.socket);
+        if (pthread_mutex_trylock(lock) != 0) return;
+
+        size_t capacity = sendCapacity(sub.socket);
+        std::string out;
+        std::map<std::string, uint64_t> snapshotVersions;
+
+        std::set<std::string>::iterator snap = sub.needsSnapshot.begin();
+        while (snap != sub.needsSnapshot.end() && out.size() < capacity) {
+            snapshotVersions[*snap] = appendSnapshot(*snap, out);
+            ++snap;
+        }
+
+        size_t consumed = 0;
+        for (; consumed < sub.queue.size(); consumed++) {
+            const MarketDataEvent& event = sub.queue[consumed];
+            if (snap != sub.needsSnapshot.end() && sub.needsSnapshot.count(event.symbol)
+                && !snapshotVersions.count(event.symbol)) {
+                continue;
+            }
+            uint64_t base = snapshotVersions.count(event.symbol)
+                ? snapshotVersions[event.symbol] : sub.baseline[event.symbol];
+            if (event.seq <= base) continue;
+            if (out.size() + event.message->size() > capacity) break;
+            out += *event.message;
+        }
+
+        int result = out.empty() ? 1 : writeAll(sub.socket, out.data(), out.size());
+        if (result > 0) {
+            for (std::map<std::string, uint64_t>::iterator it = snapshotVersions.begin();
+                 it != snapshotVersions.end(); ++it) {
+                sub.baseline[it->first] = it->second;
+            }
+            sub.needsSnapshot.erase(sub.needsSnapshot.begin(), snap);
+            sub.queue.erase(sub.queue.begin(), sub.queue.begin() + consumed);
+        } else if (result < 0) {
+            sub.broken = true;
+            shutdown(sub.socket, SHUT_RDWR);
+        }
+        pthread_mutex_unlock(lock);
+    }
+
+    void dispatch(std::vector<MarketDataEvent>& events) {
+        pthread_mutex_lock(&subscriberMutex);
+
+        for (size_t i = 0; i < events.size(); i++) {
+            std::map<std::string, std::set<int> >::iterator it = bySymbol.find(events[i].symbol);
+            if (it == bySymbol.end()) continue;
+
+            for (std::set<int>::iterator s = it->second.begin(); s != it->second.end(); ++s) {
+                MarketDataSubscriber& sub = subscribers[*s];
+                if (sub.queue.size() >= maxQueue) {
+                    sub.queue.clear();
+                    sub.needsSnapshot = sub.symbols;
+                    sub.conflations++;
+                }
+                sub.queue.push_back(events[i]);
+            }
+        }
+
+        for (std::map<int, MarketDataSubscriber>::iterator it = subscribers.begin();
+             it != subscribers.end(); ++it) {
+            flush(it->second);
+        }
+
+        pthread_mutex_unlock(&subscriberMutex);
+    }
+
+    static void* run(void* arg) {
+        MarketDataHub* hub = (MarketDataHub*)arg;
+        std::vector<MarketDataEvent> events;
+
+        while (hub->running.load()) {
+            pthread_mutex_lock(&hub->inboxMutex);
+            if (hub->inbox.empty()) {
+                struct timespec deadline;
+                clock_gettime(CLOCK_REALTIME, &deadline);
+                deadline.tv_nsec += 10000000;
+                if (deadline.tv_nsec >= 1000000000) {
+                    deadline.tv_sec++;
+                    deadline.tv_nsec -= 1000000000;
+                }
+                pthread_cond_timedwait(&hub->inboxCond, &hub->inboxMutex, &deadline);
+            }
+            events.swap(hub->inbox);
+            pthread_mutex_unlock(&hub->inboxMutex);
+
+            hub->dispatch(events);
+            events.clear();
+        }
+        return NULL;
+    }
+
+public:
+    MarketDataHub(const SnapshotRegistry& registry, pthread_mutex_t* (*lockFor)(int), size_t queueLimit = 512)
+        : snapshots(registry), writeLockFor(lockFor), maxQueue(queueLimit), socketBuffer(65536),
+          subscriberCount(0), running(false) {
+        pthread_mutex_init(&inboxMutex, NULL);
+        pthread_cond_init(&inboxCond, NULL);
+        pthread_mutex_init(&subscriberMutex, NULL);
+    }
+
+    // socketBuffer, çekirdekte bekleyebilecek veri miktarını sınırlar; abone bundan
+    // fazla geride kalırsa birikme kullanıcı tarafındaki kuyrukta olur ve birleştirilir.
+    void configure(size_t queueLimit, int bufferBytes) {
+        maxQueue = queueLimit > 0 ? queueLimit : 1;
+        socketBuffer = bufferBytes;
+    }
+
+    void start() {
+        running.store(true);
+        pthread_create(&thread, NULL, run, this);
+    }
+
+    void stop() {
+        if (!running.exchange(false)) return;
+        pthread_join(thread, NULL);
+    }
+
+    bool hasSubscribers() const {
+        return subscriberCount.load(std::memory_order_relaxed) > 0;
+    }
+
+    void publish(const std::string& symbol, uint64_t seq, const std::string& message) {
+        MarketDataEvent event;
+        event.symbol = symbol;
+        event.seq = seq;
+        event.message = std::make_shared<const std::string>(message);
+
+        pthread_mutex_lock(&inboxMutex);
+        inbox.push_back(event);
+        pthread_cond_signal(&inboxCond);
+        pthread_mutex_unlock(&inboxMutex);
+    }
+
+    void subscribe(int socket, const std::vector<std::string>& symbols) {
+        pthread_mutex_lock(&subscriberMutex);
+
+        std::map<int, MarketDataSubscriber>::iterator it = subscribers.find(socket);
+        if (it == subscribers.end()) {
+            MarketDataSubscriber sub;
+            sub.socket = socket;
+            sub.broken = false;
+            sub.conflations = 0;
+            it = subscribers.insert(std::make_pair(socket, sub)).first;
+            subscriberCount++;
+            if (socketBuffer > 0) {
+                setsockopt(socket, SOL_SOCKET, SO_SNDBUF, &socketBuffer, sizeof(socketBuffer));
+            }
+        }
+
+        for (size_t i = 0; i < symbols.size(); i++) {
+            it->second.symbols.insert(symbols[i]);
+            it->second.needsSnapshot.insert(symbols[i]);
+            bySymbol[symbols[i]].insert(socket);
+        }
+
+        pthread_mutex_unlock(&subscriberMutex);
+
+        pthread_mutex_lock(&inboxMutex);
+        pthread_cond_signal(&inboxCond);
+        pthread_mutex_unlock(&inboxMutex);
+    }
+
+    void unsubscribe(int socket) {
+        pthread_mutex_lock(&subscriberMutex);
+
+        std::map<int, MarketDataSubscriber>::iterator it = subscribers.find(socket);
+        if (it != subscribers.end()) {
+            for (std::set<std::string>::iterator s = it->second.symbols.begin();
+                 s != it->second.symbols.end(); ++s) {
+                bySymbol[*s].erase(socket);
+            }
+            subscribers.erase(it);
+            subscriberCount--;
+        }
+
+        pthread_mutex_unlock(&subscriberMutex);
+    }
+
+    int subscriberTotal() const {
+        return subscriberCount.load();
+    }
+
+    long long conflationTotal() {
+        long long total = 0;
+        pthread_mutex_lock(&subscriberMutex);
+        for (std::map<int, MarketDataSubscriber>::const_iterator it = subscribers.begin();
+             it != subscribers.end(); ++it) {
+            total += it->second.conflations;
+        }
+        pthread_mutex_unlock(&subscriberMutex);
+        return total;
+    }
+};
+
+#endif
@@ -0,0 +1,214 @@
+#ifndef MD_RING_H
+#define MD_RING_H
+
+#include <string>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const uint64_t MD_RING_MAGIC = 0x4252534d44524e47ULL;
+const uint32_t MD_RING_VERSION = 1;
+
+enum MdRecordType {
+    MD_TRADE = 1,
+    MD_TOP_OF_BOOK = 2
+};
+
+struct MdRecord {
+    uint32_t type;
+    char symbol[16];
+    int64_t timestampNs;
+    double price;
+    int quantity;
+    int buyerClientId;
+    int sellerClientId;
+    double bidPrice;
+    int bidQuantity;
+    double askPrice;
+    int askQuantity;
+};
+
+struct alignas(64) MdSlot {
+    std::atomic<uint64_t> version;
+    MdRecord record;
+};
+
+struct MdRingHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    alignas(64) std::atomic<uint64_t> writeSeq;
+};
+
+// Tek yazarlı, /dev/shm üzerinde paylaşılan halka. Her yuvanın versiyonu
+// ((seq + 1) << 1) | 1 iken yazılıyor, (seq + 1) << 1 olduğunda seq numaralı kayıt hazırdır.
+// Okuyucular sistem çağrısı yapmadan kendi hızlarında ilerler; çok geride kalan
+// okuyucu (üzerine yazılmış kayıt) en eski geçerli kayda atlar.
+class MdRingWriter {
+private:
+    MdRingHeader* header;
+    MdSlot* slots;
+    size_t mappedSize;
+    uint64_t mask;
+
+public:
+    MdRingWriter() : header(NULL), slots(NULL), mappedSize(0), mask(0) {}
+
+    ~MdRingWriter() {
+        close();
+    }
+
+    bool open(const std::string& shmName, uint32_t capacity) {
+        uint32_t size = 1;
+        while (size < capacity) size <<= 1;
+
+        int fd = shm_open(shmName.c_str(), O_CREAT | O_RDWR, 0644);
+        if (fd < 0) return false;
+
+        mappedSize = sizeof(MdRingHeader) + (size_t)size * sizeof(MdSlot);
+        if (ftruncate(fd, mappedSize) != 0) {
+            ::close(fd);
+            return false;
+        }
+
+        void* memory = mmap(NULL, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (memory == MAP_FAILED) return false;
+
+        memset(memory, 0, mappedSize);
+        header = (MdRingHeader*)memory;
+        slots = (MdSlot*)((char*)memory + sizeof(MdRingHeader));
+        header->version = MD_RING_VERSION;
+        header->capacity = size;
+        header->writeSeq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = MD_RING_MAGIC;
+
+        mask = size - 1;
+        return true;
+    }
+
+    void close() {
+        if (header) {
+            munmap(header, mappedSize);
+            header = NULL;
+            slots = NULL;
+        }
+    }
+
+    bool isOpen() const {
+        return header != NULL;
+    }
+
+    void publish(const MdRecord& record) {
+        if (!header) return;
+
+        uint64_t seq = header->writeSeq.load(std::memory_order_relaxed);
+        MdSlot& slot = slots[seq & mask];
+
+        uint64_t tag = (seq + 1) << 1;
+
+        slot.version.store(tag | 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&slot.record, &record, sizeof(MdRecord));
+        slot.version.store(tag, std::memory_order_release);
+
+        header->writeSeq.store(seq + 1, std::memory_order_release);
+    }
+};
+
+class MdRingReader {
+private:
+    const MdRingHeader* header;
+    const MdSlot* slots;
+    size_t mappedSize;
+    uint64_t mask;
+    uint64_t nextSeq;
+    uint64_t lostRecords;
+
+public:
+    MdRingReader() : header(NULL), slots(NULL), mappedSize(0), mask(0), nextSeq(0), lostRecords(0) {}
+
+    ~MdRingReader() {
+        if (header) munmap((void*)header, mappedSize);
+    }
+
+    // fromStart true ise halkada kalan en eski kayıttan, değilse yalnızca yeni kayıtlardan başlar.
+    bool open(const std::string& shmName, bool fromStart = false) {
+        int fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(MdRingHeader)) {
+            ::close(fd);
+            return false;
+        }
+
+        mappedSize = st.st_size;
+        void* memory = mmap(NULL, mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (memory == MAP_FAILED) return false;
+
+        header = (const MdRingHeader*)memory;
+        if (header->magic != MD_RING_MAGIC || header->version != MD_RING_VERSION) {
+            munmap(memory, mappedSize);
+            header = NULL;
+            return false;
+        }
+
+        slots = (const MdSlot*)((const char*)memory + sizeof(MdRingHeader));
+        mask = header->capacity - 1;
+
+        uint64_t written = header->writeSeq.load(std::memory_order_acquire);
+        if (fromStart) {
+            nextSeq = written > header->capacity ? written - header->capacity : 0;
+        } else {
+            nextSeq = written;
+        }
+        return true;
+    }
+
+    // 1: kayıt okundu, 0: yeni kayıt yok.
+    int poll(MdRecord& out, uint64_t* seqOut = NULL) {
+        while (true) {
+            const MdSlot& slot = slots[nextSeq & mask];
+            uint64_t tag = (nextSeq + 1) << 1;
+            uint64_t before = slot.version.load(std::memory_order_acquire);
+
+            if (before < tag || before == (tag | 1)) {
+                return 0;
+            }
+
+            if (before == tag) {
+                memcpy(&out, (const void*)&slot.record, sizeof(MdRecord));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.version.load(std::memory_order_relaxed) == before) {
+                    if (seqOut) *seqOut = nextSeq;
+                    nextSeq++;
+                    return 1;
+                }
+            }
+
+            uint64_t written = header->writeSeq.load(std::memory_order_acquire);
+            uint64_t oldest = written > header->capacity ? written - header->capacity + 1 : 0;
+            if (oldest > nextSeq) {
+                lostRecords += oldest - nextSeq;
+                nextSeq = oldest;
+            }
+        }
+    }
+
+    uint64_t lost() const {
+        return lostRecords;
+    }
+
+    uint64_t position() const {
+        return nextSeq;
+    }
+};
+
+#endif
@@ -0,0 +1,85 @@
+// Derleme: g++ -std=c++17 -O2 md_tail.cpp -o md_tail
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include "config_reader.h"
+#include "md_ring.h"
+
+using namespace std;
+
+string formatNanos(int64_t nanos) {
+    time_t seconds = nanos / 1000000000LL;
+    struct tm* timeinfo = localtime(&seconds);
+    char buffer[20];
+    strftime(buffer, sizeof(buffer), "%H:%M:%S", timeinfo);
+    stringstream ss;
+    ss << buffer << "." << setfill('0') << setw(6) << (nanos % 1000000000LL) / 1000;
+    return ss.str();
+}
+
+int main(int argc, char* argv[]) {
+    ConfigReader config;
+    config.load("config.ini");
+    
+    string shmName = config.get("shm", "name", "/borsa_md");
+    bool fromStart = false;
+    string symbolFilter;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-a") == 0) {
+            fromStart = true;
+        } else {
+            symbolFilter = argv[i];
+        }
+    }
+    
+    MdRingReader reader;
+    while (!reader.open(shmName, fromStart)) {
+        cerr << "Paylaşımlı bellek açılamadı (" << shmName << "), bekleniyor..." << endl;
+        sleep(1);
+    }
+    
+    cout << "Dinleniyor: " << shmName << " (seq " << reader.position() << ")" << endl;
+    
+    MdRecord record;
+    uint64_t seq;
+    uint64_t reportedLost = 0;
+    int idleSpins = 0;
+    
+    while (true) {
+        if (!reader.poll(record, &seq)) {
+            if (++idleSpins > 1000) {
+                usleep(100);
+            }
+            continue;
+        }
+        idleSpins = 0;
+        
+        if (reader.lost() != reportedLost) {
+            cout << "*** " << (reader.lost() - reportedLost) << " kayıt kaçırıldı ***" << endl;
+            reportedLost = reader.lost();
+        }
+        
+        if (!symbolFilter.empty() && symbolFilter != record.symbol) {
+            continue;
+        }
+        
+        cout << setw(8) << seq << " " << formatNanos(record.timestampNs) << " " 
+             << setw(6) << record.symbol << " " << fixed << setprecision(2);
+        
+        if (record.type == MD_TRADE) {
+            cout << "İŞLEM " << record.quantity << " @ " << record.price 
+                 << " (Client#" << record.buyerClientId << " <- Client#" 
+                 << record.sellerClientId << ")" << endl;
+        } else {
+            cout << "TOB   " << record.bidQuantity << " @ " << record.bidPrice 
+                 << " | " << record.askPrice << " x " << record.askQuantity << endl;
+        }
+    }
+    
+    return 0;
+}
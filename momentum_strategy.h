@@ -0,0 +1,105 @@
+#ifndef MOMENTUM_STRATEGY_H
+#define MOMENTUM_STRATEGY_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "strategy_api.h"
+
+// Derlemeye dahil örnek strateji. Bir sembolde art arda "ticks" kez yükselen
+// (düşen) işlem fiyatında karşı taraftaki en iyi fiyattan IOC alış (satış) verir.
+// Sembol başına pozisyon "max_position" ile sınırlıdır ve aynı anda tek emir açıktır.
+// Parametreler: "qty=10,ticks=3,max_position=100"
+class MomentumStrategy : public Strategy {
+private:
+    static const int MAX_SYMBOLS = 64;
+
+    struct SymbolState {
+        char symbol[STRATEGY_SYMBOL_SIZE];
+        double lastPrice;
+        int streak;             // pozitif: ardışık yükseliş, negatif: düşüş
+        int position;
+        int liveRef;            // yanıtı veya dolumu beklenen emir, yoksa -1
+    };
+
+    SymbolState states[MAX_SYMBOLS];
+    int symbolCount;
+    int quantity;
+    int ticks;
+    int maxPosition;
+
+    static int param(const char* params, const char* name, int fallback) {
+        if (params == NULL) return fallback;
+        size_t length = strlen(name);
+        for (const char* p = params; (p = strstr(p, name)) != NULL; p += length) {
+            if ((p == params || p[-1] == ',') && p[length] == '=') {
+                return atoi(p + length + 1);
+            }
+        }
+        return fallback;
+    }
+
+    SymbolState* find(const char* symbol) {
+        for (int i = 0; i < symbolCount; i++) {
+            if (strcmp(states[i].symbol, symbol) == 0) return &states[i];
+        }
+        if (symbolCount == MAX_SYMBOLS) return NULL;
+
+        SymbolState& state = states[symbolCount++];
+        snprintf(state.symbol, sizeof(state.symbol), "%s", symbol);
+        state.lastPrice = 0;
+        state.streak = 0;
+        state.position = 0;
+        state.liveRef = -1;
+        return &state;
+    }
+
+public:
+    explicit MomentumStrategy(const char* params)
+        : symbolCount(0),
+          quantity(param(params, "qty", 10)),
+          ticks(param(params, "ticks", 3)),
+          maxPosition(param(params, "max_position", 100)) {}
+
+    void onMarketData(StrategyContext& context, const MarketEvent& event) {
+        if (event.type != MARKET_TRADE) return;
+        SymbolState* state = find(event.symbol);
+        if (state == NULL) return;
+
+        if (state->lastPrice > 0 && event.tradePrice != state->lastPrice) {
+            bool up = event.tradePrice > state->lastPrice;
+            state->streak = up ? (state->streak > 0 ? state->streak + 1 : 1)
+                               : (state->streak < 0 ? state->streak - 1 : -1);
+        }
+        state->lastPrice = event.tradePrice;
+        if (state->liveRef >= 0) return;
+
+        if (state->streak >= ticks && event.askPrice > 0 && state->position + quantity <= maxPosition) {
+            state->liveRef = context.sendOrder(event.symbol, true, event.askPrice, quantity, "IOC");
+            state->streak = 0;
+        } else if (state->streak <= -ticks && event.bidPrice > 0 && state->position - quantity >= -maxPosition) {
+            state->liveRef = context.sendOrder(event.symbol, false, event.bidPrice, quantity, "IOC");
+            state->streak = 0;
+        }
+    }
+
+    // IOC emir kabul yanıtından önce dolar veya kalanı iptal edilir; ilk dolum,
+    // iptal veya red sembolü yeni emre açar.
+    void onOrder(StrategyContext&, const OrderEvent& event) {
+        SymbolState* state = find(event.symbol);
+        if (state == NULL) return;
+
+        if (event.type == ORDER_FILLED) {
+            state->position += event.buy ? event.quantity : -event.quantity;
+        }
+        if (event.ref == state->liveRef && event.type != ORDER_ACCEPTED) {
+            state->liveRef = -1;
+        }
+    }
+};
+
+extern "C" inline Strategy* createMomentumStrategy(const char* params) {
+    return new MomentumStrategy(params);
+}
+
+#endif
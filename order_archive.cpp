@@ -0,0 +1,224 @@
+// Derleme: g++ -std=c++17 -O2 order_archive.cpp -o order_archive
+// Kullanım: ./order_archive [-b blok satırı] [--sil] [orders_YYYYMMDD.csv ...]
+// Dosya verilmezse bulunulan dizindeki kapanmış günler (bugünden önceki) arşivlenir.
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <ctime>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "config_reader.h"
+#include "order_archive.h"
+
+using namespace std;
+
+struct ArchiveTotals {
+    uint64_t rows;
+    long long quantity;
+    long long total;
+};
+
+// orders_YYYYMMDD.csv -> YYYYMMDD; ad tutmazsa 0.
+uint32_t dateFromName(const string& path) {
+    size_t slash = path.find_last_of('/');
+    string name = slash == string::npos ? path : path.substr(slash + 1);
+    if (name.size() != 19 || name.compare(0, 7, "orders_") != 0 || name.compare(15, 4, ".csv") != 0) return 0;
+    for (size_t i = 7; i < 15; i++) {
+        if (name[i] < '0' || name[i] > '9') return 0;
+    }
+    return (uint32_t)atoi(name.substr(7, 8).c_str());
+}
+
+uint32_t today() {
+    time_t now = time(0);
+    struct tm* timeinfo = localtime(&now);
+    char buffer[20];
+    strftime(buffer, sizeof(buffer), "%Y%m%d", timeinfo);
+    return (uint32_t)atoi(buffer);
+}
+
+bool parseLine(const string& line, ArchiveRow& row) {
+    vector<string> tokens;
+    stringstream ss(line);
+    string item;
+    while (getline(ss, item, ',')) {
+        tokens.push_back(item);
+    }
+    if (tokens.size() < 8 || tokens.size() > 9) return false;
+
+    int64_t quantity;
+    if (!parseArchiveTime(tokens[0], row.time) || !parseArchiveCents(tokens[4], row.price)
+        || !parseArchiveCents(tokens[6], row.total)) {
+        return false;
+    }
+    char* end = NULL;
+    quantity = strtoll(tokens[5].c_str(), &end, 10);
+    if (end == tokens[5].c_str() || *end != '\0' || quantity < 0 || quantity > 2147483647LL) return false;
+
+    row.client = tokens[1];
+    row.symbol = tokens[2];
+    row.side = tokens[3];
+    row.quantity = (int32_t)quantity;
+    row.status = tokens[7];
+    row.orderId = tokens.size() == 9 ? tokens[8] : "";
+    return true;
+}
+
+// Yazılan dosyayı baştan çözüp satır sayısı ve toplamları kaynakla karşılaştırır.
+bool verify(const string& path, const ArchiveTotals& expected) {
+    ArchiveReader reader;
+    if (!reader.open(path)) return false;
+
+    ArchiveTotals actual = { 0, 0, 0 };
+    ArchiveColumns columns;
+    string buffer;
+    for (size_t b = 0; b < reader.blocks.size(); b++) {
+        if (!reader.readBlock(b, buffer, columns, true)) return false;
+        actual.rows += columns.size();
+        for (size_t i = 0; i < columns.size(); i++) {
+            actual.quantity += columns.quantity[i];
+            actual.total += columns.total[i];
+        }
+    }
+    return actual.rows == expected.rows && actual.quantity == expected.quantity && actual.total == expected.total
+           && reader.header.rowCount == expected.rows;
+}
+
+long fileSize(const string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? (long)info.st_size : -1;
+}
+
+bool archiveFile(const string& csvPath, uint32_t date, const string& directory, int rowsPerBlock, bool removeSource) {
+    ifstream file(csvPath.c_str());
+    if (!file.is_open()) {
+        cerr << csvPath << ": açılamadı" << endl;
+        return false;
+    }
+
+    ArchiveWriter writer;
+    ArchiveTotals totals = { 0, 0, 0 };
+    ArchiveRow row;
+    string line;
+    int lineNumber = 0;
+    int skipped = 0;
+    while (getline(file, line)) {
+        lineNumber++;
+        if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+        if (line.empty() || (lineNumber == 1 && line.compare(0, 5, "Zaman") == 0)) continue;
+        if (!parseLine(line, row)) {
+            if (++skipped <= 5) cerr << csvPath << ":" << lineNumber << ": satır okunamadı" << endl;
+            continue;
+        }
+        writer.add(row);
+        totals.rows++;
+        totals.quantity += row.quantity;
+        totals.total += row.total;
+    }
+    file.close();
+
+    // Okunamayan satır arşive giremez; eksik arşiv yazılmaz, kaynak olduğu gibi kalır.
+    if (skipped > 0) {
+        cerr << csvPath << ": " << skipped << " satır okunamadı, arşivlenmedi" << endl;
+        return false;
+    }
+
+    string target = directory + "/orders_" + to_string(date) + ".arc";
+    string temporary = target + ".tmp";
+    if (!writer.write(temporary, date, rowsPerBlock) || !verify(temporary, totals)) {
+        cerr << csvPath << ": arşiv yazılamadı veya doğrulanamadı" << endl;
+        unlink(temporary.c_str());
+        return false;
+    }
+    if (rename(temporary.c_str(), target.c_str()) != 0) {
+        cerr << target << ": yeniden adlandırılamadı" << endl;
+        unlink(temporary.c_str());
+        return false;
+    }
+
+    long before = fileSize(csvPath);
+    long after = fileSize(target);
+    cout << csvPath << " -> " << target << ": " << totals.rows << " satır, " << before << " -> " << after
+         << " bayt";
+    if (after > 0) cout << " (" << fixed << setprecision(1) << (double)before / after << "x)";
+    cout << endl;
+
+    if (removeSource && unlink(csvPath.c_str()) != 0) {
+        cerr << csvPath << ": silinemedi" << endl;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    ConfigReader config;
+    config.load("config.ini");
+    string directory = config.get("archive", "dir", "arsiv");
+    int rowsPerBlock = config.getInt("archive", "rows_per_block", 4096);
+    bool removeSource = false;
+    vector<string> files;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            rowsPerBlock = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sil") == 0) {
+            removeSource = true;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (rowsPerBlock <= 0) rowsPerBlock = 4096;
+
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        cerr << "Arşiv dizini oluşturulamadı: " << directory << endl;
+        return 1;
+    }
+
+    // Dosya verilmediyse kapanmış günler seçilir; arşivi CSV'den yeni olan gün atlanır.
+    if (files.empty()) {
+        DIR* current = opendir(".");
+        if (current == NULL) {
+            cerr << "Dizin okunamadı" << endl;
+            return 1;
+        }
+        uint32_t open = today();
+        struct dirent* entry;
+        while ((entry = readdir(current)) != NULL) {
+            string name = entry->d_name;
+            uint32_t date = dateFromName(name);
+            if (date == 0 || date >= open) continue;
+            struct stat source, archived;
+            string target = directory + "/orders_" + to_string(date) + ".arc";
+            if (stat(target.c_str(), &archived) == 0 && stat(name.c_str(), &source) == 0
+                && archived.st_mtime >= source.st_mtime) {
+                continue;
+            }
+            files.push_back(name);
+        }
+        closedir(current);
+        sort(files.begin(), files.end());
+    }
+
+    if (files.empty()) {
+        cout << "Arşivlenecek gün yok." << endl;
+        return 0;
+    }
+
+    int failed = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        uint32_t date = dateFromName(files[i]);
+        if (date == 0) {
+            cerr << files[i] << ": ad orders_YYYYMMDD.csv biçiminde değil" << endl;
+            failed++;
+            continue;
+        }
+        if (!archiveFile(files[i], date, directory, rowsPerBlock, removeSource)) failed++;
+    }
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,536 @@
+#ifndef ORDER_ARCHIVE_H
+#define ORDER_ARCHIVE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <fcntl.h>
+#include <unistd.h>
+
+const char ARCHIVE_MAGIC[8] = { 'B', 'R', 'S', 'A', 'R', 'C', '0', '1' };
+
+enum ArchiveDictionaryType {
+    ARCHIVE_SYMBOL = 0,
+    ARCHIVE_CLIENT,
+    ARCHIVE_SIDE,
+    ARCHIVE_STATUS,
+    ARCHIVE_DICTIONARIES
+};
+
+enum ArchiveColumn {
+    COLUMN_TIME = 0,        // zigzag varint, önceki satırdan fark (ilki blok minTime'dan)
+    COLUMN_SYMBOL,          // varint sözlük numarası
+    COLUMN_CLIENT,
+    COLUMN_SIDE,
+    COLUMN_STATUS,
+    COLUMN_PRICE,           // kuruş, zigzag varint, önceki satırdan fark (ilki blok minPrice'tan)
+    COLUMN_QUANTITY,        // zigzag varint
+    COLUMN_TOTAL,           // kuruş, zigzag varint, fiyat * adet'ten sapma (normalde 0)
+    COLUMN_ORDER_ID,        // varint uzunluk + bayt
+    ARCHIVE_COLUMNS
+};
+
+// Dosya düzeni: başlık, bloklar, sözlükler, blok dizini. Sözlükler alfabetik
+// sıralıdır; blok içindeki satırlar hisse, sonra zamana göre sıralı olduğundan
+// blokların hisse aralıkları dar kalır ve filtreli sorgular blok atlayabilir.
+struct ArchiveHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t date;                  // YYYYMMDD, kaynak CSV'nin günü
+    uint64_t rowCount;
+    uint32_t blockCount;
+    uint32_t rowsPerBlock;
+    int64_t minTime;                // duvar saati saniyesi (bkz. parseArchiveTime)
+    int64_t maxTime;
+    uint64_t dictionaryOffset;
+    uint64_t blockIndexOffset;
+};
+
+struct ArchiveBlockInfo {
+    uint64_t offset;
+    uint32_t bytes;
+    uint32_t rows;
+    int64_t minTime;
+    int64_t maxTime;
+    int64_t minPrice;
+    int64_t maxPrice;
+    uint32_t minSymbol;
+    uint32_t maxSymbol;
+    uint32_t minClient;
+    uint32_t maxClient;
+    uint32_t checksum;              // FNV-1a, blok gövdesi
+    uint32_t reserved;
+};
+
+struct ArchiveRow {
+    int64_t time;
+    std::string client;
+    std::string symbol;
+    std::string side;
+    int64_t price;
+    int32_t quantity;
+    int64_t total;
+    std::string status;
+    std::string orderId;
+};
+
+// Çözülmüş blok; sözlük alanları numara olarak kalır.
+struct ArchiveColumns {
+    std::vector<int64_t> time;
+    std::vector<uint32_t> symbol;
+    std::vector<uint32_t> client;
+    std::vector<uint32_t> side;
+    std::vector<uint32_t> status;
+    std::vector<int64_t> price;
+    std::vector<int32_t> quantity;
+    std::vector<int64_t> total;
+    std::vector<std::string> orderId;
+
+    size_t size() const {
+        return time.size();
+    }
+};
+
+// 1970-01-01'den gün sayısı (saat dilimi uygulanmaz; CSV'deki yerel saat aynen saklanır).
+inline int64_t archiveDaysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yoe = year - era * 400;
+    int64_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+inline void archiveCivilFromDays(int64_t days, int& year, int& month, int& day) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t doe = days - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    day = (int)(doy - (153 * mp + 2) / 5 + 1);
+    month = (int)(mp < 10 ? mp + 3 : mp - 9);
+    year = (int)(yoe + era * 400 + (month <= 2));
+}
+
+inline int64_t archiveDateStart(uint32_t date) {
+    return archiveDaysFromCivil(date / 10000, date / 100 % 100, date % 100) * 86400;
+}
+
+inline uint32_t archiveDateOf(int64_t time) {
+    int64_t days = time >= 0 ? time / 86400 : (time - 86399) / 86400;
+    int year, month, day;
+    archiveCivilFromDays(days, year, month, day);
+    return (uint32_t)(year * 10000 + month * 100 + day);
+}
+
+// "YYYY-MM-DD HH:MM:SS" -> saniye; biçim tutmazsa false.
+inline bool parseArchiveTime(const std::string& text, int64_t& time) {
+    int year, month, day, hour, minute, second;
+    if (sscanf(text.c_str(), "%4d-%2d-%2d %2d:%2d:%2d", &year, &month, &day, &hour, &minute, &second) != 6) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+    time = archiveDaysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    return true;
+}
+
+inline std::string formatArchiveTime(int64_t time) {
+    int64_t days = time >= 0 ? time / 86400 : (time - 86399) / 86400;
+    int64_t seconds = time - days * 86400;
+    int year, month, day;
+    archiveCivilFromDays(days, year, month, day);
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d %02d:%02d:%02d", year, month, day,
+             (int)(seconds / 3600), (int)(seconds / 60 % 60), (int)(seconds % 60));
+    return buffer;
+}
+
+// "122.15" -> 12215 kuruş.
+inline bool parseArchiveCents(const std::string& text, int64_t& cents) {
+    if (text.empty()) return false;
+    char* end = NULL;
+    double value = strtod(text.c_str(), &end);
+    if (end == text.c_str() || *end != '\0' || !std::isfinite(value)) return false;
+    cents = llround(value * 100);
+    return true;
+}
+
+inline std::string formatArchiveCents(int64_t cents) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%s%lld.%02lld", cents < 0 ? "-" : "",
+             (long long)(std::llabs(cents) / 100), (long long)(std::llabs(cents) % 100));
+    return buffer;
+}
+
+inline uint32_t archiveChecksum(const char* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ (uint8_t)data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+inline void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += (char)((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += (char)value;
+}
+
+inline void putSigned(std::string& out, int64_t value) {
+    putVarint(out, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+// Sınır dışına taşan veya 10 bayttan uzun varint bozuk sayılır.
+inline bool getVarint(const char*& p, const char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 70 && p < end; shift += 7) {
+        uint8_t byte = (uint8_t)*p++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+inline bool getSigned(const char*& p, const char* end, int64_t& value) {
+    uint64_t raw;
+    if (!getVarint(p, end, raw)) return false;
+    value = (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);
+    return true;
+}
+
+// Bir günün satırlarını bellekte toplar ve tek seferde yazar.
+class ArchiveWriter {
+private:
+    struct Pending {
+        int64_t time;
+        uint32_t ids[ARCHIVE_DICTIONARIES];
+        int64_t price;
+        int32_t quantity;
+        int64_t total;
+        uint32_t orderId;
+    };
+
+    std::vector<Pending> rows;
+    std::map<std::string, uint32_t> lookup[ARCHIVE_DICTIONARIES];
+    std::vector<std::string> orderIds;
+
+    uint32_t intern(int dictionary, const std::string& value) {
+        std::map<std::string, uint32_t>::iterator it = lookup[dictionary].find(value);
+        if (it != lookup[dictionary].end()) return it->second;
+        uint32_t id = (uint32_t)lookup[dictionary].size();
+        lookup[dictionary][value] = id;
+        return id;
+    }
+
+    static bool bySymbolTime(const Pending& a, const Pending& b) {
+        if (a.ids[ARCHIVE_SYMBOL] != b.ids[ARCHIVE_SYMBOL]) return a.ids[ARCHIVE_SYMBOL] < b.ids[ARCHIVE_SYMBOL];
+        return a.time < b.time;
+    }
+
+    static bool writeAll(FILE* file, const void* data, size_t size) {
+        return size == 0 || fwrite(data, 1, size, file) == size;
+    }
+
+    std::string encodeBlock(size_t first, size_t count, ArchiveBlockInfo& info) const {
+        info.rows = (uint32_t)count;
+        info.minTime = info.maxTime = rows[first].time;
+        info.minPrice = info.maxPrice = rows[first].price;
+        info.minSymbol = info.maxSymbol = rows[first].ids[ARCHIVE_SYMBOL];
+        info.minClient = info.maxClient = rows[first].ids[ARCHIVE_CLIENT];
+        for (size_t i = first; i < first + count; i++) {
+            const Pending& row = rows[i];
+            info.minTime = std::min(info.minTime, row.time);
+            info.maxTime = std::max(info.maxTime, row.time);
+            info.minPrice = std::min(info.minPrice, row.price);
+            info.maxPrice = std::max(info.maxPrice, row.price);
+            info.minSymbol = std::min(info.minSymbol, row.ids[ARCHIVE_SYMBOL]);
+            info.maxSymbol = std::max(info.maxSymbol, row.ids[ARCHIVE_SYMBOL]);
+            info.minClient = std::min(info.minClient, row.ids[ARCHIVE_CLIENT]);
+            info.maxClient = std::max(info.maxClient, row.ids[ARCHIVE_CLIENT]);
+        }
+
+        std::string columns[ARCHIVE_COLUMNS];
+        int64_t previousTime = info.minTime;
+        int64_t previousPrice = info.minPrice;
+        for (size_t i = first; i < first + count; i++) {
+            const Pending& row = rows[i];
+            putSigned(columns[COLUMN_TIME], row.time - previousTime);
+            previousTime = row.time;
+            putVarint(columns[COLUMN_SYMBOL], row.ids[ARCHIVE_SYMBOL]);
+            putVarint(columns[COLUMN_CLIENT], row.ids[ARCHIVE_CLIENT]);
+            putVarint(columns[COLUMN_SIDE], row.ids[ARCHIVE_SIDE]);
+            putVarint(columns[COLUMN_STATUS], row.ids[ARCHIVE_STATUS]);
+            putSigned(columns[COLUMN_PRICE], row.price - previousPrice);
+            previousPrice = row.price;
+            putSigned(columns[COLUMN_QUANTITY], row.quantity);
+            putSigned(columns[COLUMN_TOTAL], row.total - row.price * row.quantity);
+            const std::string& orderId = orderIds[row.orderId];
+            putVarint(columns[COLUMN_ORDER_ID], orderId.size());
+            columns[COLUMN_ORDER_ID] += orderId;
+        }
+
+        std::string block;
+        for (int c = 0; c < ARCHIVE_COLUMNS; c++) {
+            uint32_t length = (uint32_t)columns[c].size();
+            block.append((const char*)&length, sizeof(length));
+        }
+        for (int c = 0; c < ARCHIVE_COLUMNS; c++) {
+            block += columns[c];
+        }
+        info.bytes = (uint32_t)block.size();
+        info.checksum = archiveChecksum(block.data(), block.size());
+        info.reserved = 0;
+        return block;
+    }
+
+public:
+    void add(const ArchiveRow& row) {
+        Pending pending;
+        pending.time = row.time;
+        pending.ids[ARCHIVE_SYMBOL] = intern(ARCHIVE_SYMBOL, row.symbol);
+        pending.ids[ARCHIVE_CLIENT] = intern(ARCHIVE_CLIENT, row.client);
+        pending.ids[ARCHIVE_SIDE] = intern(ARCHIVE_SIDE, row.side);
+        pending.ids[ARCHIVE_STATUS] = intern(ARCHIVE_STATUS, row.status);
+        pending.price = row.price;
+        pending.quantity = row.quantity;
+        pending.total = row.total;
+        pending.orderId = (uint32_t)orderIds.size();
+        orderIds.push_back(row.orderId);
+        rows.push_back(pending);
+    }
+
+    size_t size() const {
+        return rows.size();
+    }
+
+    // Sözlükleri alfabetik sıraya çevirip satırları sıralar ve dosyayı yazar.
+    bool write(const std::string& path, uint32_t date, uint32_t rowsPerBlock) {
+        if (rowsPerBlock == 0) rowsPerBlock = 4096;
+
+        std::vector<std::string> dictionaries[ARCHIVE_DICTIONARIES];
+        for (int d = 0; d < ARCHIVE_DICTIONARIES; d++) {
+            std::vector<uint32_t> remap(lookup[d].size());
+            for (std::map<std::string, uint32_t>::iterator it = lookup[d].begin(); it != lookup[d].end(); ++it) {
+                remap[it->second] = (uint32_t)dictionaries[d].size();
+                dictionaries[d].push_back(it->first);
+            }
+            for (size_t i = 0; i < rows.size(); i++) {
+                rows[i].ids[d] = remap[rows[i].ids[d]];
+            }
+            std::map<std::string, uint32_t> sorted;
+            for (size_t i = 0; i < dictionaries[d].size(); i++) {
+                sorted[dictionaries[d][i]] = (uint32_t)i;
+            }
+            lookup[d].swap(sorted);
+        }
+        std::stable_sort(rows.begin(), rows.end(), bySymbolTime);
+
+        FILE* file = fopen(path.c_str(), "wb");
+        if (file == NULL) return false;
+
+        ArchiveHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+        header.version = 1;
+        header.date = date;
+        header.rowCount = rows.size();
+        header.rowsPerBlock = rowsPerBlock;
+        bool ok = writeAll(file, &header, sizeof(header));
+
+        std::vector<ArchiveBlockInfo> blocks;
+        uint64_t offset = sizeof(header);
+        for (size_t first = 0; first < rows.size() && ok; first += rowsPerBlock) {
+            ArchiveBlockInfo info;
+            std::string block = encodeBlock(first, std::min((size_t)rowsPerBlock, rows.size() - first), info);
+            info.offset = offset;
+            ok = writeAll(file, block.data(), block.size());
+            offset += block.size();
+            if (blocks.empty() || info.minTime < header.minTime) header.minTime = info.minTime;
+            if (blocks.empty() || info.maxTime > header.maxTime) header.maxTime = info.maxTime;
+            blocks.push_back(info);
+        }
+
+        header.dictionaryOffset = offset;
+        for (int d = 0; d < ARCHIVE_DICTIONARIES && ok; d++) {
+            std::string encoded;
+            putVarint(encoded, dictionaries[d].size());
+            for (size_t i = 0; i < dictionaries[d].size(); i++) {
+                putVarint(encoded, dictionaries[d][i].size());
+                encoded += dictionaries[d][i];
+            }
+            ok = writeAll(file, encoded.data(), encoded.size());
+            offset += encoded.size();
+        }
+
+        header.blockIndexOffset = offset;
+        header.blockCount = (uint32_t)blocks.size();
+        ok = ok && writeAll(file, blocks.data(), blocks.size() * sizeof(ArchiveBlockInfo));
+        ok = ok && fseek(file, 0, SEEK_SET) == 0 && writeAll(file, &header, sizeof(header));
+        ok = fflush(file) == 0 && fsync(fileno(file)) == 0 && ok;
+        return fclose(file) == 0 && ok;
+    }
+};
+
+// Başlık, sözlükler ve blok dizini açılışta okunur; bloklar pread ile okunduğundan
+// aynı okuyucudan birden çok thread farklı blokları eşzamanlı çözebilir.
+class ArchiveReader {
+private:
+    int fd;
+    std::string error;
+
+    ArchiveReader(const ArchiveReader&);
+    ArchiveReader& operator=(const ArchiveReader&);
+
+    bool readAt(uint64_t offset, void* data, size_t size) const {
+        char* p = (char*)data;
+        while (size > 0) {
+            ssize_t n = pread(fd, p, size, (off_t)offset);
+            if (n <= 0) return false;
+            p += n;
+            offset += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    bool fail(const std::string& message) {
+        error = message;
+        return false;
+    }
+
+public:
+    ArchiveHeader header;
+    std::vector<std::string> dictionaries[ARCHIVE_DICTIONARIES];
+    std::vector<ArchiveBlockInfo> blocks;
+
+    ArchiveReader() : fd(-1) {
+        memset(&header, 0, sizeof(header));
+    }
+
+    ~ArchiveReader() {
+        if (fd >= 0) close(fd);
+    }
+
+    bool open(const std::string& path) {
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return fail("açılamadı");
+        if (!readAt(0, &header, sizeof(header)) || memcmp(header.magic, ARCHIVE_MAGIC, sizeof(header.magic)) != 0) {
+            return fail("arşiv dosyası değil");
+        }
+        if (header.version != 1) return fail("desteklenmeyen sürüm " + std::to_string(header.version));
+        if (header.blockIndexOffset < header.dictionaryOffset) return fail("başlık bozuk");
+
+        std::string encoded(header.blockIndexOffset - header.dictionaryOffset, '\0');
+        if (!readAt(header.dictionaryOffset, &encoded[0], encoded.size())) return fail("sözlük okunamadı");
+        const char* p = encoded.data();
+        const char* end = p + encoded.size();
+        for (int d = 0; d < ARCHIVE_DICTIONARIES; d++) {
+            uint64_t count, length;
+            if (!getVarint(p, end, count) || count > encoded.size()) return fail("sözlük bozuk");
+            dictionaries[d].reserve(count);
+            for (uint64_t i = 0; i < count; i++) {
+                if (!getVarint(p, end, length) || length > (uint64_t)(end - p)) return fail("sözlük bozuk");
+                dictionaries[d].push_back(std::string(p, length));
+                p += length;
+            }
+        }
+
+        blocks.resize(header.blockCount);
+        if (!readAt(header.blockIndexOffset, blocks.data(), blocks.size() * sizeof(ArchiveBlockInfo))) {
+            return fail("blok dizini okunamadı");
+        }
+        return true;
+    }
+
+    const std::string& lastError() const {
+        return error;
+    }
+
+    // Sözlükte yoksa -1.
+    long find(int dictionary, const std::string& value) const {
+        const std::vector<std::string>& values = dictionaries[dictionary];
+        std::vector<std::string>::const_iterator it = std::lower_bound(values.begin(), values.end(), value);
+        return it != values.end() && *it == value ? (long)(it - values.begin()) : -1;
+    }
+
+    // buffer çağıranındır (thread başına bir tane); emir numaraları istenmezse atlanır.
+    bool readBlock(size_t index, std::string& buffer, ArchiveColumns& out, bool withOrderIds) const {
+        const ArchiveBlockInfo& info = blocks[index];
+        buffer.resize(info.bytes);
+        if (!readAt(info.offset, &buffer[0], info.bytes)) return false;
+        if (archiveChecksum(buffer.data(), buffer.size()) != info.checksum) return false;
+
+        const char* columnStart[ARCHIVE_COLUMNS];
+        const char* columnEnd[ARCHIVE_COLUMNS];
+        size_t position = sizeof(uint32_t) * ARCHIVE_COLUMNS;
+        if (position > buffer.size()) return false;
+        for (int c = 0; c < ARCHIVE_COLUMNS; c++) {
+            uint32_t length;
+            memcpy(&length, buffer.data() + c * sizeof(uint32_t), sizeof(length));
+            if (length > buffer.size() - position) return false;
+            columnStart[c] = buffer.data() + position;
+            columnEnd[c] = columnStart[c] + length;
+            position += length;
+        }
+
+        size_t rows = info.rows;
+        out.time.resize(rows);
+        out.symbol.resize(rows);
+        out.client.resize(rows);
+        out.side.resize(rows);
+        out.status.resize(rows);
+        out.price.resize(rows);
+        out.quantity.resize(rows);
+        out.total.resize(rows);
+        out.orderId.resize(withOrderIds ? rows : 0);
+
+        int64_t time = info.minTime;
+        int64_t price = info.minPrice;
+        uint64_t value;
+        int64_t delta;
+        for (size_t i = 0; i < rows; i++) {
+            if (!getSigned(columnStart[COLUMN_TIME], columnEnd[COLUMN_TIME], delta)) return false;
+            out.time[i] = time += delta;
+            if (!getVarint(columnStart[COLUMN_SYMBOL], columnEnd[COLUMN_SYMBOL], value)
+                || value >= dictionaries[ARCHIVE_SYMBOL].size()) return false;
+            out.symbol[i] = (uint32_t)value;
+            if (!getVarint(columnStart[COLUMN_CLIENT], columnEnd[COLUMN_CLIENT], value)
+                || value >= dictionaries[ARCHIVE_CLIENT].size()) return false;
+            out.client[i] = (uint32_t)value;
+            if (!getVarint(columnStart[COLUMN_SIDE], columnEnd[COLUMN_SIDE], value)
+                || value >= dictionaries[ARCHIVE_SIDE].size()) return false;
+            out.side[i] = (uint32_t)value;
+            if (!getVarint(columnStart[COLUMN_STATUS], columnEnd[COLUMN_STATUS], value)
+                || value >= dictionaries[ARCHIVE_STATUS].size()) return false;
+            out.status[i] = (uint32_t)value;
+            if (!getSigned(columnStart[COLUMN_PRICE], columnEnd[COLUMN_PRICE], delta)) return false;
+            out.price[i] = price += delta;
+            if (!getSigned(columnStart[COLUMN_QUANTITY], columnEnd[COLUMN_QUANTITY], delta)) return false;
+            out.quantity[i] = (int32_t)delta;
+            if (!getSigned(columnStart[COLUMN_TOTAL], columnEnd[COLUMN_TOTAL], delta)) return false;
+            out.total[i] = price * out.quantity[i] + delta;
+            if (withOrderIds) {
+                const char*& p = columnStart[COLUMN_ORDER_ID];
+                if (!getVarint(p, columnEnd[COLUMN_ORDER_ID], value) || value > (uint64_t)(columnEnd[COLUMN_ORDER_ID] - p)) {
+                    return false;
+                }
+                out.orderId[i].assign(p, value);
+                p += value;
+            }
+        }
+        return true;
+    }
+};
+
+#endif
@@ -18,6 +18,7 @@ struct Order {
     int quantity;
     double total_amount;
     std::string status;  
+    std::string order_id;   // server emir ID'si; kabulden önce boş
 };
 
 class OrderManager {
@@ -60,7 +61,8 @@ public:
              << std::fixed << std::setprecision(2) << order.price << "|"
              << order.quantity << "|"
              << std::fixed << std::setprecision(2) << order.total_amount << "|"
-             << order.status << std::endl;
+             << order.status << "|"
+             << order.order_id << std::endl;
         
         file.close();
         
@@ -78,7 +80,7 @@ public:
         }
         
         if (!fileExists) {
-            file << "Zaman,Client ID,Hisse,İşlem,Fiyat,Miktar,Toplam,Durum" << std::endl;
+            file << "Zaman,Client ID,Hisse,İşlem,Fiyat,Miktar,Toplam,Durum,Emir ID" << std::endl;
         }
         
         file << order.timestamp << ","
@@ -88,7 +90,8 @@ public:
              << std::fixed << std::setprecision(2) << order.price << ","
              << order.quantity << ","
              << std::fixed << std::setprecision(2) << order.total_amount << ","
-             << order.status << std::endl;
+             << order.status << ","
+             << order.order_id << std::endl;
         
         file.close();
         return true;
@@ -148,6 +151,13 @@ public:
         return order;
     }
 
+    // Durum geçişi kayıtlara yeni satır olarak eklenir; geçmiş satırlar değişmez.
+    bool updateStatus(Order& order, const std::string& status) {
+        order.status = status;
+        order.timestamp = getTimestamp();
+        return saveOrder(order);
+    }
+
     void generateDailySummary() {
         std::string summaryFile = "summary_" + getDateStamp() + ".txt";
         std::ofstream file(summaryFile);
@@ -179,6 +189,11 @@ public:
                 tokens.push_back(item);
             }
             
+            // Her emir gönderim satırıyla bir kez sayılır; sonraki satırlar durum geçişidir.
+            if (tokens.size() >= 8 && tokens[7] != "SENT" && tokens[7] != "EXECUTED") {
+                continue;
+            }
+            
             if (tokens.size() >= 7) {
                 totalOrders++;
                 if (tokens[3] == "BUY") buyOrders++;
@@ -0,0 +1,460 @@
+// Derleme: g++ -std=c++17 -O2 -pthread order_query.cpp -o order_query
+// Kullanım: ./order_query [-d YYYYMMDD[-YYYYMMDD]] [-s HISSE,..] [-c CLIENT,..] [-y AL|SAT]
+//                         [-u DURUM,..|hepsi] [-f min-max fiyat] [-g hisse|client|gun|yon|durum|yok]
+//                         [-l N satır listele] [-j thread]
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <set>
+#include <map>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <pthread.h>
+#include <dirent.h>
+#include "config_reader.h"
+#include "order_archive.h"
+
+using namespace std;
+
+enum GroupBy {
+    GROUP_SYMBOL,
+    GROUP_CLIENT,
+    GROUP_DAY,
+    GROUP_SIDE,
+    GROUP_STATUS,
+    GROUP_NONE
+};
+
+struct QueryAggregate {
+    long long count;
+    long long quantity;
+    int64_t notional;
+    int64_t minPrice;
+    int64_t maxPrice;
+
+    QueryAggregate() : count(0), quantity(0), notional(0), minPrice(0), maxPrice(0) {}
+
+    void add(int64_t price, int quantity, int64_t total) {
+        if (count == 0 || price < minPrice) minPrice = price;
+        if (count == 0 || price > maxPrice) maxPrice = price;
+        count++;
+        this->quantity += quantity;
+        notional += total;
+    }
+
+    void merge(const QueryAggregate& other) {
+        if (other.count == 0) return;
+        if (count == 0 || other.minPrice < minPrice) minPrice = other.minPrice;
+        if (count == 0 || other.maxPrice > maxPrice) maxPrice = other.maxPrice;
+        count += other.count;
+        quantity += other.quantity;
+        notional += other.notional;
+    }
+};
+
+struct ListedRow {
+    int64_t time;
+    size_t file;
+    uint32_t symbol;
+    uint32_t client;
+    uint32_t side;
+    uint32_t status;
+    int64_t price;
+    int quantity;
+    int64_t total;
+    string orderId;
+};
+
+// Filtre her dosyanın sözlüğüne göre maskeye çevrilir; prefix toplamı bir blok
+// aralığında aranan değer olup olmadığını sabit sürede söyler.
+struct FileMask {
+    vector<char> allowed;
+    vector<uint32_t> prefix;
+    bool any;
+
+    void build(const ArchiveReader& reader, int dictionary, const set<string>& values) {
+        const vector<string>& names = reader.dictionaries[dictionary];
+        allowed.assign(names.size(), values.empty() ? 1 : 0);
+        for (set<string>::const_iterator it = values.begin(); it != values.end(); ++it) {
+            long id = reader.find(dictionary, *it);
+            if (id >= 0) allowed[id] = 1;
+        }
+        prefix.assign(names.size() + 1, 0);
+        for (size_t i = 0; i < names.size(); i++) {
+            prefix[i + 1] = prefix[i] + allowed[i];
+        }
+        any = prefix.back() > 0;
+    }
+
+    bool overlaps(uint32_t low, uint32_t high) const {
+        return high < allowed.size() && low <= high && prefix[high + 1] > prefix[low];
+    }
+};
+
+struct QueryFile {
+    string path;
+    ArchiveReader reader;
+    FileMask masks[ARCHIVE_DICTIONARIES];
+    int64_t firstDay;
+};
+
+struct QueryFilter {
+    int64_t fromTime;
+    int64_t toTime;
+    int64_t minPrice;
+    int64_t maxPrice;
+    set<string> values[ARCHIVE_DICTIONARIES];
+};
+
+struct WorkItem {
+    size_t file;
+    size_t block;
+};
+
+struct QueryWorker {
+    pthread_t thread;
+    map<string, QueryAggregate> groups;
+    vector<ListedRow> listed;
+    long long rowsScanned;
+    long long rowsMatched;
+    int corruptBlocks;
+};
+
+QueryFilter filter;
+GroupBy groupBy = GROUP_SYMBOL;
+size_t listLimit = 0;
+vector<QueryFile*> files;
+vector<WorkItem> work;
+atomic<size_t> nextWork(0);
+
+vector<string> splitList(const string& text) {
+    vector<string> values;
+    stringstream ss(text);
+    string item;
+    while (getline(ss, item, ',')) {
+        if (!item.empty()) values.push_back(item);
+    }
+    return values;
+}
+
+bool parseDate(const string& text, uint32_t& date) {
+    if (text.size() != 8 || text.find_first_not_of("0123456789") != string::npos) return false;
+    date = (uint32_t)atoi(text.c_str());
+    return date / 100 % 100 >= 1 && date / 100 % 100 <= 12 && date % 100 >= 1 && date % 100 <= 31;
+}
+
+string groupName(const QueryFile& file, GroupBy by, uint32_t key) {
+    switch (by) {
+        case GROUP_SYMBOL: return file.reader.dictionaries[ARCHIVE_SYMBOL][key];
+        case GROUP_CLIENT: return file.reader.dictionaries[ARCHIVE_CLIENT][key];
+        case GROUP_SIDE: return file.reader.dictionaries[ARCHIVE_SIDE][key];
+        case GROUP_STATUS: return file.reader.dictionaries[ARCHIVE_STATUS][key];
+        case GROUP_DAY: return formatArchiveTime(file.firstDay + (int64_t)key * 86400).substr(0, 10);
+        default: return "";
+    }
+}
+
+void scanBlock(QueryWorker& worker, size_t fileIndex, const ArchiveColumns& columns,
+               vector<QueryAggregate>& local) {
+    const QueryFile& file = *files[fileIndex];
+    local.clear();
+    const vector<char>& symbols = file.masks[ARCHIVE_SYMBOL].allowed;
+    const vector<char>& clients = file.masks[ARCHIVE_CLIENT].allowed;
+    const vector<char>& sides = file.masks[ARCHIVE_SIDE].allowed;
+    const vector<char>& statuses = file.masks[ARCHIVE_STATUS].allowed;
+
+    for (size_t i = 0; i < columns.size(); i++) {
+        if (columns.time[i] < filter.fromTime || columns.time[i] > filter.toTime
+            || columns.price[i] < filter.minPrice || columns.price[i] > filter.maxPrice
+            || !symbols[columns.symbol[i]] || !clients[columns.client[i]]
+            || !sides[columns.side[i]] || !statuses[columns.status[i]]) {
+            continue;
+        }
+
+        uint32_t key = 0;
+        switch (groupBy) {
+            case GROUP_SYMBOL: key = columns.symbol[i]; break;
+            case GROUP_CLIENT: key = columns.client[i]; break;
+            case GROUP_SIDE: key = columns.side[i]; break;
+            case GROUP_STATUS: key = columns.status[i]; break;
+            case GROUP_DAY: key = (uint32_t)((columns.time[i] - file.firstDay) / 86400); break;
+            default: break;
+        }
+        if (key >= local.size()) local.resize(key + 1);
+        local[key].add(columns.price[i], columns.quantity[i], columns.total[i]);
+        worker.rowsMatched++;
+
+        if (listLimit > 0) {
+            ListedRow row;
+            row.time = columns.time[i];
+            row.file = fileIndex;
+            row.symbol = columns.symbol[i];
+            row.client = columns.client[i];
+            row.side = columns.side[i];
+            row.status = columns.status[i];
+            row.price = columns.price[i];
+            row.quantity = columns.quantity[i];
+            row.total = columns.total[i];
+            row.orderId = columns.orderId[i];
+            worker.listed.push_back(row);
+        }
+    }
+    worker.rowsScanned += columns.size();
+
+    for (size_t key = 0; key < local.size(); key++) {
+        if (local[key].count > 0) worker.groups[groupName(file, groupBy, (uint32_t)key)].merge(local[key]);
+    }
+}
+
+void* workerMain(void* arg) {
+    QueryWorker& worker = *(QueryWorker*)arg;
+    ArchiveColumns columns;
+    vector<QueryAggregate> local;
+    string buffer;
+
+    while (true) {
+        size_t index = nextWork.fetch_add(1);
+        if (index >= work.size()) break;
+        if (!files[work[index].file]->reader.readBlock(work[index].block, buffer, columns, listLimit > 0)) {
+            worker.corruptBlocks++;
+            continue;
+        }
+        scanBlock(worker, work[index].file, columns, local);
+    }
+    return NULL;
+}
+
+bool blockMatches(const QueryFile& file, const ArchiveBlockInfo& block) {
+    return block.maxTime >= filter.fromTime && block.minTime <= filter.toTime
+           && block.maxPrice >= filter.minPrice && block.minPrice <= filter.maxPrice
+           && file.masks[ARCHIVE_SYMBOL].overlaps(block.minSymbol, block.maxSymbol)
+           && file.masks[ARCHIVE_CLIENT].overlaps(block.minClient, block.maxClient);
+}
+
+bool earlierRow(const ListedRow& a, const ListedRow& b) {
+    return a.time < b.time;
+}
+
+double elapsedMs(const struct timespec& start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) * 1000.0 + (now.tv_nsec - start.tv_nsec) / 1000000.0;
+}
+
+int main(int argc, char* argv[]) {
+    ConfigReader config;
+    config.load("config.ini");
+    string directory = config.get("archive", "dir", "arsiv");
+    int threadCount = config.getInt("archive", "query_threads", 0);
+
+    uint32_t fromDate = 19000101, toDate = 99991231;
+    string statusList = "SENT,EXECUTED";
+    filter.minPrice = INT64_MIN;
+    filter.maxPrice = INT64_MAX;
+
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Eksik değer: " << option << endl;
+            return 1;
+        }
+        string value = argv[++i];
+        if (option == "-d") {
+            size_t dash = value.find('-');
+            bool ok = parseDate(value.substr(0, dash), fromDate);
+            toDate = fromDate;
+            if (ok && dash != string::npos) ok = parseDate(value.substr(dash + 1), toDate);
+            if (!ok || toDate < fromDate) {
+                cerr << "Geçersiz tarih aralığı: " << value << endl;
+                return 1;
+            }
+        } else if (option == "-s" || option == "-c" || option == "-y") {
+            int dictionary = option == "-s" ? ARCHIVE_SYMBOL : (option == "-c" ? ARCHIVE_CLIENT : ARCHIVE_SIDE);
+            vector<string> values = splitList(value);
+            filter.values[dictionary].insert(values.begin(), values.end());
+        } else if (option == "-u") {
+            statusList = value;
+        } else if (option == "-f") {
+            size_t dash = value.find('-', 1);
+            if (dash == string::npos || !parseArchiveCents(value.substr(0, dash), filter.minPrice)
+                || !parseArchiveCents(value.substr(dash + 1), filter.maxPrice)) {
+                cerr << "Geçersiz fiyat aralığı: " << value << endl;
+                return 1;
+            }
+        } else if (option == "-g") {
+            if (value == "hisse") groupBy = GROUP_SYMBOL;
+            else if (value == "client") groupBy = GROUP_CLIENT;
+            else if (value == "gun") groupBy = GROUP_DAY;
+            else if (value == "yon") groupBy = GROUP_SIDE;
+            else if (value == "durum") groupBy = GROUP_STATUS;
+            else if (value == "yok") groupBy = GROUP_NONE;
+            else {
+                cerr << "Geçersiz gruplama: " << value << " (hisse|client|gun|yon|durum|yok)" << endl;
+                return 1;
+            }
+        } else if (option == "-l") {
+            listLimit = (size_t)atol(value.c_str());
+        } else if (option == "-j") {
+            threadCount = atoi(value.c_str());
+        } else {
+            cerr << "Bilinmeyen seçenek: " << option << endl;
+            return 1;
+        }
+    }
+
+    // Varsayılan olarak her emir gönderim satırıyla bir kez sayılır (bkz. generateDailySummary);
+    // sonraki satırlar aynı emrin durum geçişleridir.
+    if (statusList != "hepsi") {
+        vector<string> statuses = splitList(statusList);
+        filter.values[ARCHIVE_STATUS].insert(statuses.begin(), statuses.end());
+    }
+    filter.fromTime = archiveDateStart(fromDate);
+    filter.toTime = archiveDateStart(toDate) + 86399;
+    if (threadCount <= 0) threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threadCount <= 0) threadCount = 1;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // Gün dosyası o günden önceki satırı içermez; gece yarısını geçen oturumun
+    // satırları sonraki güne taşabildiğinden alt sınır başlıktaki maxTime ile denetlenir.
+    DIR* archive = opendir(directory.c_str());
+    if (archive == NULL) {
+        cerr << "Arşiv dizini okunamadı: " << directory << endl;
+        return 1;
+    }
+    vector<string> names;
+    struct dirent* entry;
+    while ((entry = readdir(archive)) != NULL) {
+        string name = entry->d_name;
+        uint32_t date;
+        if (name.size() != 19 || name.compare(0, 7, "orders_") != 0 || name.compare(15, 4, ".arc") != 0) continue;
+        if (!parseDate(name.substr(7, 8), date) || date > toDate) continue;
+        names.push_back(name);
+    }
+    closedir(archive);
+    sort(names.begin(), names.end());
+
+    size_t totalBlocks = 0;
+    for (size_t i = 0; i < names.size(); i++) {
+        QueryFile* file = new QueryFile();
+        file->path = directory + "/" + names[i];
+        if (!file->reader.open(file->path)) {
+            cerr << file->path << ": " << file->reader.lastError() << endl;
+            delete file;
+            continue;
+        }
+        const ArchiveHeader& header = file->reader.header;
+        bool any = header.rowCount > 0 && header.maxTime >= filter.fromTime && header.minTime <= filter.toTime;
+        for (int d = 0; d < ARCHIVE_DICTIONARIES; d++) {
+            file->masks[d].build(file->reader, d, filter.values[d]);
+            any = any && file->masks[d].any;
+        }
+        totalBlocks += file->reader.blocks.size();
+        if (!any) {
+            delete file;
+            continue;
+        }
+
+        file->firstDay = archiveDateStart(archiveDateOf(header.minTime));
+        size_t index = files.size();
+        files.push_back(file);
+        for (size_t b = 0; b < file->reader.blocks.size(); b++) {
+            if (!blockMatches(*file, file->reader.blocks[b])) continue;
+            WorkItem item = { index, b };
+            work.push_back(item);
+        }
+    }
+
+    if (threadCount > (int)work.size()) threadCount = work.empty() ? 1 : (int)work.size();
+    vector<QueryWorker> workers(threadCount);
+    for (int t = 0; t < threadCount; t++) {
+        workers[t].rowsScanned = 0;
+        workers[t].rowsMatched = 0;
+        workers[t].corruptBlocks = 0;
+        if (t > 0) pthread_create(&workers[t].thread, NULL, workerMain, &workers[t]);
+    }
+    workerMain(&workers[0]);
+    for (int t = 1; t < threadCount; t++) {
+        pthread_join(workers[t].thread, NULL);
+    }
+
+    map<string, QueryAggregate> groups;
+    QueryAggregate overall;
+    vector<ListedRow> listed;
+    long long rowsScanned = 0, rowsMatched = 0;
+    int corruptBlocks = 0;
+    for (int t = 0; t < threadCount; t++) {
+        for (map<string, QueryAggregate>::iterator it = workers[t].groups.begin(); it != workers[t].groups.end(); ++it) {
+            groups[it->first].merge(it->second);
+            overall.merge(it->second);
+        }
+        listed.insert(listed.end(), workers[t].listed.begin(), workers[t].listed.end());
+        rowsScanned += workers[t].rowsScanned;
+        rowsMatched += workers[t].rowsMatched;
+        corruptBlocks += workers[t].corruptBlocks;
+    }
+    double queryMs = elapsedMs(start);
+
+    if (!listed.empty()) {
+        size_t count = min(listLimit, listed.size());
+        partial_sort(listed.begin(), listed.begin() + count, listed.end(), earlierRow);
+        cout << left << setw(20) << "Zaman" << setw(14) << "Client" << setw(8) << "Hisse" << setw(6) << "İşlem"
+             << right << setw(10) << "Fiyat" << setw(8) << "Adet" << setw(12) << "Toplam" << "  "
+             << left << setw(10) << "Durum" << "Emir ID" << right << endl;
+        cout << string(100, '-') << endl;
+        for (size_t i = 0; i < count; i++) {
+            const ListedRow& row = listed[i];
+            const ArchiveReader& reader = files[row.file]->reader;
+            cout << left << setw(20) << formatArchiveTime(row.time)
+                 << setw(14) << reader.dictionaries[ARCHIVE_CLIENT][row.client]
+                 << setw(8) << reader.dictionaries[ARCHIVE_SYMBOL][row.symbol]
+                 << setw(6) << reader.dictionaries[ARCHIVE_SIDE][row.side] << right
+                 << setw(10) << formatArchiveCents(row.price) << setw(8) << row.quantity
+                 << setw(12) << formatArchiveCents(row.total) << "  " << left
+                 << setw(10) << reader.dictionaries[ARCHIVE_STATUS][row.status] << row.orderId << right << endl;
+        }
+        if (listed.size() > count) cout << "... " << listed.size() - count << " satır daha" << endl;
+        cout << endl;
+    }
+
+    static const char* groupTitles[] = { "Hisse", "Client", "Gün", "İşlem", "Durum", "" };
+    cout << left << setw(14) << (groupBy == GROUP_NONE ? "" : groupTitles[groupBy]) << right
+         << setw(10) << "Emir" << setw(12) << "Adet" << setw(16) << "Tutar" << setw(10) << "VWAP"
+         << setw(10) << "Min" << setw(10) << "Max" << endl;
+    cout << string(82, '-') << endl;
+    if (groupBy != GROUP_NONE) {
+        for (map<string, QueryAggregate>::iterator it = groups.begin(); it != groups.end(); ++it) {
+            const QueryAggregate& aggregate = it->second;
+            cout << left << setw(14) << it->first << right << setw(10) << aggregate.count
+                 << setw(12) << aggregate.quantity << setw(16) << formatArchiveCents(aggregate.notional)
+                 << setw(10) << (aggregate.quantity > 0 ? formatArchiveCents(llround((double)aggregate.notional / aggregate.quantity)) : "-")
+                 << setw(10) << formatArchiveCents(aggregate.minPrice) << setw(10) << formatArchiveCents(aggregate.maxPrice) << endl;
+        }
+        cout << string(82, '-') << endl;
+    }
+    cout << left << setw(14) << "TOPLAM" << right << setw(10) << overall.count << setw(12) << overall.quantity
+         << setw(16) << formatArchiveCents(overall.notional)
+         << setw(10) << (overall.quantity > 0 ? formatArchiveCents(llround((double)overall.notional / overall.quantity)) : "-");
+    if (overall.count > 0) {
+        cout << setw(10) << formatArchiveCents(overall.minPrice) << setw(10) << formatArchiveCents(overall.maxPrice);
+    }
+    cout << endl;
+
+    cout << "\n" << files.size() << "/" << names.size() << " gün dosyası, " << work.size() << "/" << totalBlocks
+         << " blok tarandı, " << rowsScanned << " satırda " << rowsMatched << " eşleşme, " << threadCount
+         << " thread, " << fixed << setprecision(1) << queryMs << " ms" << endl;
+    if (corruptBlocks > 0) {
+        cerr << "*** " << corruptBlocks << " bozuk blok atlandı ***" << endl;
+    }
+
+    for (size_t i = 0; i < files.size(); i++) {
+        delete files[i];
+    }
+    return corruptBlocks > 0 ? 1 : 0;
+}
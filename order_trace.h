@@ -0,0 +1,276 @@
+#ifndef ORDER_TRACE_H
+#define ORDER_TRACE_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <ctime>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// Örneklenen emirlerin aşama sürelerini Chrome/Perfetto trace-event JSON'u olarak
+// toplar. Kapalıyken her aşama yalnızca thread'e özel bir bayrağı okur. Açıkken
+// her thread kendi tamponuna kilitsiz yazar; tampon dolunca kayıt düşer ve sayılır.
+// Bir emrin tüm aşamaları aynı thread'de ve iç içe olduğundan zaman çizelgesinde
+// dış "emir" aralığının altında görünür.
+class OrderTracer {
+private:
+    struct Span {
+        const char* name;       // sabit metin
+        int64_t startNs;
+        int64_t endNs;
+        int tid;
+        char order[24];
+    };
+
+    // Sahibi thread yazar; count yayınlanan kayıt sayısıdır. Thread bitince tampon
+    // başka bir thread'e geçer, thread numarası kayıtta tutulduğu için karışmaz.
+    struct Buffer {
+        std::vector<Span> spans;
+        std::atomic<size_t> count;
+        std::atomic<bool> owned;
+        unsigned generation;
+    };
+
+    struct ThreadState {
+        Buffer* buffer;
+        bool sampled;
+        int64_t orderStartNs;
+        char order[24];
+
+        ~ThreadState() {
+            if (buffer != NULL) buffer->owned.store(false);
+        }
+    };
+
+    static const size_t BUFFER_SPANS = 16384;
+
+    std::atomic<bool> enabled;
+    std::atomic<unsigned> generation;
+    std::atomic<uint64_t> orderCounter;
+    std::atomic<uint64_t> sampledOrders;
+    std::atomic<uint64_t> dropped;
+    std::atomic<int> sampleEvery;
+    pthread_mutex_t buffersMutex;
+    std::vector<Buffer*> buffers;
+
+    static ThreadState& state() {
+        static thread_local ThreadState current = { NULL, false, 0, { 0 } };
+        return current;
+    }
+
+    Buffer* acquireBuffer() {
+        pthread_mutex_lock(&buffersMutex);
+        Buffer* result = NULL;
+        for (size_t i = 0; i < buffers.size() && result == NULL; i++) {
+            bool expected = false;
+            if (buffers[i]->owned.compare_exchange_strong(expected, true)) result = buffers[i];
+        }
+        if (result == NULL) {
+            result = new Buffer();
+            result->spans.resize(BUFFER_SPANS);
+            result->count.store(0);
+            result->owned.store(true);
+            result->generation = generation.load();
+            buffers.push_back(result);
+        }
+        pthread_mutex_unlock(&buffersMutex);
+        return result;
+    }
+
+    void append(const char* name, int64_t startNs, int64_t endNs, const char* order) {
+        ThreadState& current = state();
+        if (current.buffer == NULL) current.buffer = acquireBuffer();
+        Buffer* buffer = current.buffer;
+
+        unsigned active = generation.load(std::memory_order_relaxed);
+        if (buffer->generation != active) {
+            buffer->count.store(0, std::memory_order_relaxed);
+            buffer->generation = active;
+        }
+        size_t index = buffer->count.load(std::memory_order_relaxed);
+        if (index >= buffer->spans.size()) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Span& span = buffer->spans[index];
+        span.name = name;
+        span.startNs = startNs;
+        span.endNs = endNs;
+        span.tid = (int)syscall(SYS_gettid);
+        snprintf(span.order, sizeof(span.order), "%s", order);
+        buffer->count.store(index + 1, std::memory_order_release);
+    }
+
+    static void appendEscaped(std::string& out, const char* text) {
+        for (; *text; text++) {
+            if (*text == '"' || *text == '\\') out += '\\';
+            out += *text;
+        }
+    }
+
+public:
+    OrderTracer() : enabled(false), generation(0), orderCounter(0), sampledOrders(0), dropped(0), sampleEvery(1) {
+        pthread_mutex_init(&buffersMutex, NULL);
+    }
+
+    static int64_t now() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+
+    // Önceki kayıtlar silinir; her every'inci emir izlenir.
+    void start(int every) {
+        sampleEvery.store(every > 0 ? every : 1);
+        if (enabled.load()) return;
+        generation.fetch_add(1);
+        orderCounter.store(0);
+        sampledOrders.store(0);
+        dropped.store(0);
+        enabled.store(true);
+    }
+
+    void stop() {
+        enabled.store(false);
+    }
+
+    bool running() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    // Socketten okuma anı yalnızca iz açıkken alınır.
+    int64_t receiveStamp() const {
+        return running() ? now() : 0;
+    }
+
+    // Emir işleme başında çağrılır; emir örneklenirse okuma bekleyişi kaydedilir.
+    bool beginOrder(int64_t receivedNs) {
+        if (!running() || receivedNs == 0) return false;
+        uint64_t seq = orderCounter.fetch_add(1, std::memory_order_relaxed);
+        if (seq % (uint64_t)sampleEvery.load(std::memory_order_relaxed) != 0) return false;
+
+        ThreadState& current = state();
+        current.sampled = true;
+        current.orderStartNs = receivedNs;
+        current.order[0] = '\0';
+        sampledOrders.fetch_add(1, std::memory_order_relaxed);
+        append("okuma bekleme", receivedNs, now(), "");
+        return true;
+    }
+
+    void setOrder(const std::string& orderId) {
+        ThreadState& current = state();
+        if (current.sampled) snprintf(current.order, sizeof(current.order), "%s", orderId.c_str());
+    }
+
+    void endOrder() {
+        ThreadState& current = state();
+        if (!current.sampled) return;
+        append("emir", current.orderStartNs, now(), current.order);
+        current.sampled = false;
+    }
+
+    static bool sampled() {
+        return state().sampled;
+    }
+
+    void span(const char* name, int64_t startNs) {
+        append(name, startNs, now(), "");
+    }
+
+    uint64_t sampledCount() const {
+        return sampledOrders.load();
+    }
+
+    uint64_t droppedCount() const {
+        return dropped.load();
+    }
+
+    int sampling() const {
+        return sampleEvery.load();
+    }
+
+    // Geçerli çağın kayıtları; iz durdurulduktan sonra çağrılır.
+    size_t writeJson(const std::string& filename) {
+        std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        size_t written = 0;
+        unsigned active = generation.load();
+        char line[256];
+
+        pthread_mutex_lock(&buffersMutex);
+        for (size_t b = 0; b < buffers.size(); b++) {
+            Buffer* buffer = buffers[b];
+            if (buffer->generation != active) continue;
+            size_t count = buffer->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < count; i++) {
+                const Span& span = buffer->spans[i];
+                snprintf(line, sizeof(line), "%s{\"name\":\"", written > 0 ? ",\n" : "");
+                out += line;
+                appendEscaped(out, span.name);
+                snprintf(line, sizeof(line), "\",\"cat\":\"emir\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                         span.tid, span.startNs / 1000.0, (span.endNs - span.startNs) / 1000.0);
+                out += line;
+                if (span.order[0] != '\0') {
+                    out += ",\"args\":{\"emir\":\"";
+                    appendEscaped(out, span.order);
+                    out += "\"}";
+                }
+                out += "}";
+                written++;
+            }
+        }
+        pthread_mutex_unlock(&buffersMutex);
+        out += "\n]}\n";
+
+        FILE* file = fopen(filename.c_str(), "w");
+        if (file == NULL) return 0;
+        fwrite(out.data(), 1, out.size(), file);
+        fclose(file);
+        return written;
+    }
+};
+
+extern OrderTracer orderTracer;
+
+// Örneklenen emrin bir aşaması; kapalıyken yalnızca thread bayrağı okunur.
+class TraceSpan {
+private:
+    const char* name;
+    int64_t startNs;
+
+    TraceSpan(const TraceSpan&);
+    TraceSpan& operator=(const TraceSpan&);
+
+public:
+    explicit TraceSpan(const char* spanName) : name(spanName), startNs(0) {
+        if (OrderTracer::sampled()) startNs = OrderTracer::now();
+    }
+
+    ~TraceSpan() {
+        if (startNs != 0) orderTracer.span(name, startNs);
+    }
+};
+
+// Bir emrin işlenişi; çıkışta (erken dönüşler dahil) emir aralığı kapanır.
+class OrderTraceScope {
+private:
+    OrderTraceScope(const OrderTraceScope&);
+    OrderTraceScope& operator=(const OrderTraceScope&);
+
+public:
+    explicit OrderTraceScope(int64_t receivedNs) {
+        orderTracer.beginOrder(receivedNs);
+    }
+
+    ~OrderTraceScope() {
+        orderTracer.endOrder();
+    }
+};
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef POSITION_LEDGER_H
+#define POSITION_LEDGER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdlib>
+
+struct Position {
+    std::string symbol;
+    long long quantity;     // net adet: pozitif uzun, negatif kısa
+    double averageCost;     // açık pozisyonun ortalama maliyeti
+    double realizedPnl;
+    double notional;        // işlem gören toplam tutar (alış + satış)
+    long long bought;
+    long long sold;
+
+    Position() : quantity(0), averageCost(0), realizedPnl(0), notional(0), bought(0), sold(0) {}
+
+    double unrealizedPnl(double markPrice) const {
+        if (quantity == 0 || markPrice <= 0 || markPrice == averageCost) return 0;
+        return quantity * (markPrice - averageCost);
+    }
+};
+
+// Client başına sembol pozisyonları. Her dolum O(1) ile işlenir: aynı yöndeki
+// dolum ortalama maliyeti günceller, ters yöndeki dolum kapanan kısım için
+// gerçekleşen K/Z yazar; pozisyon yön değiştirirse kalan kısım işlem fiyatından
+// açılır. Client toplam uzun/kısa maliyetleri de aynı adımda güncellenir.
+// Kilit tutmaz, çağıran eşleştirme kilidi altında kullanır.
+class PositionLedger {
+private:
+    struct Account {
+        std::unordered_map<std::string, Position> positions;
+        double longCost;
+        double shortCost;
+
+        Account() : longCost(0), shortCost(0) {}
+
+        void addExposure(const Position& position, double sign) {
+            double cost = std::llabs(position.quantity) * position.averageCost * sign;
+            if (position.quantity > 0) longCost += cost;
+            else shortCost += cost;
+        }
+    };
+
+    std::unordered_map<int, Account> accounts;
+
+public:
+    void apply(int clientId, const std::string& symbol, bool buy, double price, int fillQuantity) {
+        Account& account = accounts[clientId];
+        Position& position = account.positions[symbol];
+        position.symbol = symbol;
+        account.addExposure(position, -1);
+
+        long long delta = buy ? fillQuantity : -fillQuantity;
+        long long previous = position.quantity;
+
+        if (previous == 0 || (previous > 0) == (delta > 0)) {
+            long long open = std::llabs(previous);
+            position.averageCost = (position.averageCost * open + price * fillQuantity) / (open + fillQuantity);
+        } else {
+            long long closing = std::min(std::llabs(previous), (long long)fillQuantity);
+            position.realizedPnl += closing * (price - position.averageCost) * (previous > 0 ? 1 : -1);
+            if (std::llabs(delta) > std::llabs(previous)) {
+                position.averageCost = price;
+            } else if (previous + delta == 0) {
+                position.averageCost = 0;
+            }
+        }
+
+        position.quantity = previous + delta;
+        position.notional += price * fillQuantity;
+        if (buy) position.bought += fillQuantity;
+        else position.sold += fillQuantity;
+        account.addExposure(position, 1);
+    }
+
+    // Açık pozisyonların maliyet bazında uzun ve kısa toplamları.
+    void exposure(int clientId, double& longCost, double& shortCost) const {
+        std::unordered_map<int, Account>::const_iterator account = accounts.find(clientId);
+        if (account == accounts.end()) {
+            longCost = shortCost = 0;
+            return;
+        }
+        longCost = account->second.longCost;
+        shortCost = account->second.shortCost;
+    }
+
+    // Sembole göre sıralı kopya.
+    std::vector<Position> positionsOf(int clientId) const {
+        std::vector<Position> result;
+        std::unordered_map<int, Account>::const_iterator account = accounts.find(clientId);
+        if (account == accounts.end()) return result;
+
+        for (std::unordered_map<std::string, Position>::const_iterator it = account->second.positions.begin();
+             it != account->second.positions.end(); ++it) {
+            result.push_back(it->second);
+        }
+        std::sort(result.begin(), result.end(),
+                  [](const Position& a, const Position& b) { return a.symbol < b.symbol; });
+        return result;
+    }
+
+    std::vector<int> clients() const {
+        std::vector<int> result;
+        for (std::unordered_map<int, Account>::const_iterator it = accounts.begin();
+             it != accounts.end(); ++it) {
+            result.push_back(it->first);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    void clear() {
+        accounts.clear();
+    }
+
+    // Kayıt: client|sembol|adet|ortMaliyet|gerçekleşenKZ|tutar|alınan|satılan
+    std::vector<std::string> records() const {
+        std::vector<std::string> result;
+        std::vector<int> ids = clients();
+        for (size_t i = 0; i < ids.size(); i++) {
+            std::vector<Position> positions = positionsOf(ids[i]);
+            for (size_t j = 0; j < positions.size(); j++) {
+                const Position& p = positions[j];
+                std::ostringstream out;
+                out << std::setprecision(15) << ids[i] << "|" << p.symbol << "|" << p.quantity << "|"
+                    << p.averageCost << "|" << p.realizedPnl << "|" << p.notional << "|"
+                    << p.bought << "|" << p.sold;
+                result.push_back(out.str());
+            }
+        }
+        return result;
+    }
+
+    bool restore(const std::string& record) {
+        std::stringstream fields(record);
+        std::string clientStr, symbol, quantityStr, costStr, realizedStr, notionalStr, boughtStr, soldStr;
+        getline(fields, clientStr, '|');
+        getline(fields, symbol, '|');
+        getline(fields, quantityStr, '|');
+        getline(fields, costStr, '|');
+        getline(fields, realizedStr, '|');
+        getline(fields, notionalStr, '|');
+        getline(fields, boughtStr, '|');
+        getline(fields, soldStr, '|');
+        if (clientStr.empty() || symbol.empty() || soldStr.empty()) return false;
+
+        Account& account = accounts[atoi(clientStr.c_str())];
+        Position& position = account.positions[symbol];
+        account.addExposure(position, -1);
+        position.symbol = symbol;
+        position.quantity = atoll(quantityStr.c_str());
+        position.averageCost = atof(costStr.c_str());
+        position.realizedPnl = atof(realizedStr.c_str());
+        position.notional = atof(notionalStr.c_str());
+        position.bought = atoll(boughtStr.c_str());
+        position.sold = atoll(soldStr.c_str());
+        account.addExposure(position, 1);
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef RANDOM_TOKEN_H
+#define RANDOM_TOKEN_H
+
+#include <string>
+#include <cstdio>
+#include <cstddef>
+
+// /dev/urandom'dan bytes baytlık rastgele değer, onaltılık yazılır. Okunamazsa
+// boş döner; tahmin edilebilir bir yedeğe düşülmez.
+inline std::string randomToken(size_t bytes = 16) {
+    unsigned char buffer[64];
+    if (bytes == 0 || bytes > sizeof(buffer)) return "";
+    FILE* source = fopen("/dev/urandom", "rb");
+    if (source == NULL) return "";
+    size_t got = fread(buffer, 1, bytes, source);
+    fclose(source);
+    if (got != bytes) return "";
+
+    static const char digits[] = "0123456789abcdef";
+    std::string token;
+    token.reserve(bytes * 2);
+    for (size_t i = 0; i < bytes; i++) {
+        token += digits[buffer[i] >> 4];
+        token += digits[buffer[i] & 0x0f];
+    }
+    return token;
+}
+
+#endif
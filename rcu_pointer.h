@@ -0,0 +1,92 @@
+#ifndef RCU_POINTER_H
+#define RCU_POINTER_H
+
+#include <atomic>
+#include <pthread.h>
+#include <unistd.h>
+
+// Okuma ağırlıklı, nadiren değişen değişmez veri için RCU tarzı işaretçi.
+// Okuyucu yalnızca o anki çağın sayacını artırıp işaretçiyi okur; kilit almaz.
+// Yazar yeni nesneyi yayınlar, çağı çevirir ve eski çağın okuyucuları
+// bitene kadar bekleyip eski nesneyi siler. Okuyucu sayacı artırdıktan sonra
+// çağı yeniden doğrular; böylece sayılmadan eski nesneyi görebilecek okuyucu kalmaz.
+template <typename T>
+class RcuPointer {
+private:
+    std::atomic<const T*> current;
+    std::atomic<unsigned> epoch;
+    std::atomic<long> readers[2];
+    pthread_mutex_t writerMutex;
+
+public:
+    RcuPointer() : current(NULL), epoch(0) {
+        readers[0].store(0);
+        readers[1].store(0);
+        pthread_mutex_init(&writerMutex, NULL);
+    }
+
+    ~RcuPointer() {
+        delete current.load();
+    }
+
+    const T* readLock(unsigned& slot) {
+        while (true) {
+            unsigned observed = epoch.load();
+            slot = observed & 1;
+            readers[slot].fetch_add(1);
+            if (epoch.load() == observed) break;
+            readers[slot].fetch_sub(1);
+        }
+        return current.load();
+    }
+
+    void readUnlock(unsigned slot) {
+        readers[slot].fetch_sub(1);
+    }
+
+    // Sahiplik alınır; dönüşte eski nesneyi gören okuyucu kalmamıştır.
+    void update(const T* next) {
+        pthread_mutex_lock(&writerMutex);
+        const T* previous = current.exchange(next);
+        unsigned slot = epoch.fetch_add(1) & 1;
+        while (readers[slot].load() != 0) {
+            usleep(50);
+        }
+        pthread_mutex_unlock(&writerMutex);
+        delete previous;
+    }
+};
+
+template <typename T>
+class RcuReadGuard {
+private:
+    RcuPointer<T>& owner;
+    unsigned slot;
+    const T* value;
+
+    RcuReadGuard(const RcuReadGuard&);
+    RcuReadGuard& operator=(const RcuReadGuard&);
+
+public:
+    explicit RcuReadGuard(RcuPointer<T>& pointer) : owner(pointer) {
+        value = owner.readLock(slot);
+    }
+
+    ~RcuReadGuard() {
+        owner.readUnlock(slot);
+    }
+
+    const T* get() const {
+        return value;
+    }
+
+    const T* operator->() const {
+        return value;
+    }
+
+    const T& operator*() const {
+        return *value;
+    }
+};
+
+#endif
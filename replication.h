@@ -0,0 +1,329 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <sstream>
+#include <iomanip>
+#include <cstdint>
+#include <cstdlib>
+#include <cerrno>
+#include <ctime>
+#include <pthread.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+inline int64_t replicationNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Mikrosaniye cinsinden log2 kovalı gecikme histogramı.
+class LatencyStats {
+private:
+    long long buckets[40];
+    long long count;
+    double sumUs;
+    double maxUs;
+
+public:
+    LatencyStats() {
+        reset();
+    }
+
+    void reset() {
+        for (int i = 0; i < 40; i++) buckets[i] = 0;
+        count = 0;
+        sumUs = 0;
+        maxUs = 0;
+    }
+
+    void add(int64_t nanos) {
+        double us = nanos > 0 ? nanos / 1000.0 : 0;
+        int bucket = 0;
+        while (bucket < 39 && (1LL << bucket) < us) bucket++;
+        buckets[bucket]++;
+        count++;
+        sumUs += us;
+        if (us > maxUs) maxUs = us;
+    }
+
+    long long samples() const {
+        return count;
+    }
+
+    double averageUs() const {
+        return count > 0 ? sumUs / count : 0;
+    }
+
+    double percentileUs(double p) const {
+        long long target = (long long)(count * p);
+        long long seen = 0;
+        for (int i = 0; i < 40; i++) {
+            seen += buckets[i];
+            if (seen > target) return (double)(1LL << i);
+        }
+        return maxUs;
+    }
+
+    std::string summary() const {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1)
+            << "n=" << count << " ort=" << averageUs() << "us p50<=" << percentileUs(0.5)
+            << "us p99<=" << percentileUs(0.99) << "us max=" << maxUs << "us";
+        return out.str();
+    }
+};
+
+// Primary tarafı: olaylar "R|seq|ns|gövde" satırları olarak yedeğe akıtılır.
+// publish() eşleştirme kilidi altında çağrılır ve yalnızca kuyruğa ekler;
+// gönderim ve ACK okuma ayrı thread'lerdedir. ack modunda waitAck() yedeğin
+// ilgili seq'i uyguladığını bildirmesini (veya zaman aşımını) bekler.
+class ReplicationPrimary {
+private:
+    pthread_mutex_t mutex;
+    pthread_cond_t sendCond;
+    pthread_cond_t ackCond;
+    pthread_cond_t sendDone;
+    std::deque<std::string> pending;
+    std::deque<std::pair<uint64_t, int64_t> > inFlight;
+    int standbySocket;
+    int generation;
+    int sendingGeneration;      // gönderici kilitsiz send içindeyken soketin nesli; 0: yok
+    uint64_t seq;
+    uint64_t ackedSeq;
+    bool ackMode;
+    int ackTimeoutMs;
+    LatencyStats ackLatency;
+    LatencyStats ackWait;
+    long long ackTimeouts;
+    bool running;
+
+    std::string frame(uint64_t eventSeq, const std::string& body) {
+        std::ostringstream out;
+        out << "R|" << eventSeq << "|" << replicationNanos() << "|" << body << "\n";
+        return out.str();
+    }
+
+    // mutex tutulurken çağrılır. Soket burada kapatılmaz: gönderici veya ACK okuyucu
+    // hâlâ kullanıyor olabilir, numara yeniden kullanılırsa başka bağlantıya yazılırdı.
+    // shutdown ikisini de uyandırır; soketi o neslin ACK okuyucusu kapatır.
+    void detachLocked(int expectedGeneration) {
+        if (standbySocket < 0 || generation != expectedGeneration) return;
+        shutdown(standbySocket, SHUT_RDWR);
+        standbySocket = -1;
+        pending.clear();
+        inFlight.clear();
+        pthread_cond_broadcast(&ackCond);
+    }
+
+    static void* senderLoop(void* arg) {
+        ReplicationPrimary* self = (ReplicationPrimary*)arg;
+        std::deque<std::string> batch;
+
+        pthread_mutex_lock(&self->mutex);
+        while (self->running) {
+            if (self->pending.empty()) {
+                struct timespec deadline;
+                clock_gettime(CLOCK_REALTIME, &deadline);
+                deadline.tv_nsec += 100000000;
+                if (deadline.tv_nsec >= 1000000000) {
+                    deadline.tv_sec++;
+                    deadline.tv_nsec -= 1000000000;
+                }
+                pthread_cond_timedwait(&self->sendCond, &self->mutex, &deadline);
+            }
+            if (self->standbySocket < 0) continue;
+
+            if (self->pending.empty()) {
+                self->pending.push_back(self->frame(self->seq, "HB"));
+            }
+            batch.swap(self->pending);
+            int socket = self->standbySocket;
+            int currentGeneration = self->generation;
+            self->sendingGeneration = currentGeneration;
+            pthread_mutex_unlock(&self->mutex);
+
+            std::string out;
+            for (size_t i = 0; i < batch.size(); i++) out += batch[i];
+            batch.clear();
+
+            size_t sent = 0;
+            bool failed = false;
+            while (sent < out.size()) {
+                ssize_t n = send(socket, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) {
+                    failed = true;
+                    break;
+                }
+                sent += n;
+            }
+
+            pthread_mutex_lock(&self->mutex);
+            self->sendingGeneration = 0;
+            pthread_cond_broadcast(&self->sendDone);
+            if (failed) self->detachLocked(currentGeneration);
+        }
+        pthread_mutex_unlock(&self->mutex);
+        return NULL;
+    }
+
+    struct AckReaderArgs {
+        ReplicationPrimary* self;
+        int socket;
+        int generation;
+    };
+
+    static void* ackLoop(void* arg) {
+        AckReaderArgs* args = (AckReaderArgs*)arg;
+        ReplicationPrimary* self = args->self;
+        std::string buffered;
+        char buffer[4096];
+
+        while (true) {
+            ssize_t n = recv(args->socket, buffer, sizeof(buffer), 0);
+            if (n <= 0) break;
+            buffered.append(buffer, n);
+
+            uint64_t acked = 0;
+            size_t newline;
+            while ((newline = buffered.find('\n')) != std::string::npos) {
+                std::string line = buffered.substr(0, newline);
+                buffered.erase(0, newline + 1);
+                if (line.compare(0, 4, "ACK|") == 0) {
+                    acked = strtoull(line.c_str() + 4, NULL, 10);
+                }
+            }
+
+            if (acked > 0) {
+                int64_t now = replicationNanos();
+                pthread_mutex_lock(&self->mutex);
+                if (self->generation == args->generation && acked > self->ackedSeq) {
+                    self->ackedSeq = acked;
+                    while (!self->inFlight.empty() && self->inFlight.front().first <= acked) {
+                        self->ackLatency.add(now - self->inFlight.front().second);
+                        self->inFlight.pop_front();
+                    }
+                    pthread_cond_broadcast(&self->ackCond);
+                }
+                pthread_mutex_unlock(&self->mutex);
+            }
+        }
+
+        // recv döndüyse soket ya kapandı ya da detach edildi; gönderici bu neslin soketiyle
+        // işini bitirince kapatılır. Sonraki turda gönderici yeni soketi kullanır.
+        pthread_mutex_lock(&self->mutex);
+        self->detachLocked(args->generation);
+        while (self->sendingGeneration == args->generation) {
+            pthread_cond_wait(&self->sendDone, &self->mutex);
+        }
+        pthread_mutex_unlock(&self->mutex);
+        close(args->socket);
+        delete args;
+        return NULL;
+    }
+
+public:
+    ReplicationPrimary() : standbySocket(-1), generation(0), sendingGeneration(0), seq(0), ackedSeq(0),
+                           ackMode(false), ackTimeoutMs(200), ackTimeouts(0), running(false) {
+        pthread_mutex_init(&mutex, NULL);
+        pthread_cond_init(&sendCond, NULL);
+        pthread_cond_init(&ackCond, NULL);
+        pthread_cond_init(&sendDone, NULL);
+    }
+
+    void start(bool acknowledged, int timeoutMs) {
+        ackMode = acknowledged;
+        ackTimeoutMs = timeoutMs;
+        running = true;
+
+        pthread_t thread;
+        pthread_create(&thread, NULL, senderLoop, this);
+        pthread_detach(thread);
+    }
+
+    // Çağıran, olay akışını dondurmak için eşleştirme kilidini tutmalıdır;
+    // syncBodies o anki durumun tam görüntüsüdür ve ilk olarak gönderilir.
+    void attach(int socket, const std::vector<std::string>& syncBodies) {
+        pthread_mutex_lock(&mutex);
+        if (standbySocket >= 0) {
+            detachLocked(generation);
+        }
+        standbySocket = socket;
+        generation++;
+        ackedSeq = seq;
+        for (size_t i = 0; i < syncBodies.size(); i++) {
+            pending.push_back(frame(seq, syncBodies[i]));
+        }
+
+        AckReaderArgs* args = new AckReaderArgs;
+        args->self = this;
+        args->socket = socket;
+        args->generation = generation;
+        pthread_t thread;
+        pthread_create(&thread, NULL, ackLoop, args);
+        pthread_detach(thread);
+
+        pthread_cond_signal(&sendCond);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    uint64_t publish(const std::string& body) {
+        pthread_mutex_lock(&mutex);
+        uint64_t eventSeq = ++seq;
+        if (standbySocket >= 0) {
+            pending.push_back(frame(eventSeq, body));
+            inFlight.push_back(std::make_pair(eventSeq, replicationNanos()));
+            pthread_cond_signal(&sendCond);
+        }
+        pthread_mutex_unlock(&mutex);
+        return eventSeq;
+    }
+
+    bool waitAck(uint64_t eventSeq) {
+        if (!ackMode) return true;
+
+        int64_t started = replicationNanos();
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += ackTimeoutMs / 1000;
+        deadline.tv_nsec += (ackTimeoutMs % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        bool acked = true;
+        pthread_mutex_lock(&mutex);
+        while (standbySocket >= 0 && ackedSeq < eventSeq) {
+            if (pthread_cond_timedwait(&ackCond, &mutex, &deadline) == ETIMEDOUT) {
+                acked = ackedSeq >= eventSeq;
+                if (!acked) ackTimeouts++;
+                break;
+            }
+        }
+        ackWait.add(replicationNanos() - started);
+        pthread_mutex_unlock(&mutex);
+        return acked;
+    }
+
+    std::string status() {
+        std::ostringstream out;
+        pthread_mutex_lock(&mutex);
+        out << "Rol: primary (" << (ackMode ? "ack" : "async") << ")\n"
+            << "Yedek bağlı: " << (standbySocket >= 0 ? "evet" : "hayır") << "\n"
+            << "Son seq: " << seq << ", onaylanan: " << ackedSeq
+            << ", kuyrukta: " << pending.size() << "\n"
+            << "Replikasyon gecikmesi (yayın->ACK): " << ackLatency.summary() << "\n";
+        if (ackMode) {
+            out << "ACK bekleme: " << ackWait.summary() << ", zaman aşımı: " << ackTimeouts << "\n";
+        }
+        pthread_mutex_unlock(&mutex);
+        return out.str();
+    }
+};
+
+#endif
@@ -0,0 +1,224 @@
+#ifndef RISK_ENGINE_H
+#define RISK_ENGINE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include "position_ledger.h"
+
+enum RiskResult {
+    RISK_OK = 0,
+    RISK_PRICE_BAND,
+    RISK_TICK_SIZE,
+    RISK_MAX_QUANTITY,
+    RISK_MAX_NOTIONAL,
+    RISK_GROSS_EXPOSURE,
+    RISK_NET_EXPOSURE,
+    RISK_OPEN_ORDERS,
+    RISK_INVALID_ORDER,
+    RISK_RESULT_COUNT
+};
+
+// Emir reddi metni; fiyat bandı mevcut istemcilerle uyum için eski metni korur.
+inline const char* riskRejectText(int result) {
+    static const char* texts[RISK_RESULT_COUNT] = {
+        "OK",
+        "Fiyat limitinin disinda",
+        "Fiyat tick buyuklugune uymuyor",
+        "Azami emir miktari asildi",
+        "Azami emir tutari asildi",
+        "Brut pozisyon limiti asildi",
+        "Net pozisyon limiti asildi",
+        "Acik emir sayisi limiti asildi",
+        "Gecersiz emir"
+    };
+    return result >= 0 && result < RISK_RESULT_COUNT ? texts[result] : "Risk reddi";
+}
+
+struct SymbolRiskLimits {
+    double tickSize;        // 0: kontrol yok
+    double minPrice;
+    double maxPrice;        // 0: bant yok
+    long long maxQuantity;
+    double maxNotional;
+};
+
+struct ClientRiskLimits {
+    double maxGrossExposure;
+    double maxNetExposure;
+    int maxOpenOrders;
+};
+
+// Eşleştirme öncesi risk kontrolü. Sembol tabloları yüklemede hazırlanır; client
+// tarafında açık emir sayısı ve açık alış/satış tutarı emir kitaba girerken ve
+// çıkarken artımlı tutulur, pozisyon maliyetleri defterden okunur. Böylece bir
+// kontrol üç hash araması ve birkaç karşılaştırmadır. Kilit tutmaz; kontrol ve
+// güncellemeler eşleştirme kilidi altında yapılır.
+class RiskEngine {
+private:
+    struct ClientState {
+        int openOrders;
+        double openBuyNotional;
+        double openSellNotional;
+
+        ClientState() : openOrders(0), openBuyNotional(0), openSellNotional(0) {}
+    };
+
+    const PositionLedger& ledger;
+    SymbolRiskLimits defaultSymbol;
+    ClientRiskLimits clientLimits;
+    std::unordered_map<std::string, SymbolRiskLimits> symbols;
+    std::unordered_map<int, ClientState> clients;
+    long long checks;
+    long long rejects[RISK_RESULT_COUNT];
+
+public:
+    explicit RiskEngine(const PositionLedger& positions) : ledger(positions), checks(0) {
+        defaultSymbol.tickSize = 0;
+        defaultSymbol.minPrice = 0;
+        defaultSymbol.maxPrice = 0;
+        defaultSymbol.maxQuantity = 0;
+        defaultSymbol.maxNotional = 0;
+        clientLimits.maxGrossExposure = 0;
+        clientLimits.maxNetExposure = 0;
+        clientLimits.maxOpenOrders = 0;
+        for (int i = 0; i < RISK_RESULT_COUNT; i++) rejects[i] = 0;
+    }
+
+    // Tabloların tamamı değiştirilir; client sayaçları korunur.
+    void configure(const SymbolRiskLimits& fallback, const ClientRiskLimits& perClient,
+                   const std::unordered_map<std::string, SymbolRiskLimits>& perSymbol) {
+        defaultSymbol = fallback;
+        clientLimits = perClient;
+        symbols = perSymbol;
+    }
+
+    // side AL veya SAT olmalıdır; miktar ve fiyat pozitif olmayan emir reddedilir.
+    int check(int clientId, const std::string& symbol, const std::string& side, double price, int quantity) {
+        return checkStop(clientId, symbol, side, price, price, quantity);
+    }
+
+    // Stop emri tek kontrol sayılır: tetik fiyatı bant/tick için, limit fiyatı
+    // (stop piyasada bant ucu) ayrıca tüm limitler için sınanır.
+    int checkStop(int clientId, const std::string& symbol, const std::string& side,
+                  double triggerPrice, double price, int quantity) {
+        checks++;
+        int result;
+        if ((side != "AL" && side != "SAT") || quantity <= 0 || !(price > 0) || !(triggerPrice > 0)) {
+            result = RISK_INVALID_ORDER;
+        } else {
+            result = evaluate(clientId, symbol, side == "AL", triggerPrice, quantity);
+            if (result == RISK_OK && price != triggerPrice) {
+                result = evaluate(clientId, symbol, side == "AL", price, quantity);
+            }
+        }
+        rejects[result]++;
+        return result;
+    }
+
+    // Limit değerleri 0 olan kontroller atlanır.
+    int evaluate(int clientId, const std::string& symbol, bool buy, double price, int quantity) const {
+        std::unordered_map<std::string, SymbolRiskLimits>::const_iterator found = symbols.find(symbol);
+        const SymbolRiskLimits& limits = found != symbols.end() ? found->second : defaultSymbol;
+
+        if (limits.maxPrice > 0 && (price < limits.minPrice || price > limits.maxPrice)) {
+            return RISK_PRICE_BAND;
+        }
+        if (limits.tickSize > 0) {
+            double ticks = price / limits.tickSize;
+            if (std::fabs(ticks - std::round(ticks)) > 1e-6) return RISK_TICK_SIZE;
+        }
+        if (limits.maxQuantity > 0 && quantity > limits.maxQuantity) {
+            return RISK_MAX_QUANTITY;
+        }
+        double notional = price * quantity;
+        if (limits.maxNotional > 0 && notional > limits.maxNotional) {
+            return RISK_MAX_NOTIONAL;
+        }
+
+        ClientState state;
+        std::unordered_map<int, ClientState>::const_iterator client = clients.find(clientId);
+        if (client != clients.end()) state = client->second;
+
+        if (clientLimits.maxOpenOrders > 0 && state.openOrders >= clientLimits.maxOpenOrders) {
+            return RISK_OPEN_ORDERS;
+        }
+
+        // Brüt: pozisyonlar ve açık emirler toplamı. Net: aynı yöndeki tüm açık
+        // emirler gerçekleşirse oluşacak uzun veya kısa pozisyon.
+        double longCost, shortCost;
+        ledger.exposure(clientId, longCost, shortCost);
+        double gross = longCost + shortCost + state.openBuyNotional + state.openSellNotional + notional;
+        if (clientLimits.maxGrossExposure > 0 && gross > clientLimits.maxGrossExposure) {
+            return RISK_GROSS_EXPOSURE;
+        }
+        double net = buy ? longCost - shortCost + state.openBuyNotional + notional
+                         : shortCost - longCost + state.openSellNotional + notional;
+        if (clientLimits.maxNetExposure > 0 && net > clientLimits.maxNetExposure) {
+            return RISK_NET_EXPOSURE;
+        }
+        return RISK_OK;
+    }
+
+    void orderOpened(int clientId, bool buy, double notional) {
+        ClientState& state = clients[clientId];
+        state.openOrders++;
+        if (buy) state.openBuyNotional += notional;
+        else state.openSellNotional += notional;
+    }
+
+    void orderReduced(int clientId, bool buy, double notional, bool closed) {
+        std::unordered_map<int, ClientState>::iterator it = clients.find(clientId);
+        if (it == clients.end()) return;
+
+        ClientState& state = it->second;
+        if (buy) state.openBuyNotional -= notional;
+        else state.openSellNotional -= notional;
+        if (closed && --state.openOrders <= 0) {
+            clients.erase(it);
+        }
+    }
+
+    void clearOpenOrders() {
+        clients.clear();
+    }
+
+    std::string status() const {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2)
+            << "Client limitleri: brüt " << clientLimits.maxGrossExposure << " TL, net "
+            << clientLimits.maxNetExposure << " TL, açık emir " << clientLimits.maxOpenOrders << "\n"
+            << "Varsayılan emir limitleri: adet " << defaultSymbol.maxQuantity << ", tutar "
+            << defaultSymbol.maxNotional << " TL\n";
+
+        std::vector<std::string> names;
+        for (std::unordered_map<std::string, SymbolRiskLimits>::const_iterator it = symbols.begin();
+             it != symbols.end(); ++it) {
+            names.push_back(it->first);
+        }
+        std::sort(names.begin(), names.end());
+        for (size_t i = 0; i < names.size(); i++) {
+            const SymbolRiskLimits& limits = symbols.find(names[i])->second;
+            out << "  " << std::left << std::setw(8) << names[i] << std::right
+                << " tick " << limits.tickSize << ", bant " << limits.minPrice << "-" << limits.maxPrice
+                << ", adet " << limits.maxQuantity << ", tutar " << limits.maxNotional << "\n";
+        }
+
+        out << "Kontrol: " << checks << ", red:";
+        long long total = 0;
+        for (int i = 1; i < RISK_RESULT_COUNT; i++) {
+            if (rejects[i] == 0) continue;
+            out << " " << riskRejectText(i) << "=" << rejects[i];
+            total += rejects[i];
+        }
+        if (total == 0) out << " yok";
+        out << "\n";
+        return out.str();
+    }
+};
+
+#endif
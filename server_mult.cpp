@@ -2,6 +2,7 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
 #include <unistd.h>
 #include <cstring>
 #include <errno.h>
@@ -15,8 +16,32 @@
 #include <algorithm>
 #include <map>
 #include <deque> 
+#include <set>
+#include <unordered_map>
+#include <atomic>
+#include <poll.h>
+#include <sys/stat.h>
 #include "config_reader.h"
 #include "json_parser.h"
+#include "trade_store.h"
+#include "book_snapshot.h"
+#include "market_data.h"
+#include "md_ring.h"
+#include "gateway_protocol.h"
+#include "replication.h"
+#include "simulator.h"
+#include "auction.h"
+#include "timing_wheel.h"
+#include "position_ledger.h"
+#include "risk_engine.h"
+#include "rcu_pointer.h"
+#include "line_reader.h"
+#include "session_registry.h"
+#include "order_trace.h"
+#include "lock_profiler.h"
+#include "flight_recorder.h"
+#include "admin_channel.h"
+#include "throttle.h"
 
 using namespace std;
 
@@ -36,12 +61,27 @@ struct Order {
     int remainingQuantity;
     string status;
     string timestamp;
+    double triggerPrice = 0;   // > 0 ise stop emri
+    bool stopMarket = false;   // tetiklenince piyasa emri gibi davranır, kalan iptal edilir
+    string timeInForce = "GTC"; // GTC, DAY, GTD, IOC, FOK
+    int64_t expiresAt = 0;     // DAY/GTD için epoch saniye
+    string reference;          // client emir referansı; replikasyonla yedeğin oturumuna işlenir
 };
 
 
 struct OrderBook {
     deque<Order> buyOrders;
     deque<Order> sellOrders;
+    int snapshotSlot = -1;
+    uint64_t snapshotVersion = 0;
+    BookSnapshot lastSnapshot = BookSnapshot();
+    bool inAuction = false;
+    // Tetiklenmemiş stoplar: alışlar artan, satışlar azalan tetik fiyatına göre;
+    // eşit tetikte geliş sırası korunur. Her an alış tetikleri lastPrice'ın
+    // üstünde, satış tetikleri altındadır, bu yüzden yalnızca baştan bakılır.
+    multimap<double, Order> buyStops;
+    multimap<double, Order, greater<double> > sellStops;
+    double lastPrice = 0;
 };
 
 
@@ -59,20 +99,44 @@ struct Trade {
 
 
 map<string, OrderBook> orderBooks;
-pthread_mutex_t orderBookMutex = PTHREAD_MUTEX_INITIALIZER;
+ProfiledMutex orderBookMutex("orderBookMutex");
+SnapshotRegistry bookSnapshots;
+TimingWheel expiryWheel;   // orderBookMutex altında
+string defaultTimeInForce = "DAY";
+string sessionEnd = "18:00";
 int orderIdCounter = 1;
-pthread_mutex_t orderIdMutex = PTHREAD_MUTEX_INITIALIZER;
+ProfiledMutex orderIdMutex("orderIdMutex");
+int tradeIdCounter = 1;
 
-vector<Trade> trades;
-pthread_mutex_t tradeMutex = PTHREAD_MUTEX_INITIALIZER;
+TradeStore tradeStore;
+ProfiledMutex tradeMutex("tradeMutex");
+PositionLedger positions;   // orderBookMutex altında
+RiskEngine riskEngine(positions);   // orderBookMutex altında
 
 map<int, int> clientSockets;
-pthread_mutex_t clientSocketMutex = PTHREAD_MUTEX_INITIALIZER;
+SessionRegistry sessions;   // clientSocketMutex altında
+int sessionResumeGrace = 30;
+ProfiledMutex clientSocketMutex("clientSocketMutex");
 
-pthread_mutex_t clientCountMutex = PTHREAD_MUTEX_INITIALIZER;
+ProfiledMutex clientCountMutex("clientCountMutex");
 int activeClients = 0;
+int nextClientId = 1;
 bool serverRunning = true;
 int globalServerSocket;
+bool acceptLoopRunning = false;
+
+// Boşaltma başlayınca yeni emir ve bağlantı alınmaz; işlenmekte olan emirler beklenir.
+atomic<bool> draining(false);
+atomic<int> ordersInFlight(0);
+int drainTimeoutMs = 5000;
+
+// Yönetim kanalının kilit almadan okuduğu sayaçlar.
+int64_t serverStartNs = 0;
+atomic<long long> acceptedOrders(0);
+atomic<long long> rejectedOrders(0);
+atomic<long long> executedTrades(0);
+atomic<long long> tradedQuantity(0);
+atomic<long> openOrderCount(0);
 
 string getTimestamp() {
     time_t now = time(0);
@@ -82,38 +146,306 @@ string getTimestamp() {
     return string(buffer);
 }
 
+int64_t getNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
 string generateOrderId() {
-    pthread_mutex_lock(&orderIdMutex);
+    MUTEX_LOCK(orderIdMutex);
     int id = orderIdCounter++;
-    pthread_mutex_unlock(&orderIdMutex);
+    MUTEX_UNLOCK(orderIdMutex);
     
     stringstream ss;
     ss << "ORD" << setfill('0') << setw(6) << id;
     return ss.str();
 }
 
+// orderBookMutex altında çağrılır; yedek sunucu sayacı senkronizasyonla devralır.
 string generateTradeId() {
-    static int tradeCounter = 1;
     stringstream ss;
-    ss << "TRD" << setfill('0') << setw(6) << tradeCounter++;
+    ss << "TRD" << setfill('0') << setw(6) << tradeIdCounter++;
     return ss.str();
 }
 
+const int SOCKET_LOCK_STRIPES = 64;
+pthread_mutex_t socketWriteMutex[SOCKET_LOCK_STRIPES];
+
+pthread_mutex_t* socketWriteLock(int clientSocket) {
+    return &socketWriteMutex[clientSocket % SOCKET_LOCK_STRIPES];
+}
+
+MarketDataHub marketData(bookSnapshots, socketWriteLock);
+MdRingWriter mdRing;
+OrderTracer orderTracer;
+FlightRecorder flightRecorder;
+
+// Replikasyon: rol none | primary | standby. Yedek tarafındaki durum orderBookMutex altındadır.
+string replicationRole = "none";
+ReplicationPrimary replication;
+uint64_t lastReplicationSeq = 0;
+uint64_t standbyAppliedSeq = 0;
+LatencyStats standbyLag;
+deque<string> standbyLocalFills;
+long long standbyFillChecks = 0;
+long long standbyFillMismatches = 0;
+int64_t failoverDetectedNs = 0;
+string failoverReport;
+
 void sendToClient(int clientSocket, const string& message) {
     string msg = message + "\n";
-    send(clientSocket, msg.c_str(), msg.length(), 0);
+    pthread_mutex_t* lock = socketWriteLock(clientSocket);
+    pthread_mutex_lock(lock);
+    send(clientSocket, msg.c_str(), msg.length(), MSG_NOSIGNAL);
+    pthread_mutex_unlock(lock);
 }
 
-vector<Stock> stocks;
-map<string, pair<double, double> > stockPriceLimits;
+struct GatewayRoute {
+    int gateway;
+    int sessionId;
+};
 
-void initStockPriceLimitsFromJson(const string& filename) {
-    StockConfigParser parser;
-    stocks = parser.loadStocks(filename);
+struct GatewayLink {
+    int index;
+    GatewayQueue inbound;
+    GatewayQueue outbound;
+    pthread_mutex_t outboundMutex;
+    map<int, int> sessionClients;
+    map<int, ClientThrottle*> sessionThrottles;     // gateway poller thread'ine ait
+    long long dropped;
+    // Kuyruk dolduğu için kapatılan oturumlar (outboundMutex altında); değer
+    // GW_SESSION_CLOSE'un kuyruğa girip girmediğidir. Kapanış gateway'den dönünce silinir.
+    map<int, bool> overflowed;
+    atomic<int> closesPending;
+};
+
+vector<GatewayLink*> gatewayLinks;
+map<int, GatewayRoute> gatewayRoutes;
+
+const int GATEWAY_SEND_WAIT_US = 20000;
+
+// outboundMutex tutularak çağrılır. Kuyruk doluysa gateway'in boşaltması kısa bir süre
+// beklenir; kilit bırakılmaz ki aynı oturuma giden mesajların sırası bozulmasın.
+bool pushToGateway(GatewayLink* link, const GatewayMessage& out) {
+    for (int waited = 0; !link->outbound.push(out); waited += 50) {
+        if (waited >= GATEWAY_SEND_WAIT_US) return false;
+        usleep(50);
+    }
+    return true;
+}
+
+// Gateway yetişemezse mesaj sessizce düşürülmez: oturum kapatılır ve client akışın
+// koptuğunu bağlantının kapanmasından anlar. Kapanışa kadarki mesajlar gönderilmez.
+void sendToGateway(const GatewayRoute& route, const string& message) {
+    GatewayLink* link = gatewayLinks[route.gateway];
+    
+    GatewayMessage out;
+    memset(&out, 0, sizeof(out));
+    out.type = GW_TEXT;
+    out.sessionId = route.sessionId;
+    setGatewayText(out, message);
+    
+    pthread_mutex_lock(&link->outboundMutex);
+    bool overflow = false;
+    if (link->overflowed.count(route.sessionId) > 0) {
+        link->dropped++;
+    } else if (!pushToGateway(link, out)) {
+        link->dropped++;
+        link->overflowed[route.sessionId] = false;
+        link->closesPending++;
+        overflow = true;
+    }
+    pthread_mutex_unlock(&link->outboundMutex);
+    
+    if (overflow) {
+        cerr << "[" << getTimestamp() << "] Gateway #" << route.gateway << " kuyruğu dolu, oturum #" 
+             << route.sessionId << " kapatılıyor" << endl;
+    }
+}
+
+void closeGatewaySession(const GatewayRoute& route) {
+    GatewayLink* link = gatewayLinks[route.gateway];
+    
+    GatewayMessage out;
+    memset(&out, 0, sizeof(out));
+    out.type = GW_SESSION_CLOSE;
+    out.sessionId = route.sessionId;
+    
+    pthread_mutex_lock(&link->outboundMutex);
+    map<int, bool>::iterator pending = link->overflowed.find(route.sessionId);
+    if (pending == link->overflowed.end()) {
+        if (!pushToGateway(link, out)) {
+            link->overflowed[route.sessionId] = false;
+            link->closesPending++;
+        }
+    }
+    pthread_mutex_unlock(&link->outboundMutex);
+}
+
+// Poller thread'inden çağrılır; kuyrukta yer açıldıkça bekleyen kapanışları gönderir.
+void flushGatewayCloses(GatewayLink* link) {
+    if (link->closesPending.load() == 0) return;
+    
+    pthread_mutex_lock(&link->outboundMutex);
+    for (map<int, bool>::iterator it = link->overflowed.begin(); it != link->overflowed.end(); ++it) {
+        if (it->second) continue;
+        GatewayMessage out;
+        memset(&out, 0, sizeof(out));
+        out.type = GW_SESSION_CLOSE;
+        out.sessionId = it->first;
+        if (!link->outbound.push(out)) break;
+        it->second = true;
+        link->closesPending--;
+    }
+    pthread_mutex_unlock(&link->outboundMutex);
+}
+
+void notifyClient(int clientId, const string& message) {
+    if (clientId < 0) return; // simülasyon ajanları
+    
+    MUTEX_LOCK(clientSocketMutex);
+    
+    // Oturumlu client'lara giden mesajlar bağlantı yokken de numaralanıp saklanır.
+    ClientSession* session = sessions.find(clientId);
+    if (session != NULL) {
+        string line = sessions.sequence(*session, message);
+        if (session->socket >= 0) {
+            sendToClient(session->socket, line);
+        }
+        MUTEX_UNLOCK(clientSocketMutex);
+        return;
+    }
+    
+    map<int, int>::iterator it = clientSockets.find(clientId);
+    if (it != clientSockets.end()) {
+        sendToClient(it->second, message);
+    } else {
+        map<int, GatewayRoute>::iterator route = gatewayRoutes.find(clientId);
+        if (route != gatewayRoutes.end()) {
+            sendToGateway(route->second, message);
+        }
+    }
+    
+    MUTEX_UNLOCK(clientSocketMutex);
+}
+
+int allocateClientId() {
+    MUTEX_LOCK(clientCountMutex);
+    int id = nextClientId++;
+    MUTEX_UNLOCK(clientCountMutex);
+    return id;
+}
+
+// Hisse tanımları ve fiyat bantları; yüklendikten sonra değişmez. "yenile" yeni bir
+// tablo kurup RCU ile değiştirir, emir yolundaki okuyucular kilit almaz.
+struct StockTable {
+    vector<Stock> stocks;
+    map<string, pair<double, double> > priceLimits;   // sembol -> (max, min)
+};
+
+RcuPointer<StockTable> stockTable;
+string stocksConfigFile = "stocks_config.json";
+ThrottleRegistry throttles;
+
+// [risk] varsayılanları, [risk.SEMBOL] sembol bazında geçersiz kılar; tick ve fiyat
+// bandı hisse tanımlarından gelir. Limit 0 ise ilgili kontrol yapılmaz.
+void loadRiskLimits(const string& filename) {
+    ConfigReader config;
+    config.load(filename);
+    
+    SymbolRiskLimits fallback;
+    fallback.tickSize = 0;
+    fallback.minPrice = 0;
+    fallback.maxPrice = 0;
+    fallback.maxQuantity = atoll(config.get("risk", "max_order_quantity", "0").c_str());
+    fallback.maxNotional = atof(config.get("risk", "max_order_notional", "0").c_str());
+    
+    ClientRiskLimits clientLimits;
+    clientLimits.maxGrossExposure = atof(config.get("risk", "max_gross_exposure", "0").c_str());
+    clientLimits.maxNetExposure = atof(config.get("risk", "max_net_exposure", "0").c_str());
+    clientLimits.maxOpenOrders = config.getInt("risk", "max_open_orders", 0);
+    
+    unordered_map<string, SymbolRiskLimits> perSymbol;
+    RcuReadGuard<StockTable> table(stockTable);
+    for (const Stock& stock : table->stocks) {
+        string section = "risk." + stock.symbol;
+        SymbolRiskLimits limits = fallback;
+        limits.tickSize = stock.tick_size;
+        limits.minPrice = stock.min;
+        limits.maxPrice = stock.max;
+        limits.maxQuantity = atoll(config.get(section, "max_order_quantity", to_string(fallback.maxQuantity)).c_str());
+        limits.maxNotional = atof(config.get(section, "max_order_notional", to_string(fallback.maxNotional)).c_str());
+        perSymbol[stock.symbol] = limits;
+    }
+    
+    MUTEX_LOCK(orderBookMutex);
+    riskEngine.configure(fallback, clientLimits, perSymbol);
+    MUTEX_UNLOCK(orderBookMutex);
+}
+
+ThrottleLimits readThrottleLimits(ConfigReader& config, const string& section, const ThrottleLimits& fallback) {
+    ThrottleLimits limits;
+    limits.ordersPerSecond = atof(config.get(section, "orders_per_sec", to_string(fallback.ordersPerSecond)).c_str());
+    limits.orderBurst = atof(config.get(section, "order_burst", to_string(fallback.orderBurst)).c_str());
+    limits.messagesPerSecond = atof(config.get(section, "messages_per_sec", to_string(fallback.messagesPerSecond)).c_str());
+    limits.messageBurst = atof(config.get(section, "message_burst", to_string(fallback.messageBurst)).c_str());
+    limits.delay = config.get(section, "policy", fallback.delay ? "beklet" : "reddet") == "beklet";
+    limits.maxDelayMs = config.getInt(section, "max_delay_ms", fallback.maxDelayMs);
+    limits.disconnectAfter = config.getInt(section, "disconnect_after", fallback.disconnectAfter);
+    return limits;
+}
+
+// [throttle] varsayılan sınıftır; "classes" listesindeki her sınıf [throttle.SINIF]
+// bölümünde varsayılanı ezer ve "clients" ile client numaralarına atanır.
+void loadThrottleLimits(const string& filename) {
+    ConfigReader config;
+    config.load(filename);
+    
+    ThrottleLimits unlimited = { 0, 1, 0, 1, false, 0, 0 };
+    map<string, ThrottleLimits> classes;
+    ThrottleLimits fallback = readThrottleLimits(config, "throttle", unlimited);
+    classes[ThrottleRegistry::defaultClass()] = fallback;
+    
+    map<int, string> clientClasses;
+    stringstream names(config.get("throttle", "classes", ""));
+    string name;
+    while (getline(names, name, ',')) {
+        if (name.empty()) continue;
+        string section = "throttle." + name;
+        classes[name] = readThrottleLimits(config, section, fallback);
+        
+        stringstream ids(config.get(section, "clients", ""));
+        string id;
+        while (getline(ids, id, ',')) {
+            if (!id.empty()) clientClasses[atoi(id.c_str())] = name;
+        }
+    }
+    throttles.configure(classes, clientClasses, config.get("throttle", "gateway_class", ""));
+}
 
-    for (const Stock& stock : stocks) {
-        stockPriceLimits[stock.symbol] = make_pair(stock.max, stock.min);
+bool isOrderMessage(const string& msg) {
+    return msg.compare(0, 5, "EMIR|") == 0 || msg.compare(0, 6, "IPTAL|") == 0
+        || msg.compare(0, 5, "STOP|") == 0 || msg.compare(0, 10, "STOPLIMIT|") == 0;
+}
+
+// Hız limitine takılan mesajın yanıtı; client emir referansıyla eşleştirebilsin diye korunur.
+string throttleReply(const string& msg) {
+    if (msg.compare(0, 5, "EMIR|") == 0) {
+        size_t bar = 0;
+        for (int i = 0; i < 6 && bar != string::npos; i++) {
+            bar = msg.find('|', bar + 1);
+        }
+        string ref = bar == string::npos ? "" : msg.substr(bar + 1);
+        return "EMIR REDDEDILDI|Hiz limiti asildi" + (ref.empty() ? "" : "|" + ref);
+    }
+    if (msg.compare(0, 6, "IPTAL|") == 0) {
+        return "IPTAL_RED|" + msg.substr(6) + "|Hiz limiti asildi";
     }
+    if (isOrderMessage(msg)) {
+        return "EMIR REDDEDILDI|Hiz limiti asildi";
+    }
+    return "HIZ_LIMITI|" + msg.substr(0, msg.find('|'));
 }
 
 string getDateStamp() {
@@ -124,37 +456,326 @@ string getDateStamp() {
     return string(buffer);
 }
 
+// Bekleyen (kitaptaki veya tetiklenmemiş stop) emirlerin numara ve müşteri
+// bazlı indeksi; orderBookMutex altında. Müşteri sorguları ve toplu iptal
+// kitapları taramadan buradan çalışır.
+map<string, Order> openOrders;
+map<int, set<string> > clientOpenOrders;
+
+void indexOrder(const Order& order) {
+    openOrders[order.orderId] = order;
+    openOrderCount.store(openOrders.size(), memory_order_relaxed);
+    clientOpenOrders[order.clientId].insert(order.orderId);
+    if (order.clientId > 0) {
+        riskEngine.orderOpened(order.clientId, order.type == "AL", order.price * order.remainingQuantity);
+    }
+}
+
+void unindexOrder(const string& orderId) {
+    map<string, Order>::iterator it = openOrders.find(orderId);
+    if (it == openOrders.end()) return;
+    
+    const Order& order = it->second;
+    if (order.clientId > 0) {
+        riskEngine.orderReduced(order.clientId, order.type == "AL", order.price * order.remainingQuantity, true);
+    }
+    
+    map<int, set<string> >::iterator client = clientOpenOrders.find(order.clientId);
+    if (client != clientOpenOrders.end()) {
+        client->second.erase(orderId);
+        if (client->second.empty()) clientOpenOrders.erase(client);
+    }
+    openOrders.erase(it);
+    openOrderCount.store(openOrders.size(), memory_order_relaxed);
+}
+
+// Eşleşmede kalan miktarı indekse yansıtır; tamamen dolan emir indeksten çıkar.
+void updateIndexedQuantity(const Order& order) {
+    map<string, Order>::iterator it = openOrders.find(order.orderId);
+    if (it == openOrders.end()) return;
+    
+    if (order.remainingQuantity <= 0) {
+        unindexOrder(order.orderId);
+    } else {
+        Order& indexed = it->second;
+        if (indexed.clientId > 0) {
+            riskEngine.orderReduced(indexed.clientId, indexed.type == "AL",
+                                    indexed.price * (indexed.remainingQuantity - order.remainingQuantity), false);
+        }
+        indexed.remainingQuantity = order.remainingQuantity;
+    }
+}
+
+void insertOrder(OrderBook& book, const Order& order) {
+    indexOrder(order);
+    if (order.type == "AL") {
+        deque<Order>::iterator it = book.buyOrders.begin();
+        while (it != book.buyOrders.end() && it->price >= order.price) {
+            ++it;
+        }
+        book.buyOrders.insert(it, order);
+    } else {
+        deque<Order>::iterator it = book.sellOrders.begin();
+        while (it != book.sellOrders.end() && it->price <= order.price) {
+            ++it;
+        }
+        book.sellOrders.insert(it, order);
+    }
+}
+
+void insertStop(OrderBook& book, const Order& order) {
+    indexOrder(order);
+    if (order.type == "AL") {
+        book.buyStops.insert(make_pair(order.triggerPrice, order));
+    } else {
+        book.sellStops.insert(make_pair(order.triggerPrice, order));
+    }
+}
+
+// orderBookMutex altında. Stoplar da süreye tabidir; tetiklenip kitaba giren emir
+// aynı numarayla kaldığından süresi dolunca removeOrders ikisini de bulur.
+void scheduleExpiry(const Order& order) {
+    if (order.expiresAt > 0) {
+        TimerEntry entry = { order.expiresAt, order.stockSymbol, order.orderId };
+        expiryWheel.add(entry);
+    }
+}
+
+int collectLevels(const deque<Order>& orders, BookLevel* levels) {
+    int count = 0;
+    for (deque<Order>::const_iterator it = orders.begin(); it != orders.end(); ++it) {
+        if (count > 0 && levels[count - 1].price == it->price) {
+            levels[count - 1].quantity += it->remainingQuantity;
+            levels[count - 1].orderCount++;
+            continue;
+        }
+        if (count == BOOK_SNAPSHOT_DEPTH) break;
+        levels[count].price = it->price;
+        levels[count].quantity = it->remainingQuantity;
+        levels[count].orderCount = 1;
+        count++;
+    }
+    return count;
+}
+
+// orderBookMutex çağıran tarafından tutulmalıdır.
+void publishBookSnapshot(const string& symbol) {
+    OrderBook& book = orderBooks[symbol];
+    if (book.snapshotSlot < 0) {
+        book.snapshotSlot = bookSnapshots.slotFor(symbol);
+    }
+    
+    BookSnapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    strncpy(snapshot.symbol, symbol.c_str(), sizeof(snapshot.symbol) - 1);
+    snapshot.bidCount = collectLevels(book.buyOrders, snapshot.bids);
+    snapshot.askCount = collectLevels(book.sellOrders, snapshot.asks);
+    
+    if (book.snapshotVersion > 0 && sameLevels(snapshot, book.lastSnapshot)) {
+        return;
+    }
+    
+    snapshot.version = ++book.snapshotVersion;
+    snapshot.timestampNs = getNanos();
+    bookSnapshots.publish(book.snapshotSlot, snapshot);
+    
+    if (mdRing.isOpen()) {
+        MdRecord record;
+        memset(&record, 0, sizeof(record));
+        record.type = MD_TOP_OF_BOOK;
+        memcpy(record.symbol, snapshot.symbol, sizeof(record.symbol));
+        record.timestampNs = snapshot.timestampNs;
+        if (snapshot.bidCount > 0) {
+            record.bidPrice = snapshot.bids[0].price;
+            record.bidQuantity = snapshot.bids[0].quantity;
+        }
+        if (snapshot.askCount > 0) {
+            record.askPrice = snapshot.asks[0].price;
+            record.askQuantity = snapshot.asks[0].quantity;
+        }
+        
+        const BookSnapshot& previous = book.lastSnapshot;
+        bool topChanged = snapshot.bidCount == 0 ? previous.bidCount != 0 
+            : (previous.bidCount == 0 || previous.bids[0].price != record.bidPrice 
+               || previous.bids[0].quantity != record.bidQuantity);
+        topChanged = topChanged || (snapshot.askCount == 0 ? previous.askCount != 0 
+            : (previous.askCount == 0 || previous.asks[0].price != record.askPrice 
+               || previous.asks[0].quantity != record.askQuantity));
+        if (topChanged) {
+            mdRing.publish(record);
+        }
+    }
+    
+    if (marketData.hasSubscribers()) {
+        marketData.publish(symbol, snapshot.version, formatLevelDelta(book.lastSnapshot, snapshot));
+    }
+    book.lastSnapshot = snapshot;
+}
+
+// "HH:MM[:SS]" bugünün, "YYYY-MM-DDTHH:MM" verilen günün yerel saatidir.
+int64_t parseLocalTime(const string& text, bool rollToTomorrow) {
+    time_t now = time(0);
+    struct tm t = *localtime(&now);
+    int year, month, day, hour, minute, second = 0;
+    
+    if (sscanf(text.c_str(), "%d-%d-%dT%d:%d", &year, &month, &day, &hour, &minute) == 5) {
+        t.tm_year = year - 1900;
+        t.tm_mon = month - 1;
+        t.tm_mday = day;
+    } else if (sscanf(text.c_str(), "%d:%d:%d", &hour, &minute, &second) < 2) {
+        return 0;
+    }
+    t.tm_hour = hour;
+    t.tm_min = minute;
+    t.tm_sec = second;
+    t.tm_isdst = -1;
+    
+    time_t result = mktime(&t);
+    if (rollToTomorrow && result <= now) {
+        t.tm_mday++;
+        result = mktime(&t);
+    }
+    return result;
+}
+
+// Boş alan config'deki varsayılanı kullanır. GTD:HH:MM[:SS] veya GTD:YYYY-MM-DDTHH:MM.
+bool applyTimeInForce(Order& order, const string& field) {
+    string tif = field.empty() ? defaultTimeInForce : field;
+    order.expiresAt = 0;
+    
+    if (tif == "GTC" || tif == "IOC" || tif == "FOK") {
+        order.timeInForce = tif;
+        return true;
+    }
+    if (tif == "DAY") {
+        order.timeInForce = tif;
+        order.expiresAt = parseLocalTime(sessionEnd, true);
+        return order.expiresAt > 0;
+    }
+    if (tif.compare(0, 4, "GTD:") == 0) {
+        order.timeInForce = "GTD";
+        order.expiresAt = parseLocalTime(tif.substr(4), false);
+        return order.expiresAt > time(0);
+    }
+    return false;
+}
+
+string formatOrderRecord(const Order& order) {
+    stringstream ss;
+    ss << setprecision(15)
+       << (order.type == "AL" ? "BUY" : "SELL") << "|" << order.orderId << "|"
+       << order.clientId << "|" << order.stockSymbol << "|" << order.price << "|"
+       << order.quantity << "|" << order.remainingQuantity << "|"
+       << order.status << "|" << order.timestamp;
+    ss << "|" << order.triggerPrice << "|" << (order.stopMarket ? 1 : 0)
+       << "|" << order.timeInForce << "|" << order.expiresAt;
+    return ss.str();
+}
+
+bool parseOrderRecord(const string& line, Order& order) {
+    stringstream ss(line);
+    string type, orderId, clientIdStr, symbol, priceStr, quantityStr, 
+           remainingStr, status, timestamp;
+    
+    getline(ss, type, '|');
+    getline(ss, orderId, '|');
+    getline(ss, clientIdStr, '|');
+    getline(ss, symbol, '|');
+    getline(ss, priceStr, '|');
+    getline(ss, quantityStr, '|');
+    getline(ss, remainingStr, '|');
+    getline(ss, status, '|');
+    getline(ss, timestamp, '|');
+    if (symbol.empty()) return false;
+    
+    // Eski kayıtlarda bu alanlar yoktur; timeInForce boş kalır.
+    string triggerStr, marketStr, tifStr, expiresStr;
+    getline(ss, triggerStr, '|');
+    getline(ss, marketStr, '|');
+    getline(ss, tifStr, '|');
+    getline(ss, expiresStr, '|');
+    order.triggerPrice = atof(triggerStr.c_str());
+    order.stopMarket = marketStr == "1";
+    order.timeInForce = tifStr;
+    order.expiresAt = atoll(expiresStr.c_str());
+    
+    order.orderId = orderId;
+    order.clientId = atoi(clientIdStr.c_str());
+    order.clientSocket = -1;
+    order.stockSymbol = symbol;
+    order.type = (type == "BUY") ? "AL" : "SAT";
+    order.price = atof(priceStr.c_str());
+    order.quantity = atoi(quantityStr.c_str());
+    order.remainingQuantity = atoi(remainingStr.c_str());
+    order.status = status;
+    order.timestamp = timestamp;
+    return true;
+}
+
 void saveOrderBook() {
-    pthread_mutex_lock(&orderBookMutex);
+    MUTEX_LOCK(orderBookMutex);
     
     ofstream file("pending_orders.dat");
     if (!file.is_open()) {
-        pthread_mutex_unlock(&orderBookMutex);
+        MUTEX_UNLOCK(orderBookMutex);
         return;
     }
     
     for (map<string, OrderBook>::const_iterator it = orderBooks.begin(); 
          it != orderBooks.end(); ++it) {
-        const string& symbol = it->first;
         const OrderBook& book = it->second;
       
         for (deque<Order>::const_iterator buyIt = book.buyOrders.begin(); buyIt != book.buyOrders.end(); ++buyIt) {
-            file << "BUY|" << buyIt->orderId << "|" << buyIt->clientId << "|"
-                 << buyIt->stockSymbol << "|" << buyIt->price << "|" 
-                 << buyIt->quantity << "|" << buyIt->remainingQuantity << "|"
-                 << buyIt->status << "|" << buyIt->timestamp << endl;
+            file << formatOrderRecord(*buyIt) << endl;
         }
         
         for (deque<Order>::const_iterator sellIt = book.sellOrders.begin(); sellIt != book.sellOrders.end(); ++sellIt) {
-            file << "SELL|" << sellIt->orderId << "|" << sellIt->clientId << "|"
-                 << sellIt->stockSymbol << "|" << sellIt->price << "|" 
-                 << sellIt->quantity << "|" << sellIt->remainingQuantity << "|"
-                 << sellIt->status << "|" << sellIt->timestamp << endl;
+            file << formatOrderRecord(*sellIt) << endl;
+        }
+        
+        for (multimap<double, Order>::const_iterator stopIt = book.buyStops.begin(); stopIt != book.buyStops.end(); ++stopIt) {
+            file << "STOP|" << formatOrderRecord(stopIt->second) << endl;
         }
+        
+        for (multimap<double, Order, greater<double> >::const_iterator stopIt = book.sellStops.begin(); 
+             stopIt != book.sellStops.end(); ++stopIt) {
+            file << "STOP|" << formatOrderRecord(stopIt->second) << endl;
+        }
+    }
+    
+    // Oturumlar ve işlenmiş referansları: yeniden başlayınca client aynı oturumu sürdürür
+    // ve yanıtını almadığı emri yeniden gönderdiğinde emir ikinci kez işlenmez.
+    MUTEX_LOCK(clientSocketMutex);
+    vector<string> sessionRecords = sessions.records();
+    MUTEX_UNLOCK(clientSocketMutex);
+    for (size_t i = 0; i < sessionRecords.size(); i++) {
+        file << "SESSION|" << sessionRecords[i] << endl;
     }
     
     file.close();
-    pthread_mutex_unlock(&orderBookMutex);
+    
+    // Pozisyonlar, sayaçlar ve son fiyatlar kitapla aynı kilit altında yazılır. Client
+    // numarası da saklanır; aksi halde yeniden başlatmada eski pozisyonlar yeni bağlanan
+    // aynı numaralı client'a görünürdü.
+    ofstream ledgerFile("positions.dat");
+    if (ledgerFile.is_open()) {
+        MUTEX_LOCK(clientCountMutex);
+        int clientIdNext = nextClientId;
+        MUTEX_UNLOCK(clientCountMutex);
+        ledgerFile << "SEQ|" << tradeIdCounter << "|" << clientIdNext << endl;
+        for (map<string, OrderBook>::const_iterator it = orderBooks.begin(); it != orderBooks.end(); ++it) {
+            if (it->second.lastPrice > 0) {
+                ledgerFile << setprecision(15) << "LAST|" << it->first << "|" << it->second.lastPrice << endl;
+            }
+        }
+        vector<string> records = positions.records();
+        for (size_t i = 0; i < records.size(); i++) {
+            ledgerFile << "POS|" << records[i] << endl;
+        }
+        ledgerFile.close();
+    }
+    
+    MUTEX_UNLOCK(orderBookMutex);
 }
 
 void loadOrderBook() {
@@ -164,83 +785,88 @@ void loadOrderBook() {
         return;
     }
     
-    pthread_mutex_lock(&orderBookMutex);
+    MUTEX_LOCK(orderBookMutex);
     
+    int maxOrderId = 0;
+    int expired = 0;
+    int64_t now = time(0);
     string line;
     while (getline(file, line)) {
-        stringstream ss(line);
-        string type, orderId, clientIdStr, symbol, priceStr, quantityStr, 
-               remainingStr, status, timestamp;
-        
-        getline(ss, type, '|');
-        getline(ss, orderId, '|');
-        getline(ss, clientIdStr, '|');
-        getline(ss, symbol, '|');
-        getline(ss, priceStr, '|');
-        getline(ss, quantityStr, '|');
-        getline(ss, remainingStr, '|');
-        getline(ss, status, '|');
-        getline(ss, timestamp, '|');
-        
+        if (line.compare(0, 8, "SESSION|") == 0) {
+            MUTEX_LOCK(clientSocketMutex);
+            sessions.restore(line.substr(8), now);
+            MUTEX_UNLOCK(clientSocketMutex);
+            continue;
+        }
         Order order;
-        order.orderId = orderId;
-        order.clientId = atoi(clientIdStr.c_str());
-        order.clientSocket = -1;
-        order.stockSymbol = symbol;
-        order.type = (type == "BUY") ? "AL" : "SAT";
-        order.price = atof(priceStr.c_str());
-        order.quantity = atoi(quantityStr.c_str());
-        order.remainingQuantity = atoi(remainingStr.c_str());
-        order.status = status;
-        order.timestamp = timestamp;
+        bool stop = line.compare(0, 5, "STOP|") == 0;
+        if (!parseOrderRecord(stop ? line.substr(5) : line, order)) continue;
         
-        OrderBook& book = orderBooks[symbol];
+        int id = atoi(order.orderId.substr(3).c_str());
+        if (id > maxOrderId) maxOrderId = id;
         
-        if (type == "BUY") {
-            deque<Order>::iterator it = book.buyOrders.begin();
-            while (it != book.buyOrders.end() && it->price > order.price) {
-                ++it;
-            }
-            book.buyOrders.insert(it, order);
+        if (order.timeInForce.empty()) {
+            applyTimeInForce(order, "");
+        }
+        if (order.expiresAt > 0 && order.expiresAt <= now) {
+            expired++;
+            continue;
+        }
+        
+        if (stop) {
+            insertStop(orderBooks[order.stockSymbol], order);
         } else {
-            deque<Order>::iterator it = book.sellOrders.begin();
-            while (it != book.sellOrders.end() && it->price < order.price) {
-                ++it;
-            }
-            book.sellOrders.insert(it, order);
+            insertOrder(orderBooks[order.stockSymbol], order);
         }
+        scheduleExpiry(order);
+    }
+    if (expired > 0) {
+        cout << expired << " süresi dolmuş emir yüklenmedi." << endl;
     }
     
     file.close();
-    pthread_mutex_unlock(&orderBookMutex);
+    for (map<string, OrderBook>::const_iterator it = orderBooks.begin(); 
+         it != orderBooks.end(); ++it) {
+        publishBookSnapshot(it->first);
+    }
+    MUTEX_UNLOCK(orderBookMutex);
     
     cout << "Bekleyen emirler yüklendi." << endl;
     
-    int maxOrderId = 0;
-    pthread_mutex_lock(&orderBookMutex);
-    for (map<string, OrderBook>::const_iterator it = orderBooks.begin(); 
-         it != orderBooks.end(); ++it) {
-        const OrderBook& book = it->second;
-        
-        for (deque<Order>::const_iterator buyIt = book.buyOrders.begin(); 
-             buyIt != book.buyOrders.end(); ++buyIt) {
-            string idStr = buyIt->orderId.substr(3);
-            int id = atoi(idStr.c_str());
-            if (id > maxOrderId) maxOrderId = id;
-        }
-        
-        for (deque<Order>::const_iterator sellIt = book.sellOrders.begin(); 
-             sellIt != book.sellOrders.end(); ++sellIt) {
-            string idStr = sellIt->orderId.substr(3);
-            int id = atoi(idStr.c_str());
-            if (id > maxOrderId) maxOrderId = id;
+    MUTEX_LOCK(orderIdMutex);
+    orderIdCounter = maxOrderId + 1;
+    MUTEX_UNLOCK(orderIdMutex);
+}
+
+void loadPositions() {
+    ifstream file("positions.dat");
+    if (!file.is_open()) return;
+    
+    MUTEX_LOCK(orderBookMutex);
+    int loaded = 0;
+    string line;
+    while (getline(file, line)) {
+        if (line.compare(0, 4, "SEQ|") == 0) {
+            tradeIdCounter = atoi(line.c_str() + 4);
+            size_t bar = line.find('|', 4);
+            if (bar != string::npos) {
+                MUTEX_LOCK(clientCountMutex);
+                nextClientId = atoi(line.c_str() + bar + 1);
+                MUTEX_UNLOCK(clientCountMutex);
+            }
+        } else if (line.compare(0, 5, "LAST|") == 0) {
+            size_t bar = line.find('|', 5);
+            if (bar != string::npos) {
+                orderBooks[line.substr(5, bar - 5)].lastPrice = atof(line.c_str() + bar + 1);
+            }
+        } else if (line.compare(0, 4, "POS|") == 0 && positions.restore(line.substr(4))) {
+            loaded++;
         }
     }
-    pthread_mutex_unlock(&orderBookMutex);
+    MUTEX_UNLOCK(orderBookMutex);
+    file.close();
     
-    pthread_mutex_lock(&orderIdMutex);
-    orderIdCounter = maxOrderId + 1;
-    pthread_mutex_unlock(&orderIdMutex);
+    cout << loaded << " pozisyon kaydı yüklendi." << endl;
 }
 
 void* autoSaveOrderBook(void* arg) {
@@ -256,673 +882,2373 @@ void* autoSaveOrderBook(void* arg) {
     return NULL;
 }
 
-void matchOrders(Order& newOrder) {
-    if (pthread_mutex_trylock(&orderBookMutex) != 0) {
-        return;
+void recordTrade(const Order& buyOrder, const Order& sellOrder, double tradePrice, int tradeQuantity) {
+    const string& symbol = buyOrder.stockSymbol;
+
+    Trade trade;
+    trade.tradeId = generateTradeId();
+    trade.buyOrderId = buyOrder.orderId;
+    trade.sellOrderId = sellOrder.orderId;
+    trade.buyerClientId = buyOrder.clientId;
+    trade.sellerClientId = sellOrder.clientId;
+    trade.stockSymbol = symbol;
+    trade.price = tradePrice;
+    trade.quantity = tradeQuantity;
+    trade.timestamp = getTimestamp();
+
+    flightRecorder.record(FLIGHT_FILL, buyOrder.clientId, symbol, "", tradePrice, tradeQuantity, 0,
+                          trade.tradeId, sellOrder.clientId);
+    executedTrades.fetch_add(1, memory_order_relaxed);
+    tradedQuantity.fetch_add(tradeQuantity, memory_order_relaxed);
+
+    MUTEX_LOCK(tradeMutex);
+    tradeStore.append(symbol, tradePrice, tradeQuantity,
+                      buyOrder.clientId, sellOrder.clientId, getNanos());
+    MUTEX_UNLOCK(tradeMutex);
+    orderBooks[symbol].lastPrice = tradePrice;
+    updateIndexedQuantity(buyOrder);
+    updateIndexedQuantity(sellOrder);
+    
+    // Simülasyon ajanlarının (negatif id) pozisyonu tutulmaz.
+    if (buyOrder.clientId > 0) positions.apply(buyOrder.clientId, symbol, true, tradePrice, tradeQuantity);
+    if (sellOrder.clientId > 0) positions.apply(sellOrder.clientId, symbol, false, tradePrice, tradeQuantity);
+
+    if (replicationRole != "none") {
+        stringstream fill;
+        fill << setprecision(15) << "FILL|" << trade.tradeId << "|" << trade.buyOrderId 
+             << "|" << trade.sellOrderId << "|" << tradePrice << "|" << tradeQuantity;
+        if (replicationRole == "primary") {
+            lastReplicationSeq = replication.publish(fill.str());
+        } else {
+            standbyLocalFills.push_back(fill.str());
+        }
+    }
+
+    if (mdRing.isOpen()) {
+        MdRecord record;
+        memset(&record, 0, sizeof(record));
+        record.type = MD_TRADE;
+        strncpy(record.symbol, symbol.c_str(), sizeof(record.symbol) - 1);
+        record.timestampNs = getNanos();
+        record.price = tradePrice;
+        record.quantity = tradeQuantity;
+        record.buyerClientId = buyOrder.clientId;
+        record.sellerClientId = sellOrder.clientId;
+        mdRing.publish(record);
     }
     
+    if (marketData.hasSubscribers()) {
+        uint64_t seq = orderBooks[symbol].snapshotVersion + 1;
+        marketData.publish(symbol, seq, formatLastTrade(seq, symbol, tradePrice, tradeQuantity));
+    }
+
+    stringstream buyMsg;
+    buyMsg << "TRADE|" << trade.tradeId << "|ALIM|" 
+          << symbol << "|" << fixed << setprecision(2) << tradePrice 
+          << "|" << tradeQuantity << "|" << buyOrder.orderId;
+    notifyClient(buyOrder.clientId, buyMsg.str());
+
+    stringstream sellMsg;
+    sellMsg << "TRADE|" << trade.tradeId << "|SATIM|" 
+           << symbol << "|" << fixed << setprecision(2) << tradePrice 
+           << "|" << tradeQuantity << "|" << sellOrder.orderId;
+    notifyClient(sellOrder.clientId, sellMsg.str());
+
+    // Yalnızca simülasyon ajanları arasındaki işlemler konsola ve trades.log'a yazılmaz.
+    if (buyOrder.clientId < 0 && sellOrder.clientId < 0) return;
+
+    cout << "[" << getTimestamp() << "] İŞLEM - " << symbol 
+         << " " << tradeQuantity << " adet @ " << fixed << setprecision(2) 
+         << tradePrice << " TL (Alıcı: Client#" << buyOrder.clientId 
+         << ", Satıcı: Client#" << sellOrder.clientId << ")" << endl;
+
+    TraceSpan span("trades.log");
+    ofstream tradeFile("trades.log", ios::app);
+    if (tradeFile.is_open()) {
+        tradeFile << getDateStamp() << " " << getTimestamp() 
+                 << "|" << trade.tradeId << "|" << symbol 
+                 << "|" << tradePrice << "|" << tradeQuantity
+                 << "|Client#" << buyOrder.clientId << "|Client#" << sellOrder.clientId << endl;
+        tradeFile.close();
+    }
+}
+
+// orderBookMutex çağıran tarafından tutulmalıdır.
+void matchOrders(Order& newOrder) {
     OrderBook& book = orderBooks[newOrder.stockSymbol];
     
     if (newOrder.type == "AL") {
         while (!book.sellOrders.empty() && newOrder.remainingQuantity > 0) {
             Order& sellOrder = book.sellOrders.front();
-            
-            if (newOrder.price >= sellOrder.price) {
-                int tradeQuantity = min(newOrder.remainingQuantity, sellOrder.remainingQuantity);
-                double tradePrice = sellOrder.price;
-                
-                Trade trade;
-                trade.tradeId = generateTradeId();
-                trade.buyOrderId = newOrder.orderId;
-                trade.sellOrderId = sellOrder.orderId;
-                trade.buyerClientId = newOrder.clientId;
-                trade.sellerClientId = sellOrder.clientId;
-                trade.stockSymbol = newOrder.stockSymbol;
-                trade.price = tradePrice;
-                trade.quantity = tradeQuantity;
-                trade.timestamp = getTimestamp();
-                
-                pthread_mutex_lock(&tradeMutex);
-                trades.push_back(trade);
-                pthread_mutex_unlock(&tradeMutex);
-                
-                newOrder.remainingQuantity -= tradeQuantity;
-                sellOrder.remainingQuantity -= tradeQuantity;
-                
-                pthread_mutex_lock(&clientSocketMutex);
-                
-                if (clientSockets.find(newOrder.clientId) != clientSockets.end()) {
-                    stringstream buyMsg;
-                    buyMsg << "TRADE|" << trade.tradeId << "|ALIM|" 
-                          << newOrder.stockSymbol << "|" << fixed << setprecision(2) << tradePrice 
-                          << "|" << tradeQuantity << "|" << newOrder.orderId;
-                    sendToClient(clientSockets[newOrder.clientId], buyMsg.str());
-                }
-                
-                if (clientSockets.find(sellOrder.clientId) != clientSockets.end()) {
-                    stringstream sellMsg;
-                    sellMsg << "TRADE|" << trade.tradeId << "|SATIM|" 
-                           << newOrder.stockSymbol << "|" << fixed << setprecision(2) << tradePrice 
-                           << "|" << tradeQuantity << "|" << sellOrder.orderId;
-                    sendToClient(clientSockets[sellOrder.clientId], sellMsg.str());
-                }
-                
-                pthread_mutex_unlock(&clientSocketMutex);
+            if (newOrder.price < sellOrder.price) break;
 
-                cout << "[" << getTimestamp() << "] İŞLEM - " << newOrder.stockSymbol 
-                     << " " << tradeQuantity << " adet @ " << fixed << setprecision(2) 
-                     << tradePrice << " TL (Alıcı: Client#" << newOrder.clientId 
-                     << ", Satıcı: Client#" << sellOrder.clientId << ")" << endl;
-                
-                ofstream tradeFile("trades.log", ios::app);
-                if (tradeFile.is_open()) {
-                    tradeFile << getDateStamp() << " " << getTimestamp() 
-                             << "|" << trade.tradeId << "|" << newOrder.stockSymbol 
-                             << "|" << tradePrice << "|" << tradeQuantity
-                             << "|Client#" << newOrder.clientId << "|Client#" << sellOrder.clientId << endl;
-                    tradeFile.close();
-                }
-                
-                if (sellOrder.remainingQuantity == 0) {
-                    book.sellOrders.pop_front();
-                }
-            } else break;
+            int tradeQuantity = min(newOrder.remainingQuantity, sellOrder.remainingQuantity);
+            newOrder.remainingQuantity -= tradeQuantity;
+            sellOrder.remainingQuantity -= tradeQuantity;
+            recordTrade(newOrder, sellOrder, sellOrder.price, tradeQuantity);
+
+            if (sellOrder.remainingQuantity == 0) {
+                book.sellOrders.pop_front();
+            }
         }
     } else { 
         while (!book.buyOrders.empty() && newOrder.remainingQuantity > 0) {
             Order& buyOrder = book.buyOrders.front();
-            
-            if (buyOrder.price >= newOrder.price) {
-                int tradeQuantity = min(newOrder.remainingQuantity, buyOrder.remainingQuantity);
-                double tradePrice = newOrder.price; 
-                
-                Trade trade;
-                trade.tradeId = generateTradeId();
-                trade.buyOrderId = buyOrder.orderId;
-                trade.sellOrderId = newOrder.orderId;
-                trade.buyerClientId = buyOrder.clientId;
-                trade.sellerClientId = newOrder.clientId;
-                trade.stockSymbol = newOrder.stockSymbol;
-                trade.price = tradePrice;
-                trade.quantity = tradeQuantity;
-                trade.timestamp = getTimestamp();
-                
-                pthread_mutex_lock(&tradeMutex);
-                trades.push_back(trade);
-                pthread_mutex_unlock(&tradeMutex);
-                
-                newOrder.remainingQuantity -= tradeQuantity;
-                buyOrder.remainingQuantity -= tradeQuantity;
-                
-                pthread_mutex_lock(&clientSocketMutex);
-                
-                if (clientSockets.find(buyOrder.clientId) != clientSockets.end()) {
-                    stringstream buyMsg;
-                    buyMsg << "TRADE|" << trade.tradeId << "|ALIM|" 
-                          << newOrder.stockSymbol << "|" << fixed << setprecision(2) << tradePrice 
-                          << "|" << tradeQuantity << "|" << buyOrder.orderId;
-                    sendToClient(clientSockets[buyOrder.clientId], buyMsg.str());
-                }
-                
-                if (clientSockets.find(newOrder.clientId) != clientSockets.end()) {
-                    stringstream sellMsg;
-                    sellMsg << "TRADE|" << trade.tradeId << "|SATIM|" 
-                           << newOrder.stockSymbol << "|" << fixed << setprecision(2) << tradePrice 
-                           << "|" << tradeQuantity << "|" << newOrder.orderId;
-                    sendToClient(clientSockets[newOrder.clientId], sellMsg.str());
-                }
-                
-                pthread_mutex_unlock(&clientSocketMutex);
-                
-                cout << "[" << getTimestamp() << "] İŞLEM - " << newOrder.stockSymbol 
-                     << " " << tradeQuantity << " adet @ " << fixed << setprecision(2) 
-                     << tradePrice << " TL (Alıcı: Client#" << buyOrder.clientId 
-                     << ", Satıcı: Client#" << newOrder.clientId << ")" << endl;
-                
-                ofstream tradeFile("trades.log", ios::app);
-                if (tradeFile.is_open()) {
-                    tradeFile << getDateStamp() << " " << getTimestamp() 
-                             << "|" << trade.tradeId << "|" << newOrder.stockSymbol 
-                             << "|" << tradePrice << "|" << tradeQuantity
-                             << "|Client#" << buyOrder.clientId << "|Client#" << newOrder.clientId << endl;
-                    tradeFile.close();
-                }
-                
-                if (buyOrder.remainingQuantity == 0) {
-                    book.buyOrders.pop_front();
-                }
-            } else break;
+            if (buyOrder.price < newOrder.price) break;
+
+            int tradeQuantity = min(newOrder.remainingQuantity, buyOrder.remainingQuantity);
+            newOrder.remainingQuantity -= tradeQuantity;
+            buyOrder.remainingQuantity -= tradeQuantity;
+            recordTrade(buyOrder, newOrder, newOrder.price, tradeQuantity);
+
+            if (buyOrder.remainingQuantity == 0) {
+                book.buyOrders.pop_front();
+            }
+        }
+    }
+}
+
+// orderBookMutex çağıran tarafından tutulmalıdır. Son fiyatın geçtiği stoplar
+// map'lerin başında durur; her tetiklenen emir eşleştirildikten sonra yeni son
+// fiyatla tekrar bakılır, zincirleme tetiklemeler aynı sırayla işlenir.
+void triggerStops(const string& symbol) {
+    OrderBook& book = orderBooks[symbol];
+    
+    while (book.lastPrice > 0 && !book.inAuction) {
+        Order triggered;
+        if (!book.buyStops.empty() && book.buyStops.begin()->first <= book.lastPrice) {
+            triggered = book.buyStops.begin()->second;
+            book.buyStops.erase(book.buyStops.begin());
+            unindexOrder(triggered.orderId);
+        } else if (!book.sellStops.empty() && book.sellStops.begin()->first >= book.lastPrice) {
+            triggered = book.sellStops.begin()->second;
+            book.sellStops.erase(book.sellStops.begin());
+            unindexOrder(triggered.orderId);
+        } else {
+            break;
+        }
+        
+        stringstream msg;
+        msg << "STOP_TETIKLENDI|" << triggered.orderId << "|" << fixed << setprecision(2) << book.lastPrice;
+        notifyClient(triggered.clientId, msg.str());
+        
+        triggered.triggerPrice = 0;
+        matchOrders(triggered);
+        if (triggered.remainingQuantity > 0) {
+            if (triggered.stopMarket) {
+                notifyClient(triggered.clientId, "STOP_KALAN_IPTAL|" + triggered.orderId + "|" 
+                             + to_string(triggered.remainingQuantity));
+            } else {
+                insertOrder(book, triggered);
+                scheduleExpiry(triggered);
+            }
+        }
+    }
+}
+
+// orderBookMutex tutulurken çağrılır; karşı tarafı yalnızca okur.
+bool canFillCompletely(const OrderBook& book, const Order& order) {
+    const deque<Order>& opposite = order.type == "AL" ? book.sellOrders : book.buyOrders;
+    int needed = order.remainingQuantity;
+    
+    for (deque<Order>::const_iterator it = opposite.begin(); it != opposite.end(); ++it) {
+        if (order.type == "AL" ? it->price > order.price : it->price < order.price) break;
+        needed -= it->remainingQuantity;
+        if (needed <= 0) return true;
+    }
+    return false;
+}
+
+// orderBookMutex tutulurken çağrılır. reason EXPIRE veya CANCEL. Çoktan
+// eşleşmiş numaralar indekste olmadığı için atlanır; kitaptakiler etkilenen
+// her taraf için tek geçişte, stoplar tetik fiyatından doğrudan silinir.
+int removeOrders(const string& symbol, const set<string>& orderIds, const string& reason) {
+    OrderBook& book = orderBooks[symbol];
+    set<string> bookIds[2];
+    vector<Order> removed;
+    
+    for (set<string>::const_iterator id = orderIds.begin(); id != orderIds.end(); ++id) {
+        map<string, Order>::const_iterator it = openOrders.find(*id);
+        if (it == openOrders.end() || it->second.stockSymbol != symbol) continue;
+        const Order& order = it->second;
+        
+        if (order.triggerPrice > 0) {
+            if (order.type == "AL") {
+                pair<multimap<double, Order>::iterator, multimap<double, Order>::iterator> range = 
+                    book.buyStops.equal_range(order.triggerPrice);
+                for (multimap<double, Order>::iterator s = range.first; s != range.second; ++s) {
+                    if (s->second.orderId == *id) { book.buyStops.erase(s); break; }
+                }
+            } else {
+                pair<multimap<double, Order, greater<double> >::iterator, 
+                     multimap<double, Order, greater<double> >::iterator> range = 
+                    book.sellStops.equal_range(order.triggerPrice);
+                for (multimap<double, Order, greater<double> >::iterator s = range.first; s != range.second; ++s) {
+                    if (s->second.orderId == *id) { book.sellStops.erase(s); break; }
+                }
+            }
+            removed.push_back(order);
+        } else {
+            bookIds[order.type == "AL" ? 0 : 1].insert(*id);
+        }
+    }
+    
+    deque<Order>* sides[2] = { &book.buyOrders, &book.sellOrders };
+    for (int i = 0; i < 2; i++) {
+        if (bookIds[i].empty()) continue;
+        deque<Order>& orders = *sides[i];
+        deque<Order>::iterator out = orders.begin();
+        for (deque<Order>::iterator it = orders.begin(); it != orders.end(); ++it) {
+            if (bookIds[i].count(it->orderId)) {
+                removed.push_back(*it);
+            } else {
+                if (out != it) *out = *it;
+                ++out;
+            }
+        }
+        orders.erase(out, orders.end());
+    }
+    if (removed.empty()) return 0;
+    
+    string ids;
+    for (size_t i = 0; i < removed.size(); i++) {
+        unindexOrder(removed[i].orderId);
+        ids += (i > 0 ? "," : "") + removed[i].orderId;
+    }
+    if (replicationRole == "primary") {
+        lastReplicationSeq = replication.publish(reason + "|" + symbol + "|" + ids);
+    }
+    publishBookSnapshot(symbol);
+    
+    string notice = reason == "EXPIRE" ? "EMIR_SURESI_DOLDU|" : "EMIR_IPTAL|";
+    for (size_t i = 0; i < removed.size(); i++) {
+        flightRecorder.record(reason == "EXPIRE" ? FLIGHT_EXPIRE : FLIGHT_CANCEL, removed[i].clientId, symbol,
+                              removed[i].type, removed[i].price, removed[i].quantity,
+                              removed[i].remainingQuantity, removed[i].orderId);
+        notifyClient(removed[i].clientId, notice + removed[i].orderId + "|" 
+                     + to_string(removed[i].remainingQuantity));
+    }
+    return removed.size();
+}
+
+// Müşterinin tüm bekleyen emirleri; sembol başına tek removeOrders çağrısı.
+int cancelClientOrders(int clientId) {
+    MUTEX_LOCK(orderBookMutex);
+    map<string, set<string> > bySymbol;
+    map<int, set<string> >::const_iterator client = clientOpenOrders.find(clientId);
+    if (client != clientOpenOrders.end()) {
+        for (set<string>::const_iterator id = client->second.begin(); id != client->second.end(); ++id) {
+            bySymbol[openOrders[*id].stockSymbol].insert(*id);
+        }
+    }
+    
+    int cancelled = 0;
+    for (map<string, set<string> >::const_iterator it = bySymbol.begin(); it != bySymbol.end(); ++it) {
+        cancelled += removeOrders(it->first, it->second, "CANCEL");
+    }
+    MUTEX_UNLOCK(orderBookMutex);
+    return cancelled;
+}
+
+// Müşterinin kendi bekleyen emri; iptal bildirimi removeOrders'tan EMIR_IPTAL olarak gider.
+bool cancelOwnOrder(int clientId, const string& orderId) {
+    MUTEX_LOCK(orderBookMutex);
+    map<int, set<string> >::const_iterator client = clientOpenOrders.find(clientId);
+    bool found = client != clientOpenOrders.end() && client->second.count(orderId) > 0;
+    if (found) {
+        set<string> ids;
+        ids.insert(orderId);
+        found = removeOrders(openOrders[orderId].stockSymbol, ids, "CANCEL") > 0;
+    }
+    MUTEX_UNLOCK(orderBookMutex);
+    return found;
+}
+
+// EMIRLERIM yanıtı: başlık satırı ve her açık emir için bir ACIK satırı.
+vector<string> listClientOrders(int clientId) {
+    vector<string> lines;
+    MUTEX_LOCK(orderBookMutex);
+    map<int, set<string> >::const_iterator client = clientOpenOrders.find(clientId);
+    if (client != clientOpenOrders.end()) {
+        for (set<string>::const_iterator id = client->second.begin(); id != client->second.end(); ++id) {
+            const Order& order = openOrders[*id];
+            stringstream line;
+            line << "ACIK|" << order.orderId << "|" << order.stockSymbol << "|" << order.type 
+                 << "|" << fixed << setprecision(2) << order.price << "|" << order.remainingQuantity 
+                 << "|" << order.quantity << "|" << order.timeInForce << "|" << order.triggerPrice;
+            lines.push_back(line.str());
+        }
+    }
+    MUTEX_UNLOCK(orderBookMutex);
+    
+    lines.insert(lines.begin(), "EMIRLERIM|" + to_string(lines.size()));
+    return lines;
+}
+
+// Cevap: "POZISYONLAR|n" ve n adet "POZ|sembol|adet|ortMaliyet|sonFiyat|gerçekleşen|gerçekleşmemiş|tutar".
+vector<string> listClientPositions(int clientId) {
+    vector<string> lines;
+    MUTEX_LOCK(orderBookMutex);
+    vector<Position> held = positions.positionsOf(clientId);
+    for (size_t i = 0; i < held.size(); i++) {
+        const Position& position = held[i];
+        double mark = orderBooks[position.symbol].lastPrice;
+        stringstream line;
+        line << "POZ|" << position.symbol << "|" << position.quantity << "|" << fixed << setprecision(2)
+             << position.averageCost << "|" << mark << "|" << position.realizedPnl << "|"
+             << position.unrealizedPnl(mark) << "|" << position.notional;
+        lines.push_back(line.str());
+    }
+    MUTEX_UNLOCK(orderBookMutex);
+    
+    lines.insert(lines.begin(), "POZISYONLAR|" + to_string(lines.size()));
+    return lines;
+}
+
+void* expiryTicker(void*) {
+    while (serverRunning) {
+        usleep(200000);
+        
+        MUTEX_LOCK(orderBookMutex);
+        vector<TimerEntry> due;
+        expiryWheel.advance(time(0), due);
+        
+        map<string, set<string> > bySymbol;
+        for (size_t i = 0; i < due.size(); i++) {
+            bySymbol[due[i].symbol].insert(due[i].orderId);
+        }
+        int expired = 0;
+        for (map<string, set<string> >::const_iterator it = bySymbol.begin(); it != bySymbol.end(); ++it) {
+            expired += removeOrders(it->first, it->second, "EXPIRE");
+        }
+        MUTEX_UNLOCK(orderBookMutex);
+        
+        if (expired > 0) {
+            cout << "[" << getTimestamp() << "] " << expired << " emrin süresi doldu" << endl;
+            saveOrderBook();
+        }
+    }
+    return NULL;
+}
+
+// Dönen değer emrin son replikasyon seq'idir (primary değilken 0). riskResult
+// verilirse risk kontrolü eşleştirmeyle aynı kilit altında yapılır; red durumunda
+// emir kitaba ve replikasyona dokunmadan döner. Simülatör ve standby vermez.
+uint64_t matchAndRest(Order& order, int* riskResult = NULL) {
+    {
+        TraceSpan span("orderBookMutex bekleme");
+        MUTEX_LOCK(orderBookMutex);
+    }
+    if (riskResult != NULL) {
+        TraceSpan span("risk kontrolü");
+        *riskResult = riskEngine.check(order.clientId, order.stockSymbol, order.type, order.price, order.quantity);
+        if (*riskResult != RISK_OK) {
+            MUTEX_UNLOCK(orderBookMutex);
+            return 0;
+        }
+    }
+    if (replicationRole == "primary") {
+        stringstream event;
+        event << setprecision(15) << "ORDER|" << order.orderId << "|" << order.clientId 
+              << "|" << order.stockSymbol << "|" << order.type << "|" << order.price 
+              << "|" << order.quantity << "|" << order.timestamp
+              << "|" << order.timeInForce << "|" << order.expiresAt << "|" << order.reference;
+        lastReplicationSeq = replication.publish(event.str());
+    }
+    OrderBook& book = orderBooks[order.stockSymbol];
+    bool immediate = order.timeInForce == "IOC" || order.timeInForce == "FOK";
+    
+    // Müzayede sırasında emirler eşleşmeden birikir; IOC/FOK müzayedede ve
+    // FOK yeterli karşı likidite yoksa kitaba dokunulmadan iptal edilir.
+    if (!book.inAuction && (order.timeInForce != "FOK" || canFillCompletely(book, order))) {
+        TraceSpan span("eşleştirme");
+        matchOrders(order);
+    }
+    flightRecorder.record(FLIGHT_MATCH, order.clientId, order.stockSymbol, order.type, order.price,
+                          order.quantity, order.remainingQuantity, order.orderId);
+    if (order.remainingQuantity > 0) {
+        if (immediate) {
+            order.status = "CANCELLED";
+            flightRecorder.record(FLIGHT_CANCEL, order.clientId, order.stockSymbol, order.type, order.price,
+                                  order.quantity, order.remainingQuantity, order.orderId);
+            notifyClient(order.clientId, "EMIR_IPTAL|" + order.orderId + "|" 
+                         + to_string(order.remainingQuantity));
+        } else {
+            insertOrder(book, order);
+            scheduleExpiry(order);
+        }
+    }
+    triggerStops(order.stockSymbol);
+    publishBookSnapshot(order.stockSymbol);
+    uint64_t seq = replicationRole == "primary" ? lastReplicationSeq : 0;
+    MUTEX_UNLOCK(orderBookMutex);
+    return seq;
+}
+
+uint64_t addOrderToBook(Order& order, int* riskResult) {
+    uint64_t seq = matchAndRest(order, riskResult);
+    if (*riskResult != RISK_OK) return 0;
+    TraceSpan span("saveOrderBook");
+    saveOrderBook();
+    return seq;
+}
+
+// Stop piyasa emri tetiklenince bant sınırından limit emri olarak eşleşir.
+// riskResult matchAndRest'teki gibidir; stop piyasada limit yerine tetik sınanır.
+uint64_t restStopOrder(Order& order, int* riskResult = NULL) {
+    MUTEX_LOCK(orderBookMutex);
+    if (riskResult != NULL) {
+        *riskResult = riskEngine.checkStop(order.clientId, order.stockSymbol, order.type, order.triggerPrice,
+                                           order.stopMarket ? order.triggerPrice : order.price, order.quantity);
+        if (*riskResult != RISK_OK) {
+            MUTEX_UNLOCK(orderBookMutex);
+            return 0;
+        }
+    }
+    if (replicationRole == "primary") {
+        lastReplicationSeq = replication.publish("STOP|" + formatOrderRecord(order));
+    }
+    insertStop(orderBooks[order.stockSymbol], order);
+    scheduleExpiry(order);
+    triggerStops(order.stockSymbol);
+    publishBookSnapshot(order.stockSymbol);
+    uint64_t seq = replicationRole == "primary" ? lastReplicationSeq : 0;
+    MUTEX_UNLOCK(orderBookMutex);
+    return seq;
+}
+
+// orderBookMutex tutulurken çağrılır.
+vector<AuctionLevel> aggregateLevels(const deque<Order>& orders) {
+    vector<AuctionLevel> levels;
+    for (deque<Order>::const_iterator it = orders.begin(); it != orders.end(); ++it) {
+        if (!levels.empty() && levels.back().first == it->price) {
+            levels.back().second += it->remainingQuantity;
+        } else {
+            levels.push_back(AuctionLevel(it->price, it->remainingQuantity));
+        }
+    }
+    return levels;
+}
+
+double auctionReferencePrice(const string& symbol) {
+    SymbolStats stats;
+    MUTEX_LOCK(tradeMutex);
+    bool traded = tradeStore.getStats(symbol, stats) && stats.tradeCount > 0;
+    MUTEX_UNLOCK(tradeMutex);
+    if (traded) return stats.last;
+    
+    RcuReadGuard<StockTable> table(stockTable);
+    for (const Stock& stock : table->stocks) {
+        if (stock.symbol == symbol) return stock.base_price;
+    }
+    return 0;
+}
+
+// orderBookMutex tutulurken çağrılır.
+AuctionResult indicativeAuction(const string& symbol) {
+    OrderBook& book = orderBooks[symbol];
+    return computeEquilibrium(aggregateLevels(book.buyOrders), aggregateLevels(book.sellOrders),
+                              auctionReferencePrice(symbol));
+}
+
+// orderBookMutex tutulurken çağrılır. Denge fiyatında işlem görebilecek hacim
+// kitabın iki ucundan tek seferde, tamamı aynı fiyattan eşleştirilir.
+AuctionResult uncrossBook(const string& symbol) {
+    OrderBook& book = orderBooks[symbol];
+    AuctionResult result = indicativeAuction(symbol);
+    
+    long long remaining = result.crossed ? result.volume : 0;
+    while (remaining > 0 && !book.buyOrders.empty() && !book.sellOrders.empty()) {
+        Order& buyOrder = book.buyOrders.front();
+        Order& sellOrder = book.sellOrders.front();
+        int tradeQuantity = (int)min<long long>(remaining, 
+                                                min(buyOrder.remainingQuantity, sellOrder.remainingQuantity));
+        buyOrder.remainingQuantity -= tradeQuantity;
+        sellOrder.remainingQuantity -= tradeQuantity;
+        remaining -= tradeQuantity;
+        recordTrade(buyOrder, sellOrder, result.price, tradeQuantity);
+        
+        if (buyOrder.remainingQuantity == 0) book.buyOrders.pop_front();
+        if (sellOrder.remainingQuantity == 0) book.sellOrders.pop_front();
+    }
+    
+    book.inAuction = false;
+    triggerStops(symbol);
+    publishBookSnapshot(symbol);
+    return result;
+}
+
+bool openAuction(const string& symbol) {
+    MUTEX_LOCK(orderBookMutex);
+    OrderBook& book = orderBooks[symbol];
+    bool opened = !book.inAuction;
+    if (opened) {
+        book.inAuction = true;
+        if (replicationRole == "primary") {
+            lastReplicationSeq = replication.publish("AUCTION|" + symbol + "|OPEN");
+        }
+    }
+    MUTEX_UNLOCK(orderBookMutex);
+    
+    if (opened) {
+        cout << "[" << getTimestamp() << "] MÜZAYEDE - " << symbol << " emir toplama başladı" << endl;
+    }
+    return opened;
+}
+
+bool closeAuction(const string& symbol) {
+    MUTEX_LOCK(orderBookMutex);
+    OrderBook& book = orderBooks[symbol];
+    if (!book.inAuction) {
+        MUTEX_UNLOCK(orderBookMutex);
+        return false;
+    }
+    if (replicationRole == "primary") {
+        lastReplicationSeq = replication.publish("AUCTION|" + symbol + "|UNCROSS");
+    }
+    AuctionResult result = uncrossBook(symbol);
+    MUTEX_UNLOCK(orderBookMutex);
+    
+    if (result.crossed) {
+        cout << "[" << getTimestamp() << "] MÜZAYEDE - " << symbol << " eşleşme: " 
+             << result.volume << " adet @ " << fixed << setprecision(2) << result.price 
+             << " TL (alış " << result.buyVolume << " / satış " << result.sellVolume << ")" << endl;
+    } else {
+        cout << "[" << getTimestamp() << "] MÜZAYEDE - " << symbol 
+             << " kesişen emir yok, sürekli işleme geçildi" << endl;
+    }
+    saveOrderBook();
+    return true;
+}
+
+vector<string> auctionSymbols(const string& target) {
+    vector<string> symbols;
+    if (target == "hepsi") {
+        RcuReadGuard<StockTable> table(stockTable);
+        for (const Stock& stock : table->stocks) symbols.push_back(stock.symbol);
+    } else if (!target.empty()) {
+        symbols.push_back(target);
+    }
+    return symbols;
+}
+
+void displayAuctions(ostream& out) {
+    out << "\n=== MÜZAYEDE DURUMU ===" << endl;
+    bool any = false;
+    MUTEX_LOCK(orderBookMutex);
+    for (map<string, OrderBook>::const_iterator it = orderBooks.begin(); it != orderBooks.end(); ++it) {
+        if (!it->second.inAuction) continue;
+        any = true;
+        AuctionResult result = indicativeAuction(it->first);
+        out << it->first << ": ";
+        if (result.crossed) {
+            out << "teorik fiyat " << fixed << setprecision(2) << result.price 
+                << " TL, hacim " << result.volume << " (alış " << result.buyVolume 
+                << " / satış " << result.sellVolume << ")" << endl;
+        } else {
+            out << "kesişen emir yok" << endl;
+        }
+    }
+    MUTEX_UNLOCK(orderBookMutex);
+    if (!any) {
+        out << "Müzayedede hisse yok, tüm hisseler sürekli işlemde." << endl;
+    }
+}
+
+// [auction] schedule=09:40-10:00,17:50-18:00 biçimindeki pencerelerde
+// başlangıçta tüm hisseler müzayedeye alınır, bitişte eşleştirilir.
+void* auctionScheduler(void* arg) {
+    vector<pair<string, string> >* windows = (vector<pair<string, string> >*)arg;
+    string lastMinute;
+    
+    while (serverRunning) {
+        time_t now = time(0);
+        char buffer[6];
+        strftime(buffer, sizeof(buffer), "%H:%M", localtime(&now));
+        string minute(buffer);
+        
+        if (minute != lastMinute) {
+            lastMinute = minute;
+            for (size_t i = 0; i < windows->size(); i++) {
+                vector<string> symbols = auctionSymbols("hepsi");
+                for (size_t s = 0; s < symbols.size(); s++) {
+                    if ((*windows)[i].first == minute) openAuction(symbols[s]);
+                    if ((*windows)[i].second == minute) closeAuction(symbols[s]);
+                }
+            }
+        }
+        sleep(1);
+    }
+    
+    delete windows;
+    return NULL;
+}
+
+void startAuctionScheduler(const string& schedule) {
+    vector<pair<string, string> >* windows = new vector<pair<string, string> >();
+    stringstream ss(schedule);
+    string window;
+    while (getline(ss, window, ',')) {
+        size_t dash = window.find('-');
+        if (dash == string::npos) continue;
+        windows->push_back(make_pair(window.substr(0, dash), window.substr(dash + 1)));
+    }
+    if (windows->empty()) {
+        delete windows;
+        return;
+    }
+    
+    pthread_t thread;
+    pthread_create(&thread, NULL, auctionScheduler, windows);
+    pthread_detach(thread);
+    cout << "Müzayede takvimi: " << schedule << endl;
+}
+
+bool cancelRestingOrder(const string& symbol, const string& orderId) {
+    set<string> ids;
+    ids.insert(orderId);
+    MUTEX_LOCK(orderBookMutex);
+    bool found = removeOrders(symbol, ids, "CANCEL") > 0;
+    MUTEX_UNLOCK(orderBookMutex);
+    return found;
+}
+
+// Simülatör emirleri loglanmaz ve her emirde diske yazılmaz; kalıcılık
+// autoSaveOrderBook thread'ine bırakılır.
+string submitSimulatedOrder(int clientId, const string& symbol, bool buy, double price, int quantity) {
+    Order order;
+    order.orderId = generateOrderId();
+    order.clientId = clientId;
+    order.clientSocket = -1;
+    order.stockSymbol = symbol;
+    order.type = buy ? "AL" : "SAT";
+    order.price = price;
+    order.quantity = quantity;
+    order.remainingQuantity = quantity;
+    order.status = "PENDING";
+    order.timestamp = getTimestamp();
+    
+    matchAndRest(order);
+    return order.remainingQuantity > 0 ? order.orderId : string();
+}
+
+MarketSimulator simulator(bookSnapshots, submitSimulatedOrder, cancelRestingOrder);
+
+bool startSimulator(long long rate) {
+    vector<SimInstrument> universe;
+    RcuReadGuard<StockTable> table(stockTable);
+    MUTEX_LOCK(orderBookMutex);
+    for (const Stock& stock : table->stocks) {
+        publishBookSnapshot(stock.symbol);
+        
+        SimInstrument instrument;
+        instrument.symbol = stock.symbol;
+        instrument.basePrice = stock.base_price;
+        instrument.tickSize = stock.tick_size;
+        instrument.minPrice = stock.min;
+        instrument.maxPrice = stock.max;
+        instrument.snapshotSlot = orderBooks[stock.symbol].snapshotSlot;
+        universe.push_back(instrument);
+    }
+    MUTEX_UNLOCK(orderBookMutex);
+    
+    return simulator.start(universe, rate);
+}
+
+// Risk reddinde emir kaydedilmez; dönen değer RiskResult'tır.
+int processOrder(Order& order, const string& msg) {
+    orderTracer.setOrder(order.orderId);
+    int risk;
+    uint64_t seq = addOrderToBook(order, &risk);
+    if (risk != RISK_OK) return risk;
+    acceptedOrders.fetch_add(1, memory_order_relaxed);
+    {
+        TraceSpan span("server_orders.log");
+        ofstream orderFile("server_orders.log", ios::app);
+        if (orderFile.is_open()) {
+            orderFile << getDateStamp() << " " << getTimestamp() 
+                    << "|Client#" << order.clientId << "|" << msg << endl;
+            orderFile.close();
+        }
+    }
+    
+    {
+        TraceSpan span("konsol");
+        cout << "[" << getTimestamp() << "] EMİR - Client #" << order.clientId 
+            << ": " << order.stockSymbol << " " << order.type << " " 
+            << order.price << " TL x " << order.quantity << " adet" << endl;
+    }
+    
+    if (seq > 0) {
+        TraceSpan span("replikasyon onayı");
+        replication.waitAck(seq);
+    }
+    return RISK_OK;
+}
+
+void displayOrderBook(ostream& out) {
+    out << "\n=== ORDER BOOK DURUMU ===" << endl;
+    
+    BookSnapshot snapshot;
+    for (int slot = 0; slot < bookSnapshots.count(); slot++) {
+        if (!bookSnapshots.read(slot, snapshot)) {
+            continue;
+        }
+        if (snapshot.bidCount == 0 && snapshot.askCount == 0) {
+            continue;
+        }
+        
+        out << "\n" << snapshot.symbol << " (v" << snapshot.version << "):" << endl;
+        out << "  ALIŞ EMİRLERİ:" << endl;
+        for (int i = 0; i < snapshot.bidCount && i < 5; i++) {
+            out << "    " << fixed << setprecision(2) << snapshot.bids[i].price 
+                << " TL x " << snapshot.bids[i].quantity << " adet (" 
+                << snapshot.bids[i].orderCount << " emir)" << endl;
+        }
+        
+        out << "  SATIŞ EMİRLERİ:" << endl;
+        for (int i = 0; i < snapshot.askCount && i < 5; i++) {
+            out << "    " << fixed << setprecision(2) << snapshot.asks[i].price 
+                << " TL x " << snapshot.asks[i].quantity << " adet (" 
+                << snapshot.asks[i].orderCount << " emir)" << endl;
+        }
+    }
+    
+    out << string(50, '-') << endl;
+}
+
+string formatNanos(int64_t nanos) {
+    time_t seconds = nanos / 1000000000LL;
+    struct tm* timeinfo = localtime(&seconds);
+    char buffer[20];
+    strftime(buffer, sizeof(buffer), "%H:%M:%S", timeinfo);
+    return string(buffer);
+}
+
+void displayTradeSummary(ostream& out) {
+    MUTEX_LOCK(tradeMutex);
+    map<string, SymbolStats> symbolStats = tradeStore.allStats();
+    vector<TradeRecord> recent = tradeStore.recentTrades(20);
+    vector<string> recentSymbols;
+    for (size_t i = 0; i < recent.size(); i++) {
+        recentSymbols.push_back(tradeStore.symbolName(recent[i].symbolId));
+    }
+    uint64_t totalTrades = tradeStore.totalTrades();
+    MUTEX_UNLOCK(tradeMutex);
+    
+    out << "\n=== GÜNÜN İŞLEMLERİ ===" << endl;
+    out << string(80, '-') << endl;
+    out << setw(8) << "Hisse" << setw(10) << "Açılış" << setw(10) << "Yüksek" 
+        << setw(10) << "Düşük" << setw(10) << "Son" << setw(10) << "VWAP" 
+        << setw(10) << "Hacim" << setw(8) << "İşlem" << endl;
+    
+    double todayVolume = 0;
+    for (map<string, SymbolStats>::const_iterator it = symbolStats.begin(); 
+         it != symbolStats.end(); ++it) {
+        const SymbolStats& st = it->second;
+        todayVolume += st.notional;
+        out << setw(8) << it->first << fixed << setprecision(2)
+            << setw(10) << st.open << setw(10) << st.high << setw(10) << st.low 
+            << setw(10) << st.last << setw(10) << st.vwap() 
+            << setw(10) << st.volume << setw(8) << st.tradeCount << endl;
+    }
+    
+    out << string(80, '-') << endl;
+    out << "Son " << recent.size() << " işlem:" << endl;
+    for (size_t i = 0; i < recent.size(); i++) {
+        out << formatNanos(recent[i].timestampNs) << " " << recentSymbols[i] 
+            << " " << recent[i].quantity << " adet @ " << fixed << setprecision(2) 
+            << recent[i].price << " TL (Alıcı: Client#" << recent[i].buyerClientId 
+            << ", Satıcı: Client#" << recent[i].sellerClientId << ")" << endl;
+    }
+    
+    out << string(80, '-') << endl;
+    out << "Toplam İşlem: " << totalTrades << endl;
+    out << "Toplam Hacim: " << fixed << setprecision(2) << todayVolume << " TL" << endl;
+}
+
+void displayCandles(ostream& out, const string& symbol) {
+    MUTEX_LOCK(tradeMutex);
+    vector<Candle> series = tradeStore.getCandles(symbol, 10);
+    MUTEX_UNLOCK(tradeMutex);
+    
+    out << "\n=== " << symbol << " MUM GRAFİĞİ ===" << endl;
+    if (series.empty()) {
+        out << "İşlem bulunamadı." << endl;
+        return;
+    }
+    
+    for (size_t i = 0; i < series.size(); i++) {
+        const Candle& c = series[i];
+        out << formatNanos(c.bucketStart) << fixed << setprecision(2)
+            << "  A:" << c.open << " Y:" << c.high << " D:" << c.low 
+            << " K:" << c.close << " Hacim:" << c.volume 
+            << " VWAP:" << (c.volume > 0 ? c.notional / c.volume : 0) << endl;
+    }
+}
+
+void displayServerOrders(ostream& out) {
+    ifstream file("server_orders.log");
+    if (!file.is_open()) {
+        out << "\nEmir dosyası bulunamadı." << endl;
+        return;
+    }
+    
+    vector<string> orders;
+    string line;
+    while (getline(file, line)) {
+        orders.push_back(line);
+    }
+    file.close();
+    
+    out << "\n=== SON EMİRLER ===" << endl;
+    out << string(80, '-') << endl;
+    
+    int count = min(20, (int)orders.size());
+    int start = orders.size() - count;
+    
+    for (int i = start; i < (int)orders.size(); i++) {
+        stringstream ss(orders[i]);
+        string timestamp, client, orderData;
+        getline(ss, timestamp, '|');
+        getline(ss, client, '|');
+        getline(ss, orderData);
+
+        stringstream orderSS(orderData);
+        string cmd, symbol, type, price, quantity;
+        getline(orderSS, cmd, '|');
+        getline(orderSS, symbol, '|');
+        getline(orderSS, type, '|');
+        getline(orderSS, price, '|');
+        getline(orderSS, quantity, '|');
+        
+        out << timestamp << " " << client << " " 
+            << symbol << " " << type << " " 
+            << price << " TL x " << quantity << " adet" << endl;
+    }
+    out << string(80, '-') << endl;
+    out << "Toplam " << count << " emir gösteriliyor." << endl;
+}
+
+void displayDailySummary(ostream& out) {
+    ifstream file("server_orders.log");
+    if (!file.is_open()) {
+        out << "\nEmir dosyası bulunamadı." << endl;
+        return;
+    }
+    
+    string today = getDateStamp();
+    int totalOrders = 0;
+    int buyOrders = 0;
+    int sellOrders = 0;
+    double totalVolume = 0;
+    map<string, int> stockCounts;
+    
+    string line;
+    while (getline(file, line)) {
+        if (line.find(today) != string::npos) {
+            totalOrders++;
+            
+            stringstream ss(line);
+            string timestamp, client, orderData;
+            getline(ss, timestamp, '|');
+            getline(ss, client, '|');
+            getline(ss, orderData);
+            
+            stringstream orderSS(orderData);
+            string cmd, symbol, type, priceStr, quantityStr;
+            getline(orderSS, cmd, '|');
+            getline(orderSS, symbol, '|');
+            getline(orderSS, type, '|');
+            getline(orderSS, priceStr, '|');
+            getline(orderSS, quantityStr, '|');
+            
+            if (type == "AL") buyOrders++;
+            else if (type == "SAT") sellOrders++;
+            
+            stockCounts[symbol]++;
+            
+            double price = atof(priceStr.c_str());
+            int quantity = atoi(quantityStr.c_str());
+            totalVolume += price * quantity;
+        }
+    }
+    file.close();
+    
+    out << "\n=== GÜNLÜK ÖZET (" << today << ") ===" << endl;
+    out << string(50, '-') << endl;
+    out << "Toplam Emir: " << totalOrders << endl;
+    out << "Alış Emirleri: " << buyOrders << endl;
+    out << "Satış Emirleri: " << sellOrders << endl;
+    out << "Toplam İşlem Hacmi: " << fixed << setprecision(2) << totalVolume << " TL" << endl;
+    out << "\nHisse Bazında Dağılım:" << endl;
+    
+    for (map<string, int>::const_iterator it = stockCounts.begin(); 
+         it != stockCounts.end(); ++it) {
+        out << "  " << it->first << ": " << it->second << " emir" << endl;
+    }
+    out << string(50, '-') << endl;
+}
+
+// Yeni bağlanan yedeğe kitabın tam görüntüsü gönderilir; orderBookMutex tutulduğu
+// için görüntü ile sonraki olaylar arasında boşluk oluşmaz.
+void* replicationAcceptor(void* arg) {
+    int listenSocket = *(int*)arg;
+    delete (int*)arg;
+
+    while (serverRunning) {
+        int standbySocket = accept(listenSocket, NULL, NULL);
+        if (standbySocket < 0) continue;
+
+        int flag = 1;
+        setsockopt(standbySocket, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+        MUTEX_LOCK(orderBookMutex);
+        vector<string> bodies;
+        bodies.push_back("SYNC_BEGIN");
+        for (map<string, OrderBook>::const_iterator it = orderBooks.begin(); 
+             it != orderBooks.end(); ++it) {
+            const OrderBook& book = it->second;
+            for (deque<Order>::const_iterator o = book.buyOrders.begin(); o != book.buyOrders.end(); ++o) {
+                bodies.push_back("BOOK|" + formatOrderRecord(*o));
+            }
+            for (deque<Order>::const_iterator o = book.sellOrders.begin(); o != book.sellOrders.end(); ++o) {
+                bodies.push_back("BOOK|" + formatOrderRecord(*o));
+            }
+            for (multimap<double, Order>::const_iterator o = book.buyStops.begin(); o != book.buyStops.end(); ++o) {
+                bodies.push_back("STOPBOOK|" + formatOrderRecord(o->second));
+            }
+            for (multimap<double, Order, greater<double> >::const_iterator o = book.sellStops.begin(); 
+                 o != book.sellStops.end(); ++o) {
+                bodies.push_back("STOPBOOK|" + formatOrderRecord(o->second));
+            }
+            if (book.lastPrice > 0) {
+                stringstream last;
+                last << setprecision(15) << "LAST|" << it->first << "|" << book.lastPrice;
+                bodies.push_back(last.str());
+            }
+        }
+        vector<string> records = positions.records();
+        for (size_t i = 0; i < records.size(); i++) {
+            bodies.push_back("POS|" + records[i]);
+        }
+        // Yeni oturumlar clientSocketMutex altında yayınlanır; kilit attach'a kadar
+        // tutulur ki görüntüye girmeyen oturum olay olarak gelsin.
+        MUTEX_LOCK(clientSocketMutex);
+        vector<string> sessionRecords = sessions.records();
+        for (size_t i = 0; i < sessionRecords.size(); i++) {
+            bodies.push_back("SESSION|" + sessionRecords[i]);
+        }
+        MUTEX_LOCK(orderIdMutex);
+        string orderIdNext = to_string(orderIdCounter);
+        MUTEX_UNLOCK(orderIdMutex);
+        MUTEX_LOCK(clientCountMutex);
+        string clientIdNext = to_string(nextClientId);
+        MUTEX_UNLOCK(clientCountMutex);
+        bodies.push_back("SYNC_END|" + orderIdNext + "|" + to_string(tradeIdCounter) + "|" + clientIdNext);
+        replication.attach(standbySocket, bodies);
+        MUTEX_UNLOCK(clientSocketMutex);
+        MUTEX_UNLOCK(orderBookMutex);
+
+        cout << "[" << getTimestamp() << "] Yedek sunucu bağlandı (" 
+             << bodies.size() - 2 << " kayıt senkronlandı)" << endl;
+    }
+    return NULL;
+}
+
+bool startReplicationPrimary(int port) {
+    int listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket < 0) return false;
+
+    int opt = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(port);
+
+    if (::bind(listenSocket, (struct sockaddr*)&address, sizeof(address)) < 0
+        || listen(listenSocket, 1) < 0) {
+        close(listenSocket);
+        return false;
+    }
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, replicationAcceptor, new int(listenSocket));
+    pthread_detach(thread);
+    return true;
+}
+
+// Yedek tarafı: "R|seq|ns|gövde" satırını uygular.
+void applyReplicationLine(const string& line) {
+    stringstream ss(line);
+    string tag, seqStr, nanosStr, kind;
+    getline(ss, tag, '|');
+    getline(ss, seqStr, '|');
+    getline(ss, nanosStr, '|');
+    getline(ss, kind, '|');
+    if (tag != "R") return;
+
+    uint64_t seq = strtoull(seqStr.c_str(), NULL, 10);
+    int64_t sentNs = atoll(nanosStr.c_str());
+    string rest;
+    getline(ss, rest);
+
+    if (kind == "ORDER") {
+        stringstream fields(rest);
+        string orderId, clientIdStr, symbol, type, priceStr, quantityStr, timestamp;
+        getline(fields, orderId, '|');
+        getline(fields, clientIdStr, '|');
+        getline(fields, symbol, '|');
+        getline(fields, type, '|');
+        getline(fields, priceStr, '|');
+        getline(fields, quantityStr, '|');
+        getline(fields, timestamp, '|');
+        string tif, expiresStr, reference;
+        getline(fields, tif, '|');
+        getline(fields, expiresStr, '|');
+        getline(fields, reference, '|');
+
+        Order order;
+        order.timeInForce = tif;
+        order.expiresAt = atoll(expiresStr.c_str());
+        order.orderId = orderId;
+        order.clientId = atoi(clientIdStr.c_str());
+        order.clientSocket = -1;
+        order.stockSymbol = symbol;
+        order.type = type;
+        order.price = atof(priceStr.c_str());
+        order.quantity = atoi(quantityStr.c_str());
+        order.remainingQuantity = order.quantity;
+        order.status = "PENDING";
+        order.timestamp = timestamp;
+        
+        // Devralma sonrası numaraların çakışmaması için sayaçlar primary'yi izler.
+        int id = atoi(orderId.substr(3).c_str());
+        MUTEX_LOCK(orderIdMutex);
+        if (id >= orderIdCounter) orderIdCounter = id + 1;
+        MUTEX_UNLOCK(orderIdMutex);
+        MUTEX_LOCK(clientCountMutex);
+        if (order.clientId >= nextClientId) nextClientId = order.clientId + 1;
+        MUTEX_UNLOCK(clientCountMutex);
+        if (!reference.empty()) {
+            MUTEX_LOCK(clientSocketMutex);
+            ClientSession* session = sessions.find(order.clientId);
+            if (session != NULL) sessions.claimReference(*session, reference);
+            MUTEX_UNLOCK(clientSocketMutex);
+        }
+        
+        matchAndRest(order);
+    } else if (kind == "STOP") {
+        Order order;
+        if (parseOrderRecord(rest, order)) {
+            int id = atoi(order.orderId.substr(3).c_str());
+            MUTEX_LOCK(orderIdMutex);
+            if (id >= orderIdCounter) orderIdCounter = id + 1;
+            MUTEX_UNLOCK(orderIdMutex);
+            restStopOrder(order);
+        }
+    } else if (kind == "SESSION") {
+        MUTEX_LOCK(clientSocketMutex);
+        sessions.restore(rest, time(0));
+        MUTEX_UNLOCK(clientSocketMutex);
+    } else if (kind == "AUCTION") {
+        size_t bar = rest.find('|');
+        if (bar != string::npos) {
+            if (rest.substr(bar + 1) == "OPEN") openAuction(rest.substr(0, bar));
+            else closeAuction(rest.substr(0, bar));
+        }
+    } else if (kind == "EXPIRE" || kind == "CANCEL") {
+        size_t bar = rest.find('|');
+        if (bar != string::npos) {
+            set<string> ids;
+            stringstream list(rest.substr(bar + 1));
+            string id;
+            while (getline(list, id, ',')) ids.insert(id);
+            MUTEX_LOCK(orderBookMutex);
+            removeOrders(rest.substr(0, bar), ids, kind);
+            MUTEX_UNLOCK(orderBookMutex);
+        }
+    }
+
+    MUTEX_LOCK(orderBookMutex);
+    if (kind == "SYNC_BEGIN") {
+        for (map<string, OrderBook>::iterator it = orderBooks.begin(); it != orderBooks.end(); ++it) {
+            it->second.buyOrders.clear();
+            it->second.sellOrders.clear();
+            it->second.buyStops.clear();
+            it->second.sellStops.clear();
+            it->second.lastPrice = 0;
+        }
+        openOrders.clear();
+        openOrderCount.store(0);
+        clientOpenOrders.clear();
+        riskEngine.clearOpenOrders();
+        positions.clear();
+        standbyLocalFills.clear();
+    } else if (kind == "BOOK" || kind == "STOPBOOK") {
+        Order order;
+        if (parseOrderRecord(rest, order)) {
+            if (kind == "BOOK") {
+                insertOrder(orderBooks[order.stockSymbol], order);
+            } else {
+                insertStop(orderBooks[order.stockSymbol], order);
+            }
+            scheduleExpiry(order);
+        }
+    } else if (kind == "POS") {
+        positions.restore(rest);
+    } else if (kind == "LAST") {
+        size_t bar = rest.find('|');
+        if (bar != string::npos) {
+            orderBooks[rest.substr(0, bar)].lastPrice = atof(rest.c_str() + bar + 1);
+        }
+    } else if (kind == "SYNC_END") {
+        stringstream fields(rest);
+        string orderIdStr, tradeIdStr, clientIdStr;
+        getline(fields, orderIdStr, '|');
+        getline(fields, tradeIdStr, '|');
+        getline(fields, clientIdStr, '|');
+        MUTEX_LOCK(orderIdMutex);
+        orderIdCounter = atoi(orderIdStr.c_str());
+        MUTEX_UNLOCK(orderIdMutex);
+        tradeIdCounter = atoi(tradeIdStr.c_str());
+        MUTEX_LOCK(clientCountMutex);
+        nextClientId = atoi(clientIdStr.c_str());
+        MUTEX_UNLOCK(clientCountMutex);
+        for (map<string, OrderBook>::const_iterator it = orderBooks.begin(); it != orderBooks.end(); ++it) {
+            publishBookSnapshot(it->first);
+        }
+    } else if (kind == "FILL") {
+        standbyFillChecks++;
+        if (standbyLocalFills.empty() || standbyLocalFills.front() != "FILL|" + rest) {
+            standbyFillMismatches++;
+            cerr << "Replikasyon uyuşmazlığı: FILL|" << rest << endl;
+        }
+        if (!standbyLocalFills.empty()) standbyLocalFills.pop_front();
+    }
+    if (kind != "HB") {
+        standbyLag.add(getNanos() - sentNs);
+    }
+    if (seq > standbyAppliedSeq) standbyAppliedSeq = seq;
+    MUTEX_UNLOCK(orderBookMutex);
+
+    if (kind == "SYNC_END") {
+        saveOrderBook();
+        cout << "[" << getTimestamp() << "] Primary ile senkronize olundu (seq " << seq << ")" << endl;
+    }
+}
+
+// Primary'ye bağlanır ve akışı uygular; bağlantı koptuğunda veya heartbeat
+// zaman aşımında döner ve sunucu primary rolünü devralır.
+void runStandby(const string& host, int port, int heartbeatTimeoutMs) {
+    int standbySocket = -1;
+    bool announced = false;
+    while (standbySocket < 0) {
+        standbySocket = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        inet_pton(AF_INET, host.c_str(), &address.sin_addr);
+
+        if (connect(standbySocket, (struct sockaddr*)&address, sizeof(address)) < 0) {
+            close(standbySocket);
+            standbySocket = -1;
+            if (!announced) {
+                cout << "Primary " << host << ":" << port << " bekleniyor..." << endl;
+                announced = true;
+            }
+            usleep(200000);
+        }
+    }
+    cout << "[" << getTimestamp() << "] Primary'ye bağlanıldı (" << host << ":" << port << ")" << endl;
+
+    int flag = 1;
+    setsockopt(standbySocket, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+    string buffered;
+    char buffer[65536];
+    int64_t lastMessageNs = getNanos();
+    string reason;
+
+    while (true) {
+        struct pollfd pfd;
+        pfd.fd = standbySocket;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int ready = poll(&pfd, 1, heartbeatTimeoutMs);
+        if (ready == 0) {
+            reason = "heartbeat zaman aşımı";
+            break;
+        }
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            reason = "poll hatası";
+            break;
+        }
+
+        ssize_t n = recv(standbySocket, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            reason = "bağlantı kapandı";
+            break;
+        }
+        lastMessageNs = getNanos();
+        buffered.append(buffer, n);
+
+        size_t start = 0;
+        size_t newline;
+        while ((newline = buffered.find('\n', start)) != string::npos) {
+            applyReplicationLine(buffered.substr(start, newline - start));
+            start = newline + 1;
+        }
+        buffered.erase(0, start);
+
+        MUTEX_LOCK(orderBookMutex);
+        string ack = "ACK|" + to_string(standbyAppliedSeq) + "\n";
+        MUTEX_UNLOCK(orderBookMutex);
+        send(standbySocket, ack.c_str(), ack.length(), MSG_NOSIGNAL);
+    }
+
+    close(standbySocket);
+    failoverDetectedNs = getNanos();
+
+    stringstream report;
+    report << "Primary kaybı (" << reason << "), son mesajdan " << fixed << setprecision(1)
+           << (failoverDetectedNs - lastMessageNs) / 1000000.0 << " ms sonra algılandı";
+    failoverReport = report.str();
+    cout << "[" << getTimestamp() << "] " << failoverReport << ", primary rolü devralınıyor" << endl;
+
+    MUTEX_LOCK(orderBookMutex);
+    replicationRole = "none";
+    MUTEX_UNLOCK(orderBookMutex);
+}
+
+void displayReplication(ostream& out) {
+    out << "\n=== REPLİKASYON ===" << endl;
+    if (replicationRole == "primary") {
+        out << replication.status();
+    } else if (replicationRole == "standby") {
+        MUTEX_LOCK(orderBookMutex);
+        out << "Rol: standby" << endl;
+        out << "Uygulanan seq: " << standbyAppliedSeq << endl;
+        out << "Replikasyon gecikmesi (primary->uygulama): " << standbyLag.summary() << endl;
+        out << "İşlem doğrulama: " << standbyFillChecks << " kontrol, " 
+            << standbyFillMismatches << " uyuşmazlık" << endl;
+        MUTEX_UNLOCK(orderBookMutex);
+    } else {
+        out << "Replikasyon kapalı" << endl;
+    }
+    if (!failoverReport.empty()) {
+        out << "Son failover: " << failoverReport << endl;
+    }
+    out << "===================" << endl;
+}
+
+bool cancelOnDisconnect = false;
+
+void cancelOrdersOnDisconnect(int clientId) {
+    if (!cancelOnDisconnect || replicationRole == "standby") return;
+    
+    int cancelled = cancelClientOrders(clientId);
+    if (cancelled > 0) {
+        cout << "[" << getTimestamp() << "] Client #" << clientId << " bağlantısı koptu, " 
+             << cancelled << " bekleyen emri iptal edildi" << endl;
+        saveOrderBook();
+    }
+}
+
+int processStopOrder(Order& order, const string& msg) {
+    int risk;
+    uint64_t seq = restStopOrder(order, &risk);
+    if (risk != RISK_OK) return risk;
+    
+    ofstream orderFile("server_orders.log", ios::app);
+    if (orderFile.is_open()) {
+        orderFile << getDateStamp() << " " << getTimestamp() 
+                << "|Client#" << order.clientId << "|" << msg << endl;
+        orderFile.close();
+    }
+    
+    cout << "[" << getTimestamp() << "] STOP EMRİ - Client #" << order.clientId 
+        << ": " << order.stockSymbol << " " << order.type << " tetik " 
+        << order.triggerPrice << " TL";
+    if (!order.stopMarket) cout << ", limit " << order.price << " TL";
+    cout << " x " << order.quantity << " adet" << endl;
+    
+    saveOrderBook();
+    if (seq > 0) {
+        replication.waitAck(seq);
+    }
+    return RISK_OK;
+}
+
+void printStop(const string& side, const Order& order) {
+    cout << "  " << side << " tetik " << fixed << setprecision(2) << order.triggerPrice << " -> ";
+    if (order.stopMarket) {
+        cout << "piyasa";
+    } else {
+        cout << order.price << " TL";
+    }
+    cout << " x " << order.remainingQuantity << " (" << order.orderId << ")" << endl;
+}
+
+void displayStops(ostream& out) {
+    out << "\n=== BEKLEYEN STOP EMİRLERİ ===" << endl;
+    MUTEX_LOCK(orderBookMutex);
+    for (map<string, OrderBook>::const_iterator it = orderBooks.begin(); it != orderBooks.end(); ++it) {
+        const OrderBook& book = it->second;
+        if (book.buyStops.empty() && book.sellStops.empty()) continue;
+        
+        out << it->first << " (son fiyat " << fixed << setprecision(2) << book.lastPrice << "):" << endl;
+        for (multimap<double, Order>::const_iterator s = book.buyStops.begin(); s != book.buyStops.end(); ++s) {
+            printStop("ALIŞ ", s->second);
+        }
+        for (multimap<double, Order, greater<double> >::const_iterator s = book.sellStops.begin(); 
+             s != book.sellStops.end(); ++s) {
+            printStop("SATIŞ", s->second);
+        }
+    }
+    MUTEX_UNLOCK(orderBookMutex);
+}
+
+void displayPositions(ostream& out, const string& filter) {
+    MUTEX_LOCK(orderBookMutex);
+    vector<int> ids;
+    if (filter.empty()) {
+        ids = positions.clients();
+    } else {
+        ids.push_back(atoi(filter.c_str()));
+    }
+    
+    out << "\n=== POZİSYONLAR ===" << endl;
+    out << left << setw(10) << "Client" << setw(8) << "Sembol" << right << setw(10) << "Adet"
+        << setw(12) << "Ort.Maliyet" << setw(10) << "Son" << setw(14) << "Gerçekleşen"
+        << setw(14) << "Açık K/Z" << setw(16) << "İşlem Tutarı" << endl;
+    out << string(94, '-') << endl;
+    
+    double totalRealized = 0, totalUnrealized = 0;
+    for (size_t i = 0; i < ids.size(); i++) {
+        vector<Position> held = positions.positionsOf(ids[i]);
+        for (size_t j = 0; j < held.size(); j++) {
+            const Position& position = held[j];
+            double mark = orderBooks[position.symbol].lastPrice;
+            double unrealized = position.unrealizedPnl(mark);
+            totalRealized += position.realizedPnl;
+            totalUnrealized += unrealized;
+            out << left << setw(10) << ("#" + to_string(ids[i])) << setw(8) << position.symbol << right 
+                << setw(10) << position.quantity << fixed << setprecision(2) << setw(12) << position.averageCost 
+                << setw(10) << mark << setw(14) << position.realizedPnl << setw(14) << unrealized 
+                << setw(16) << position.notional << endl;
+        }
+    }
+    MUTEX_UNLOCK(orderBookMutex);
+    
+    out << string(94, '-') << endl;
+    out << "Toplam gerçekleşen K/Z: " << fixed << setprecision(2) << totalRealized 
+        << " TL, açık K/Z: " << totalUnrealized << " TL" << endl;
+}
+
+// Oturumu açar veya sürdürür; sürdürülen oturumun client numarası döner. Kaçırılan
+// mesajlar yeni bağlantıya kilit altında gönderilir, böylece araya yeni mesaj girmez.
+// Token tutmazsa oturum reddedilir ve bağlantı kendi numarasıyla oturumsuz devam eder.
+int resumeSession(const string& key, const string& token, int connectionId, int clientSocket, uint64_t lastSeq) {
+    MUTEX_LOCK(clientSocketMutex);
+    bool resumed;
+    int previousSocket;
+    ClientSession* session = sessions.attach(key, token, connectionId, clientSocket, resumed, previousSocket);
+    if (session == NULL) {
+        sendToClient(clientSocket, "OTURUM_RED|Oturum dogrulanamadi");
+        MUTEX_UNLOCK(clientSocketMutex);
+        cout << "[" << getTimestamp() << "] Bağlantı #" << connectionId
+             << " doğrulanamayan bir oturumu sürdürmek istedi, reddedildi" << endl;
+        return connectionId;
+    }
+    int clientId = session->clientId;
+    if (resumed) {
+        clientSockets.erase(connectionId);
+        clientSockets[clientId] = clientSocket;
+    } else if (replicationRole == "primary") {
+        replication.publish("SESSION|" + sessions.record(*session));
+    }
+    if (previousSocket >= 0) {
+        shutdown(previousSocket, SHUT_RDWR);
+    }
+    
+    vector<string> missed;
+    bool complete = sessions.replaySince(*session, lastSeq, missed);
+    sendToClient(clientSocket, "OTURUM_OK|" + to_string(clientId) + "|" + to_string(session->lastSeq)
+                               + "|" + session->token);
+    if (!complete) {
+        sendToClient(clientSocket, "OTURUM_BOSLUK|" + to_string(sessions.firstAvailable(*session)));
+    }
+    for (size_t i = 0; i < missed.size(); i++) {
+        sendToClient(clientSocket, missed[i]);
+    }
+    MUTEX_UNLOCK(clientSocketMutex);
+    
+    if (resumed) {
+        cout << "[" << getTimestamp() << "] Client #" << clientId << " oturumu sürdürüldü (bağlantı #"
+             << connectionId << ", " << missed.size() << " mesaj yeniden gönderildi)" << endl;
+    }
+    return clientId;
+}
+
+bool claimOrderReference(int clientId, const string& reference) {
+    MUTEX_LOCK(clientSocketMutex);
+    ClientSession* session = sessions.find(clientId);
+    bool fresh = session == NULL || sessions.claimReference(*session, reference);
+    MUTEX_UNLOCK(clientSocketMutex);
+    return fresh;
+}
+
+// Bağlantısı kopan oturumlu client'ın emirleri yeniden bağlanma süresi dolunca iptal edilir.
+void* sessionSweeper(void*) {
+    while (serverRunning) {
+        sleep(1);
+        
+        MUTEX_LOCK(clientSocketMutex);
+        vector<int> abandoned = sessions.abandoned(time(0), sessionResumeGrace);
+        MUTEX_UNLOCK(clientSocketMutex);
+        
+        for (size_t i = 0; i < abandoned.size(); i++) {
+            cancelOrdersOnDisconnect(abandoned[i]);
+        }
+    }
+    return NULL;
+}
+
+// Emir işleme süresince tutulur; boşaltma başladıysa emir alınmaz.
+class OrderAdmission {
+private:
+    bool admitted;
+
+    OrderAdmission(const OrderAdmission&);
+    OrderAdmission& operator=(const OrderAdmission&);
+
+public:
+    OrderAdmission() : admitted(true) {
+        ordersInFlight.fetch_add(1);
+        if (draining.load()) {
+            ordersInFlight.fetch_sub(1);
+            admitted = false;
+        }
+    }
+
+    ~OrderAdmission() {
+        if (admitted) ordersInFlight.fetch_sub(1);
+    }
+
+    bool accepted() const {
+        return admitted;
+    }
+};
+
+// STOP|SYM|AL/SAT|tetik|miktar[|geçerlilik] veya STOPLIMIT|SYM|AL/SAT|tetik|limit|miktar[|geçerlilik].
+// Doğrudan bağlantı ve gateway oturumları için ortaktır; client'a gidecek yanıtı döner.
+string submitStopOrder(int clientId, int clientSocket, const string& msg) {
+    stringstream ss(msg);
+    string cmd, symbol, type, triggerStr, limitStr, quantityStr, tifStr;
+    getline(ss, cmd, '|');
+    getline(ss, symbol, '|');
+    getline(ss, type, '|');
+    getline(ss, triggerStr, '|');
+    if (cmd == "STOPLIMIT") getline(ss, limitStr, '|');
+    getline(ss, quantityStr, '|');
+    getline(ss, tifStr, '|');
+
+    double triggerPrice = atof(triggerStr.c_str());
+    int quantity = atoi(quantityStr.c_str());
+    OrderAdmission admission;
+    if (!admission.accepted()) {
+        return "EMIR REDDEDILDI|Server kapaniyor";
+    }
+
+    if ((type != "AL" && type != "SAT") || triggerPrice <= 0 || quantity <= 0) {
+        return "EMIR REDDEDILDI|Gecersiz stop emri";
+    }
+
+    bool banded = false;
+    pair<double, double> band;
+    {
+        RcuReadGuard<StockTable> table(stockTable);
+        map<string, pair<double, double> >::const_iterator limits = table->priceLimits.find(symbol);
+        if (limits != table->priceLimits.end()) {
+            banded = true;
+            band = limits->second;
+        }
+    }
+
+    double price = atof(limitStr.c_str());
+    if (cmd == "STOP") {
+        if (banded) {
+            price = type == "AL" ? band.first : band.second;
+        } else {
+            price = triggerPrice;
+        }
+    }
+
+    if (banded && (triggerPrice < band.second || triggerPrice > band.first
+                   || price < band.second || price > band.first)) {
+        return "EMIR REDDEDILDI|Fiyat limitinin disinda";
+    }
+
+    Order order;
+    order.orderId = generateOrderId();
+    order.clientId = clientId;
+    order.clientSocket = clientSocket;
+    order.stockSymbol = symbol;
+    order.type = type;
+    order.price = price;
+    order.quantity = quantity;
+    order.remainingQuantity = quantity;
+    order.status = "PENDING";
+    order.timestamp = getTimestamp();
+    order.triggerPrice = triggerPrice;
+    order.stopMarket = cmd == "STOP";
+
+    // Stop tetiklenene kadar bekler; anında geçerlilikler (IOC/FOK) anlamsızdır.
+    if (!applyTimeInForce(order, tifStr) || order.timeInForce == "IOC" || order.timeInForce == "FOK") {
+        return "EMIR REDDEDILDI|Gecersiz gecerlilik suresi";
+    }
+
+    int risk = processStopOrder(order, msg);
+    if (risk != RISK_OK) {
+        return string("EMIR REDDEDILDI|") + riskRejectText(risk);
+    }
+    return "STOP_ACCEPTED|" + order.orderId;
+}
+
+void* handleClient(void* arg) {
+    ClientData* clientData = (ClientData*)arg;
+    int clientSocket = clientData->socket;
+    int clientId = clientData->id;
+    
+    MUTEX_LOCK(clientSocketMutex);
+    clientSockets[clientId] = clientSocket;
+    MUTEX_UNLOCK(clientSocketMutex);
+    flightRecorder.record(FLIGHT_CONNECT, clientId, "", "", 0, 0, 0, "");
+    
+    ClientThrottle throttle;
+    throttles.attach(throttle, clientId, false);
+    
+    MUTEX_LOCK(clientCountMutex);
+    activeClients++;
+    cout << "[" << getTimestamp() << "] Client #" << clientId 
+         << " bağlandı (Aktif: " << activeClients << ")" << endl;
+    MUTEX_UNLOCK(clientCountMutex);
+    
+    string welcome = "Server'a hoş geldiniz (Client #" + to_string(clientId) + ")\n";
+    send(clientSocket, welcome.c_str(), welcome.length(), 0);
+    
+    LineReader reader;
+    string msg;
+    long long messageCount = 0;
+    bool quit = false;
+    char buffer[4096];
+    while (!quit) {
+        ssize_t bytesReceived = recv(clientSocket, buffer, sizeof(buffer), 0);
+        
+        if (bytesReceived <= 0 || !reader.append(buffer, bytesReceived)) {
+            break;
+        }
+        int64_t receivedNs = orderTracer.receiveStamp();
+        
+        while (reader.next(msg)) {
+            bool opening = messageCount++ == 0;
+            
+            if (msg == "quit") {
+                string goodbye = "Görüşmek üzere!\n";
+                send(clientSocket, goodbye.c_str(), goodbye.length(), 0);
+                quit = true;
+                break;
+            }
+            
+            // Yalnızca bağlantıyı açan oturum mesajı sınırdan muaftır; sonraki OTURUM
+            // satırları reddedilse de kovadan harcar.
+            bool resuming = msg.compare(0, 7, "OTURUM|") == 0;
+            int verdict = opening && resuming ? THROTTLE_PASS : throttle.admit(isOrderMessage(msg), true);
+            if (verdict != THROTTLE_PASS) {
+                if (isOrderMessage(msg)) {
+                    rejectedOrders.fetch_add(1, memory_order_relaxed);
+                    flightRecorder.record(FLIGHT_REJECT, clientId, "", "", 0, 0, 0, "Hiz limiti");
+                }
+                if (verdict == THROTTLE_DISCONNECT) {
+                    notifyClient(clientId, "HIZ_LIMITI|Baglanti kesildi");
+                    cout << "[" << getTimestamp() << "] Client #" << clientId 
+                         << " hız limitini art arda aştığı için bağlantısı kesildi" << endl;
+                    quit = true;
+                    break;
+                }
+                notifyClient(clientId, throttleReply(msg));
+                continue;
+            }
+            
+            if (resuming) {
+                // OTURUM|anahtar|son alınan seq|token: bağlantının ilk mesajı olmalıdır.
+                // Yeni oturumda token boştur, server OTURUM_OK ile verir.
+                stringstream ss(msg);
+                string cmd, key, seqStr, token;
+                getline(ss, cmd, '|');
+                getline(ss, key, '|');
+                getline(ss, seqStr, '|');
+                getline(ss, token, '|');
+                
+                if (!opening || key.empty() || key.length() > 64) {
+                    sendToClient(clientSocket, "OTURUM_RED|Oturum bağlantının ilk mesajında açılmalı");
+                    continue;
+                }
+                clientId = resumeSession(key, token, clientId, clientSocket, strtoull(seqStr.c_str(), NULL, 10));
+                throttles.attach(throttle, clientId, false);
+            } else if (msg.substr(0, 5) == "EMIR|") {
+                OrderTraceScope trace(receivedNs);
+                stringstream ss(msg);
+                string cmd, symbol, type, priceStr, quantityStr, tifStr, refStr;
+                getline(ss, cmd, '|');
+                getline(ss, symbol, '|');
+                getline(ss, type, '|');
+                getline(ss, priceStr, '|');
+                getline(ss, quantityStr, '|');
+                getline(ss, tifStr, '|');
+                getline(ss, refStr, '|');
+            
+                double price = atof(priceStr.c_str());
+                int quantity = atoi(quantityStr.c_str());
+                flightRecorder.record(FLIGHT_INGRESS, clientId, symbol, type, price, quantity, quantity, refStr);
+                // Ardışık gönderen client yanıtları kendi referansıyla eşleştirir; oturumda
+                // aynı referansla yeniden gönderilen emir ikinci kez işlenmez.
+                string ref = refStr.empty() ? "" : "|" + refStr;
+                OrderAdmission admission;
+                if (!admission.accepted()) {
+                    rejectedOrders.fetch_add(1, memory_order_relaxed);
+                    flightRecorder.record(FLIGHT_REJECT, clientId, symbol, type, price, quantity, quantity, "Kapaniyor");
+                    notifyClient(clientId, "EMIR REDDEDILDI|Server kapaniyor" + ref);
+                    continue;
+                }
+                // Yanıt normalde tampondan zaten gider; tampon devralmada veya taşmada
+                // kaybolduysa client emri bekleyenlerden bu bildirimle düşer.
+                if (!refStr.empty() && !claimOrderReference(clientId, refStr)) {
+                    notifyClient(clientId, "EMIR_TEKRAR|" + refStr);
+                    continue;
+                }
+
+                Order order;
+                order.orderId = generateOrderId();
+                order.clientId = clientId;
+                order.clientSocket = clientSocket;
+                order.stockSymbol = symbol;
+                order.type = type;
+                order.price = price;
+                order.quantity = quantity;
+                order.remainingQuantity = quantity;
+                order.status = "PENDING";
+                order.timestamp = getTimestamp();
+                order.reference = refStr;
+            
+                if (!applyTimeInForce(order, tifStr)) {
+                    rejectedOrders.fetch_add(1, memory_order_relaxed);
+                    flightRecorder.record(FLIGHT_REJECT, clientId, symbol, type, price, quantity, quantity,
+                                          "Gecerlilik " + tifStr);
+                    notifyClient(clientId, "EMIR REDDEDILDI|Gecersiz gecerlilik suresi" + ref);
+                    continue;
+                }
+            
+                int risk = processOrder(order, msg);
+                if (risk != RISK_OK) {
+                    rejectedOrders.fetch_add(1, memory_order_relaxed);
+                    flightRecorder.record(FLIGHT_REJECT, clientId, symbol, type, price, quantity, quantity,
+                                          riskRejectText(risk));
+                    notifyClient(clientId, string("EMIR REDDEDILDI|") + riskRejectText(risk) + ref);
+                    continue;
+                }
+                flightRecorder.record(FLIGHT_ACCEPT, clientId, symbol, type, price, quantity,
+                                      order.remainingQuantity, order.orderId);
+            
+                TraceSpan span("ORDER_ACCEPTED gönderimi");
+                notifyClient(clientId, "ORDER_ACCEPTED|" + order.orderId + ref);
+            } else if (msg.substr(0, 5) == "STOP|" || msg.substr(0, 10) == "STOPLIMIT|") {
+                notifyClient(clientId, submitStopOrder(clientId, clientSocket, msg));
+            } else if (msg.substr(0, 6) == "IPTAL|") {
+                string orderId = msg.substr(6);
+                if (!cancelOwnOrder(clientId, orderId)) {
+                    notifyClient(clientId, "IPTAL_RED|" + orderId + "|Emir bulunamadi");
+                }
+            } else if (msg == "EMIRLERIM" || msg == "POZISYON") {
+                vector<string> lines = msg == "EMIRLERIM" ? listClientOrders(clientId) : listClientPositions(clientId);
+                for (size_t i = 0; i < lines.size(); i++) {
+                    notifyClient(clientId, lines[i]);
+                }
+            } else if (msg.substr(0, 6) == "ABONE|") {
+                vector<string> symbols;
+                stringstream ss(msg.substr(6));
+                string symbol;
+                while (getline(ss, symbol, ',')) {
+                    if (!symbol.empty()) symbols.push_back(symbol);
+                }
+            
+                notifyClient(clientId, "ABONE_OK|" + msg.substr(6));
+                marketData.subscribe(clientSocket, symbols);
+            } else if (msg == "ABONE_IPTAL") {
+                marketData.unsubscribe(clientSocket);
+                notifyClient(clientId, "ABONE_IPTAL_OK");
+            } else {
+                notifyClient(clientId, "OK");
+            }
+        }
+    }
+    
+    // Oturum başka bir bağlantıyla sürdürüldüyse kayıtlar yeni bağlantınındır. Oturumlu
+    // client'ın emirleri yeniden bağlanma süresi dolunca iptal edilir.
+    MUTEX_LOCK(clientSocketMutex);
+    map<int, int>::iterator own = clientSockets.find(clientId);
+    if (own != clientSockets.end() && own->second == clientSocket) {
+        clientSockets.erase(own);
+    }
+    ClientSession* session = sessions.find(clientId);
+    if (session != NULL) {
+        sessions.detach(*session, clientSocket, time(0));
+    }
+    MUTEX_UNLOCK(clientSocketMutex);
+    
+    marketData.unsubscribe(clientSocket);
+    throttles.detach(throttle);
+    if (session == NULL) {
+        cancelOrdersOnDisconnect(clientId);
+    }
+
+    close(clientSocket);
+    flightRecorder.record(FLIGHT_DISCONNECT, clientId, "", "", 0, 0, 0, session != NULL ? "oturum" : "");
+    
+    MUTEX_LOCK(clientCountMutex);
+    activeClients--;
+    cout << "[" << getTimestamp() << "] Client #" << clientId 
+         << " ayrıldı (Aktif: " << activeClients << ")" << endl;
+    MUTEX_UNLOCK(clientCountMutex);
+    
+    delete clientData;
+    return NULL;
+}
+
+void handleGatewayMessage(GatewayLink* link, const GatewayMessage& message) {
+    GatewayRoute route;
+    route.gateway = link->index;
+    route.sessionId = message.sessionId;
+    
+    if (message.type == GW_SESSION_OPEN) {
+        int clientId = allocateClientId();
+        link->sessionClients[message.sessionId] = clientId;
+        
+        MUTEX_LOCK(clientSocketMutex);
+        gatewayRoutes[clientId] = route;
+        MUTEX_UNLOCK(clientSocketMutex);
+        flightRecorder.record(FLIGHT_CONNECT, clientId, "", "", 0, 0, 0, "gateway");
+        
+        ClientThrottle* throttle = new ClientThrottle();
+        throttles.attach(*throttle, clientId, true);
+        link->sessionThrottles[message.sessionId] = throttle;
+        
+        MUTEX_LOCK(clientCountMutex);
+        activeClients++;
+        cout << "[" << getTimestamp() << "] Client #" << clientId << " bağlandı (Gateway #" 
+             << link->index << ", Aktif: " << activeClients << ")" << endl;
+        MUTEX_UNLOCK(clientCountMutex);
+        
+        sendToGateway(route, "Server'a hoş geldiniz (Client #" + to_string(clientId) + ")");
+        return;
+    }
+    
+    map<int, int>::iterator session = link->sessionClients.find(message.sessionId);
+    if (session == link->sessionClients.end()) {
+        return;
+    }
+    int clientId = session->second;
+    
+    if (message.type == GW_SESSION_CLOSE) {
+        link->sessionClients.erase(session);
+        pthread_mutex_lock(&link->outboundMutex);
+        map<int, bool>::iterator overflowed = link->overflowed.find(message.sessionId);
+        if (overflowed != link->overflowed.end()) {
+            if (!overflowed->second) link->closesPending--;
+            link->overflowed.erase(overflowed);
+        }
+        pthread_mutex_unlock(&link->outboundMutex);
+        map<int, ClientThrottle*>::iterator throttle = link->sessionThrottles.find(message.sessionId);
+        if (throttle != link->sessionThrottles.end()) {
+            throttles.detach(*throttle->second);
+            delete throttle->second;
+            link->sessionThrottles.erase(throttle);
+        }
+        
+        MUTEX_LOCK(clientSocketMutex);
+        gatewayRoutes.erase(clientId);
+        MUTEX_UNLOCK(clientSocketMutex);
+        
+        cancelOrdersOnDisconnect(clientId);
+        flightRecorder.record(FLIGHT_DISCONNECT, clientId, "", "", 0, 0, 0, "gateway");
+        
+        MUTEX_LOCK(clientCountMutex);
+        activeClients--;
+        cout << "[" << getTimestamp() << "] Client #" << clientId 
+             << " ayrıldı (Aktif: " << activeClients << ")" << endl;
+        MUTEX_UNLOCK(clientCountMutex);
+        return;
+    }
+    
+    // Gateway oturumları bekletilemez: poller thread'i tüm oturumlara hizmet eder.
+    bool order = message.type == GW_NEW_ORDER || (message.type == GW_TEXT && isOrderMessage(message.text));
+    int verdict = link->sessionThrottles[message.sessionId]->admit(order, false);
+    if (verdict != THROTTLE_PASS) {
+        if (order) {
+            rejectedOrders.fetch_add(1, memory_order_relaxed);
+            flightRecorder.record(FLIGHT_REJECT, clientId, message.symbol, message.side, message.price,
+                                  message.quantity, message.quantity, "Hiz limiti");
         }
+        sendToGateway(route, order ? throttleReply(message.text) : "HIZ_LIMITI|" + string(message.text));
+        if (verdict == THROTTLE_DISCONNECT) {
+            sendToGateway(route, "HIZ_LIMITI|Baglanti kesildi");
+            closeGatewaySession(route);
+        }
+        return;
     }
     
-    pthread_mutex_unlock(&orderBookMutex);
-    saveOrderBook();
-}
-
-void addOrderToBook(const Order& order) {
-    if (order.remainingQuantity > 0) {
-        pthread_mutex_lock(&orderBookMutex);
-        
-        OrderBook& book = orderBooks[order.stockSymbol];
-        
-        if (order.type == "AL") {
-            deque<Order>::iterator it = book.buyOrders.begin();
-            while (it != book.buyOrders.end() && it->price > order.price) {
-                ++it;
+    if (message.type == GW_TEXT) {
+        string text = message.text;
+        vector<string> lines;
+        if (text == "EMIRLERIM") {
+            lines = listClientOrders(clientId);
+        } else if (text == "POZISYON") {
+            lines = listClientPositions(clientId);
+        } else if (text.compare(0, 5, "STOP|") == 0 || text.compare(0, 10, "STOPLIMIT|") == 0) {
+            lines.push_back(submitStopOrder(clientId, -1, text));
+        } else if (text.compare(0, 6, "IPTAL|") == 0) {
+            if (!cancelOwnOrder(clientId, text.substr(6))) {
+                lines.push_back("IPTAL_RED|" + text.substr(6) + "|Emir bulunamadi");
             }
-            book.buyOrders.insert(it, order);
         } else {
-            deque<Order>::iterator it = book.sellOrders.begin();
-            while (it != book.sellOrders.end() && it->price < order.price) {
-                ++it;
-            }
-            book.sellOrders.insert(it, order);
+            lines.push_back("HATA|Desteklenmiyor");
+        }
+        for (size_t i = 0; i < lines.size(); i++) {
+            sendToGateway(route, lines[i]);
+        }
+    } else if (message.type == GW_NEW_ORDER) {
+        OrderTraceScope trace(orderTracer.receiveStamp());
+        // Gateway emir satırını olduğu gibi iletir; 6. alan geçerlilik süresi, 7. alan client referansıdır.
+        stringstream fields(message.text);
+        string tifStr, refStr;
+        for (int i = 0; i < 6; i++) {
+            tifStr.clear();
+            getline(fields, tifStr, '|');
+        }
+        getline(fields, refStr, '|');
+        string ref = refStr.empty() ? "" : "|" + refStr;
+        flightRecorder.record(FLIGHT_INGRESS, clientId, message.symbol, message.side, message.price,
+                              message.quantity, message.quantity, refStr);
+        OrderAdmission admission;
+        if (!admission.accepted()) {
+            rejectedOrders.fetch_add(1, memory_order_relaxed);
+            flightRecorder.record(FLIGHT_REJECT, clientId, message.symbol, message.side, message.price,
+                                  message.quantity, message.quantity, "Kapaniyor");
+            sendToGateway(route, "EMIR REDDEDILDI|Server kapaniyor" + ref);
+            return;
         }
         
-        pthread_mutex_unlock(&orderBookMutex);
-        saveOrderBook();
+        Order order;
+        order.orderId = generateOrderId();
+        order.clientId = clientId;
+        order.clientSocket = -1;
+        order.stockSymbol = message.symbol;
+        order.type = message.side;
+        order.price = message.price;
+        order.quantity = message.quantity;
+        order.remainingQuantity = message.quantity;
+        order.status = "PENDING";
+        order.timestamp = getTimestamp();
+        
+        if (!applyTimeInForce(order, tifStr)) {
+            rejectedOrders.fetch_add(1, memory_order_relaxed);
+            flightRecorder.record(FLIGHT_REJECT, clientId, message.symbol, message.side, message.price,
+                                  message.quantity, message.quantity, "Gecerlilik " + tifStr);
+            sendToGateway(route, "EMIR REDDEDILDI|Gecersiz gecerlilik suresi" + ref);
+            return;
+        }
+        
+        int risk = processOrder(order, message.text);
+        if (risk != RISK_OK) {
+            rejectedOrders.fetch_add(1, memory_order_relaxed);
+            flightRecorder.record(FLIGHT_REJECT, clientId, message.symbol, message.side, message.price,
+                                  message.quantity, message.quantity, riskRejectText(risk));
+            sendToGateway(route, string("EMIR REDDEDILDI|") + riskRejectText(risk) + ref);
+            return;
+        }
+        flightRecorder.record(FLIGHT_ACCEPT, clientId, message.symbol, message.side, message.price,
+                              message.quantity, order.remainingQuantity, order.orderId);
+        TraceSpan span("ORDER_ACCEPTED gönderimi");
+        sendToGateway(route, "ORDER_ACCEPTED|" + order.orderId + ref);
     }
 }
 
-void displayOrderBook() {
-    if (pthread_mutex_trylock(&orderBookMutex) != 0) {
-        cout << "Order book şu anda güncelleniyior, lütfen bekleyin..." << endl;
-        return;
-    }
-    
-    cout << "\n=== ORDER BOOK DURUMU ===" << endl;
+void* gatewayPoller(void* arg) {
+    GatewayLink* link = (GatewayLink*)arg;
+    GatewayMessage message;
+    int idleSpins = 0;
     
-    try {
-        for (map<string, OrderBook>::const_iterator it = orderBooks.begin(); 
-             it != orderBooks.end(); ++it) {
-            const string& symbol = it->first;
-            const OrderBook& book = it->second;
-            
-            if (!book.buyOrders.empty() || !book.sellOrders.empty()) {
-                cout << "\n" << symbol << ":" << endl;
-                cout << "  ALIŞ EMİRLERİ:" << endl;
-                
-                int count = 0;
-                for (deque<Order>::const_iterator buyIt = book.buyOrders.begin(); 
-                     buyIt != book.buyOrders.end() && count < 5; ++buyIt, ++count) {
-                    cout << "    " << fixed << setprecision(2) << buyIt->price 
-                         << " TL x " << buyIt->remainingQuantity << " adet (Client#" 
-                         << buyIt->clientId << ")" << endl;
-                }
-                
-                cout << "  SATIŞ EMİRLERİ:" << endl;
-                count = 0;
-                for (deque<Order>::const_iterator sellIt = book.sellOrders.begin(); 
-                     sellIt != book.sellOrders.end() && count < 5; ++sellIt, ++count) {
-                    cout << "    " << fixed << setprecision(2) << sellIt->price 
-                         << " TL x " << sellIt->remainingQuantity << " adet (Client#" 
-                         << sellIt->clientId << ")" << endl;
-                }
+    while (serverRunning) {
+        flushGatewayCloses(link);
+        if (!link->inbound.pop(message)) {
+            if (++idleSpins > 1000) {
+                usleep(50);
             }
+            continue;
         }
-    } catch (...) {
-        pthread_mutex_unlock(&orderBookMutex);
-        throw;
+        idleSpins = 0;
+        handleGatewayMessage(link, message);
     }
-    
-    pthread_mutex_unlock(&orderBookMutex);
-    cout << string(50, '-') << endl;
+    return NULL;
 }
-    
 
-void displayTradeSummary() {
-    pthread_mutex_lock(&tradeMutex);
-    
-    cout << "\n=== GÜNÜN İŞLEMLERİ ===" << endl;
-    cout << string(80, '-') << endl;
-    
-    int todayTradeCount = 0;
-    double todayVolume = 0;
-    
-    for (vector<Trade>::const_iterator it = trades.begin(); it != trades.end(); ++it) {
-        todayTradeCount++;
-        todayVolume += it->price * it->quantity;
+bool startGateways(int count, const string& prefix, int capacity) {
+    for (int i = 0; i < count; i++) {
+        GatewayLink* link = new GatewayLink();
+        link->index = i;
+        link->dropped = 0;
+        link->closesPending = 0;
+        pthread_mutex_init(&link->outboundMutex, NULL);
+        
+        if (!link->inbound.create(gatewayInboundName(prefix, i), capacity) 
+            || !link->outbound.create(gatewayOutboundName(prefix, i), capacity)) {
+            cerr << "Gateway #" << i << " kuyrukları oluşturulamadı!" << endl;
+            delete link;
+            return false;
+        }
+        gatewayLinks.push_back(link);
         
-        cout << it->timestamp << " " << it->stockSymbol 
-             << " " << it->quantity << " adet @ " << fixed << setprecision(2) 
-             << it->price << " TL (Alıcı: Client#" << it->buyerClientId 
-             << ", Satıcı: Client#" << it->sellerClientId << ")" << endl;
+        pthread_t thread;
+        pthread_create(&thread, NULL, gatewayPoller, link);
+        pthread_detach(thread);
     }
-    
-    cout << string(80, '-') << endl;
-    cout << "Toplam İşlem: " << todayTradeCount << endl;
-    cout << "Toplam Hacim: " << fixed << setprecision(2) << todayVolume << " TL" << endl;
-    
-    pthread_mutex_unlock(&tradeMutex);
+    return true;
 }
 
-void displayServerOrders() {
-    ifstream file("server_orders.log");
-    if (!file.is_open()) {
-        cout << "\nEmir dosyası bulunamadı." << endl;
-        return;
+// Hisse tanımlarını yeniden okur ve yeni tabloyu yayınlar. Yeni semboller için kitap
+// ve snapshot yuvası hemen açılır; tanımdan çıkarılan sembollerin kitapları kalır,
+// yalnızca bant ve tick kontrolü kalkar. Dosya okunamazsa eski tablo korunur.
+bool reloadStockConfig(const string& filename) {
+    // Yarım kaydedilmiş veya bozuk dosyada ayrıştırıcı hata konumunu yazıp boş liste döner.
+    StockConfigParser parser;
+    vector<Stock> loaded = parser.loadStocks(filename);
+    if (loaded.empty()) {
+        cerr << "Hisse tanımları okunamadı (" << filename << "), mevcut tablo korunuyor." << endl;
+        bool empty;
+        {
+            RcuReadGuard<StockTable> table(stockTable);
+            empty = table.get() == NULL;
+        }
+        if (empty) stockTable.update(new StockTable);
+        return false;
     }
     
-    vector<string> orders;
-    string line;
-    while (getline(file, line)) {
-        orders.push_back(line);
+    StockTable* next = new StockTable;
+    next->stocks = loaded;
+    for (const Stock& stock : loaded) {
+        next->priceLimits[stock.symbol] = make_pair(stock.max, stock.min);
+    }
+    
+    vector<string> added, changed, removed;
+    bool initial;
+    {
+        RcuReadGuard<StockTable> table(stockTable);
+        initial = table.get() == NULL;
+        map<string, Stock> previous;
+        if (!initial) {
+            for (const Stock& stock : table->stocks) previous[stock.symbol] = stock;
+        }
+        for (const Stock& stock : loaded) {
+            map<string, Stock>::iterator old = previous.find(stock.symbol);
+            if (old == previous.end()) {
+                added.push_back(stock.symbol);
+                continue;
+            }
+            if (old->second.min != stock.min || old->second.max != stock.max 
+                || old->second.tick_size != stock.tick_size) {
+                changed.push_back(stock.symbol);
+            }
+            previous.erase(old);
+        }
+        for (map<string, Stock>::const_iterator it = previous.begin(); it != previous.end(); ++it) {
+            removed.push_back(it->first);
+        }
     }
-    file.close();
     
-    cout << "\n=== SON EMİRLER ===" << endl;
-    cout << string(80, '-') << endl;
+    // Okuyucular kitap kilidini RCU okuması içinde alabildiğinden değiştirme kilitsiz yapılır.
+    stockTable.update(next);
     
-    int count = min(20, (int)orders.size());
-    int start = orders.size() - count;
+    MUTEX_LOCK(orderBookMutex);
+    for (size_t i = 0; i < added.size(); i++) {
+        orderBooks[added[i]];
+        publishBookSnapshot(added[i]);
+    }
+    MUTEX_UNLOCK(orderBookMutex);
     
-    for (int i = start; i < (int)orders.size(); i++) {
-        stringstream ss(orders[i]);
-        string timestamp, client, orderData;
-        getline(ss, timestamp, '|');
-        getline(ss, client, '|');
-        getline(ss, orderData);
+    loadRiskLimits("config.ini");
+    
+    if (initial) return true;
+    
+    cout << "[" << getTimestamp() << "] Hisse tanımları yüklendi: " << loaded.size() << " sembol";
+    if (!added.empty() || !changed.empty() || !removed.empty()) {
+        cout << " (yeni " << added.size() << ", değişen " << changed.size() 
+             << ", çıkarılan " << removed.size() << ")";
+    }
+    cout << endl;
+    for (size_t i = 0; i < added.size(); i++) cout << "  + " << added[i] << endl;
+    for (size_t i = 0; i < changed.size(); i++) cout << "  * " << changed[i] << endl;
+    for (size_t i = 0; i < removed.size(); i++) cout << "  - " << removed[i] << endl;
+    return true;
+}
 
-        stringstream orderSS(orderData);
-        string cmd, symbol, type, price, quantity;
-        getline(orderSS, cmd, '|');
-        getline(orderSS, symbol, '|');
-        getline(orderSS, type, '|');
-        getline(orderSS, price, '|');
-        getline(orderSS, quantity, '|');
+// Dosyanın değişim zamanını izler; değişiklik görülünce tanımları yeniden yükler.
+void* stocksConfigWatcher(void* arg) {
+    int intervalSeconds = *(int*)arg;
+    delete (int*)arg;
+    
+    struct stat info;
+    time_t lastModified = stat(stocksConfigFile.c_str(), &info) == 0 ? info.st_mtime : 0;
+    while (serverRunning) {
+        sleep(intervalSeconds);
+        if (stat(stocksConfigFile.c_str(), &info) != 0 || info.st_mtime == lastModified) continue;
         
-        cout << timestamp << " " << client << " " 
-             << symbol << " " << type << " " 
-             << price << " TL x " << quantity << " adet" << endl;
+        lastModified = info.st_mtime;
+        reloadStockConfig(stocksConfigFile);
     }
-    cout << string(80, '-') << endl;
-    cout << "Toplam " << count << " emir gösteriliyor." << endl;
+    return NULL;
 }
 
-void displayDailySummary() {
-    ifstream file("server_orders.log");
-    if (!file.is_open()) {
-        cout << "\nEmir dosyası bulunamadı." << endl;
-        return;
+void displayLockProfile(ostream& out, bool reset) {
+#ifdef LOCK_PROFILING
+    ProfiledMutex* mutexes[] = { &orderBookMutex, &tradeMutex, &clientSocketMutex, &orderIdMutex, &clientCountMutex };
+    out << "\n=== KİLİT PROFİLİ ===" << endl;
+    for (size_t i = 0; i < sizeof(mutexes) / sizeof(mutexes[0]); i++) {
+        out << mutexes[i]->report(5);
+        if (reset) mutexes[i]->reset();
     }
-    
-    string today = getDateStamp();
-    int totalOrders = 0;
-    int buyOrders = 0;
-    int sellOrders = 0;
-    double totalVolume = 0;
-    map<string, int> stockCounts;
-    
-    string line;
-    while (getline(file, line)) {
-        if (line.find(today) != string::npos) {
-            totalOrders++;
-            
-            stringstream ss(line);
-            string timestamp, client, orderData;
-            getline(ss, timestamp, '|');
-            getline(ss, client, '|');
-            getline(ss, orderData);
-            
-            stringstream orderSS(orderData);
-            string cmd, symbol, type, priceStr, quantityStr;
-            getline(orderSS, cmd, '|');
-            getline(orderSS, symbol, '|');
-            getline(orderSS, type, '|');
-            getline(orderSS, priceStr, '|');
-            getline(orderSS, quantityStr, '|');
-            
-            if (type == "AL") buyOrders++;
-            else if (type == "SAT") sellOrders++;
-            
-            stockCounts[symbol]++;
-            
-            double price = atof(priceStr.c_str());
-            int quantity = atoi(quantityStr.c_str());
-            totalVolume += price * quantity;
+    if (reset) out << "(sayaçlar sıfırlandı)" << endl;
+    out << "=====================" << endl;
+#else
+    (void)reset;
+    out << "Kilit profili bu derlemede kapalı (g++ -DLOCK_PROFILING ile derleyin)." << endl;
+#endif
+}
+
+// Yeni emir ve bağlantıları durdurur, simülatörü kapatır, işlenmekte olan emirleri
+// bekleyip kitabı kaydeder. Tekrar çağrılabilir; bağlı client'lar açık kalır.
+void drainServer(ostream& out) {
+    if (!draining.exchange(true)) {
+        cout << "[" << getTimestamp() << "] Boşaltma başladı: yeni emir ve bağlantı alınmıyor" << endl;
+        
+        vector<int> clientIds;
+        MUTEX_LOCK(clientSocketMutex);
+        for (map<int, int>::const_iterator it = clientSockets.begin(); it != clientSockets.end(); ++it) {
+            clientIds.push_back(it->first);
+        }
+        for (map<int, GatewayRoute>::const_iterator it = gatewayRoutes.begin(); it != gatewayRoutes.end(); ++it) {
+            clientIds.push_back(it->first);
+        }
+        MUTEX_UNLOCK(clientSocketMutex);
+        for (size_t i = 0; i < clientIds.size(); i++) {
+            notifyClient(clientIds[i], "SERVER_KAPANIYOR");
         }
     }
-    file.close();
+    simulator.stop();
     
-    cout << "\n=== GÜNLÜK ÖZET (" << today << ") ===" << endl;
-    cout << string(50, '-') << endl;
-    cout << "Toplam Emir: " << totalOrders << endl;
-    cout << "Alış Emirleri: " << buyOrders << endl;
-    cout << "Satış Emirleri: " << sellOrders << endl;
-    cout << "Toplam İşlem Hacmi: " << fixed << setprecision(2) << totalVolume << " TL" << endl;
-    cout << "\nHisse Bazında Dağılım:" << endl;
+    int64_t started = getNanos();
+    while (ordersInFlight.load() > 0 && getNanos() - started < (int64_t)drainTimeoutMs * 1000000) {
+        usleep(1000);
+    }
+    int unfinished = ordersInFlight.load();
+    saveOrderBook();
     
-    for (map<string, int>::const_iterator it = stockCounts.begin(); 
-         it != stockCounts.end(); ++it) {
-        cout << "  " << it->first << ": " << it->second << " emir" << endl;
+    out << "Boşaltma: " << (unfinished == 0 ? "işlenen emir kalmadı" 
+                                            : to_string(unfinished) + " emir " + to_string(drainTimeoutMs) + " ms içinde bitmedi")
+        << ", " << openOrderCount.load() << " bekleyen emir kaydedildi." << endl;
+}
+
+// Kabul döngüsünü durdurur; main yönetim kanalındaki yanıtları bekleyip çıkar.
+void requestShutdown() {
+    serverRunning = false;
+    if (!acceptLoopRunning) {
+        exit(0);
     }
-    cout << string(50, '-') << endl;
+    shutdown(globalServerSocket, SHUT_RDWR);
 }
 
-void* handleClient(void* arg) {
-    ClientData* clientData = (ClientData*)arg;
-    int clientSocket = clientData->socket;
-    int clientId = clientData->id;
-    
-    pthread_mutex_lock(&clientSocketMutex);
-    clientSockets[clientId] = clientSocket;
-    pthread_mutex_unlock(&clientSocketMutex);
-    
-    pthread_mutex_lock(&clientCountMutex);
-    activeClients++;
-    cout << "[" << getTimestamp() << "] Client #" << clientId 
-         << " bağlandı (Aktif: " << activeClients << ")" << endl;
-    pthread_mutex_unlock(&clientCountMutex);
-    
-    string welcome = "Server'a hoş geldiniz (Client #" + to_string(clientId) + ")\n";
-    send(clientSocket, welcome.c_str(), welcome.length(), 0);
-    
-    char buffer[1024];
-    while (true) {
-        memset(buffer, 0, sizeof(buffer));
-        
-        ssize_t bytesReceived = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
-        
-        if (bytesReceived <= 0) {
-            break;
+void showHelp(ostream& out) {
+    out << "\n=== SERVER KOMUTLARI ===" << endl;
+    out << "  emirler  - Son emirleri göster" << endl;
+    out << "  ozet     - Günlük özet raporu" << endl;
+    out << "  aktif    - Aktif client sayısı" << endl;
+    out << "  temizle  - Ekranı temizle" << endl;
+    out << "  bekleyen - Order book durumu (alış/satış emirleri)" << endl;
+    out << "  stoplar  - Tetiklenmemiş stop emirleri" << endl;
+    out << "  islemler - Günün gerçekleşen işlemlerini göster" << endl;
+    out << "  mum SYM  - Hissenin son mum çubukları (OHLC/VWAP)" << endl;
+    out << "  pozisyon [ID] - Client pozisyonları ve K/Z" << endl;
+    out << "  risk [yenile] - Risk limitleri ve red sayaçları" << endl;
+    out << "  hiz [yenile]  - Client sınıflarının hız limitleri ve aşım sayaçları" << endl;
+    out << "  yenile   - Hisse tanımlarını (stocks_config.json) yeniden yükle" << endl;
+    out << "  replikasyon - Yedek sunucu durumu ve gecikmeleri" << endl;
+    out << "  sim [baslat [hiz]|durdur|hiz N] - Sentetik trader simülatörü" << endl;
+    out << "  muzayede [ac|kapat SYM|hepsi] - Açılış/kapanış müzayedesi" << endl;
+    out << "  kilitler [sifirla] - Global kilitlerin bekleme/tutma istatistikleri" << endl;
+    out << "  iz [baslat [N]|durdur [dosya]] - Her N. emrin aşama izi (Chrome/Perfetto JSON)" << endl;
+    out << "  karakutu [dosya] - Thread'lerin son olaylarını uçuş kaydı dosyasına dök" << endl;
+    out << "  bosalt   - Yeni emir/bağlantı almayı durdur, bekleyen işleri bitir" << endl;
+    out << "  cikis    - Boşaltıp Server'ı kapat" << endl;
+    out << "========================" << endl;
+}
+
+// Konsoldan ve yönetim kanalından gelen komutlar; çıktı out'a yazılır.
+void runCommand(const string& command, ostream& out) {
+    if (command == "emirler") {
+        displayServerOrders(out);
+    } else if (command == "ozet") {
+        displayDailySummary(out);
+    } else if (command == "aktif") {
+        MUTEX_LOCK(clientCountMutex);
+        out << "\nAktif client sayısı: " << activeClients << endl;
+        MUTEX_UNLOCK(clientCountMutex);
+    } else if (command == "temizle") {
+        system("clear");
+    } else if (command == "bekleyen") {
+        displayOrderBook(out);
+    } else if (command == "stoplar") {
+        displayStops(out);
+    } else if (command == "islemler") {
+        displayTradeSummary(out);
+    } else if (command.substr(0, 4) == "mum ") {
+        displayCandles(out, command.substr(4));
+    } else if (command == "yenile") {
+        reloadStockConfig(stocksConfigFile);
+    } else if (command == "risk" || command == "risk yenile") {
+        if (command == "risk yenile") {
+            loadRiskLimits("config.ini");
+            out << "Risk limitleri config.ini'den yeniden yüklendi." << endl;
+        }
+        MUTEX_LOCK(orderBookMutex);
+        string status = riskEngine.status();
+        MUTEX_UNLOCK(orderBookMutex);
+        out << "\n=== RİSK ===" << endl << status << "============" << endl;
+    } else if (command == "hiz" || command == "hiz yenile") {
+        if (command == "hiz yenile") {
+            loadThrottleLimits("config.ini");
+            out << "Hız limitleri config.ini'den yeniden yüklendi (yeni bağlantılarda geçerli)." << endl;
         }
+        out << "\n=== HIZ LİMİTLERİ ===" << endl << throttles.status(10) << "=====================" << endl;
+    } else if (command.substr(0, 8) == "pozisyon") {
+        stringstream args(command.substr(8));
+        string clientId;
+        args >> clientId;
+        displayPositions(out, clientId);
+    } else if (command.substr(0, 3) == "sim" && (command.size() == 3 || command[3] == ' ')) {
+        stringstream args(command.substr(3));
+        string action;
+        long long rate = 0;
+        args >> action >> rate;
         
-        buffer[bytesReceived] = '\0';
-
-        for (int i = bytesReceived - 1; i >= 0; i--) {
-            if (buffer[i] == '\n' || buffer[i] == '\r') {
-                buffer[i] = '\0';
+        if (action == "baslat") {
+            if (replicationRole == "standby") {
+                out << "Yedek sunucuda simülatör başlatılamaz." << endl;
+            } else if (draining.load()) {
+                out << "Boşaltma sırasında simülatör başlatılamaz." << endl;
+            } else if (startSimulator(rate)) {
+                out << "Simülatör başlatıldı." << endl;
             } else {
-                break;
+                out << "Simülatör zaten çalışıyor." << endl;
             }
+        } else if (action == "durdur") {
+            simulator.stop();
+            saveOrderBook();
+            out << "Simülatör durduruldu." << endl;
+        } else if (action == "hiz") {
+            simulator.setRate(rate);
+            out << "Hedef hız: " << (rate > 0 ? to_string(rate) + " emir/sn" : "sınırsız") << endl;
         }
+        out << "\n=== SİMÜLATÖR ===" << endl;
+        out << simulator.status();
+        out << "=================" << endl;
+    } else if (command.substr(0, 8) == "muzayede") {
+        stringstream args(command.substr(8));
+        string action, target;
+        args >> action >> target;
+        vector<string> symbols = auctionSymbols(target);
         
-        if (strcmp(buffer, "quit") == 0) {
-            string goodbye = "Görüşmek üzere!\n";
-            send(clientSocket, goodbye.c_str(), goodbye.length(), 0);
-            break;
+        if (replicationRole == "standby" && !action.empty()) {
+            out << "Yedek sunucuda müzayede yönetilemez." << endl;
+        } else if (action == "ac") {
+            for (size_t i = 0; i < symbols.size(); i++) openAuction(symbols[i]);
+        } else if (action == "kapat") {
+            for (size_t i = 0; i < symbols.size(); i++) closeAuction(symbols[i]);
         }
+        displayAuctions(out);
+    } else if (command.substr(0, 2) == "iz" && (command.size() == 2 || command[2] == ' ')) {
+        stringstream args(command.substr(2));
+        string action, file;
+        args >> action >> file;
         
-        string msg(buffer);
+        if (action == "baslat") {
+            int every = atoi(file.c_str());
+            orderTracer.start(every);
+            out << "Emir izi açık (her " << orderTracer.sampling() << ". emir)." << endl;
+        } else if (action == "durdur") {
+            orderTracer.stop();
+            if (file.empty()) file = "order_trace_" + getDateStamp() + ".json";
+            size_t spans = orderTracer.writeJson(file);
+            out << "Emir izi kapatıldı: " << orderTracer.sampledCount() << " emir, " << spans 
+                << " aralık " << file << " dosyasına yazıldı (chrome://tracing veya ui.perfetto.dev)." << endl;
+        } else {
+            out << "Emir izi " << (orderTracer.running() ? "açık" : "kapalı") << ", her " 
+                << orderTracer.sampling() << ". emir, izlenen " << orderTracer.sampledCount() << " emir" << endl;
+        }
+        if (orderTracer.droppedCount() > 0) {
+            out << "Tampon dolduğu için düşen aralık: " << orderTracer.droppedCount() << endl;
+        }
+    } else if (command.substr(0, 8) == "karakutu" && (command.size() == 8 || command[8] == ' ')) {
+        stringstream args(command.substr(8));
+        string file;
+        args >> file;
+        if (file.empty()) file = flightRecorder.signalDumpPath();
         
-        if (msg.substr(0, 5) == "EMIR|") {
-            stringstream ss(msg);
-            string cmd, symbol, type, priceStr, quantityStr;
-            getline(ss, cmd, '|');
-            getline(ss, symbol, '|');
-            getline(ss, type, '|');
-            getline(ss, priceStr, '|');
-            getline(ss, quantityStr, '|');
-            
-            double price = atof(priceStr.c_str());
-            int quantity = atoi(quantityStr.c_str());
-
-            if (stockPriceLimits.find(symbol) != stockPriceLimits.end()) {
-             pair<double, double> limits = stockPriceLimits[symbol];
-            if (price < limits.second || price > limits.first) {
-              string response = "EMIR REDDEDILDI|Fiyat limitinin disinda\n";
-              send(clientSocket, response.c_str(), response.length(), 0);
-             continue;
-             }
+        if (!flightRecorder.enabled()) {
+            out << "Uçuş kaydı kapalı ([flight] records_per_thread=0)." << endl;
+        } else {
+            long records = flightRecorder.dump(file.c_str(), 0);
+            if (records < 0) {
+                out << "Uçuş kaydı yazılamadı: " << file << endl;
+            } else {
+                out << "Uçuş kaydı: " << flightRecorder.threadCount() << " thread, " << records 
+                    << " olay " << file << " dosyasına yazıldı (./flight_decode " << file << ")." << endl;
+            }
+        }
+    } else if (command == "kilitler" || command == "kilitler sifirla") {
+        displayLockProfile(out, command == "kilitler sifirla");
+    } else if (command == "replikasyon") {
+        displayReplication(out);
+    } else if (command == "yardim") {
+        showHelp(out);
+    } else if (command == "bosalt") {
+        drainServer(out);
+    } else if (command == "cikis") {
+        out << "\nServer kapatılıyor..." << endl;
+        drainServer(out);
+        requestShutdown();
+    } else if (!command.empty()) {
+        out << "Bilinmeyen komut. 'yardim' yazarak komutları görebilirsiniz." << endl;
+    }
 }
-            
-            Order order;
-            order.orderId = generateOrderId();
-            order.clientId = clientId;
-            order.clientSocket = clientSocket;
-            order.stockSymbol = symbol;
-            order.type = type;
-            order.price = price;
-            order.quantity = quantity;
-            order.remainingQuantity = quantity;
-            order.status = "PENDING";
-            order.timestamp = getTimestamp();
-            
-            ofstream orderFile("server_orders.log", ios::app);
-            if (orderFile.is_open()) {
-                orderFile << getDateStamp() << " " << getTimestamp() 
-                        << "|Client#" << clientId << "|" << msg << endl;
-                orderFile.close();
+
+// Yönetim kanalının makine okunur komutları kitap snapshot'larından ve atomik
+// sayaçlardan cevaplanır, eşleştirme kilitlerine dokunmaz. Diğer satırlar konsol komutudur.
+//   ISTATISTIK            -> ISTATISTIK|anahtar=deger|...
+//   DEFTER|SYM[|derinlik] -> DEFTER|SYM|surum|zaman_ns, ardından ALIS|fiyat|adet|emir ve SATIS|... satırları
+//   DEFTERLER             -> her sembol için UST|SYM|alis|adet|satis|adet|surum
+string handleAdminCommand(const string& command) {
+    ostringstream out;
+    
+    if (command == "ISTATISTIK") {
+        MUTEX_LOCK(clientCountMutex);
+        int clients = activeClients;
+        int connections = nextClientId - 1;
+        MUTEX_UNLOCK(clientCountMutex);
+        
+        int64_t now = getNanos();
+        out << "ISTATISTIK|zaman_ns=" << now 
+            << "|calisma_sn=" << (now - serverStartNs) / 1000000000LL
+            << "|aktif_client=" << clients
+            << "|toplam_baglanti=" << connections
+            << "|emir_kabul=" << acceptedOrders.load()
+            << "|emir_red=" << rejectedOrders.load()
+            << "|bekleyen_emir=" << openOrderCount.load()
+            << "|islem=" << executedTrades.load()
+            << "|islem_adet=" << tradedQuantity.load()
+            << "|islenen_emir=" << ordersInFlight.load()
+            << "|bosaltma=" << (draining.load() ? 1 : 0)
+            << "|hiz_red=" << throttles.totals().rejected.load()
+            << "|hiz_bekletme=" << throttles.totals().delayed.load()
+            << "|hiz_kesilen=" << throttles.totals().disconnects.load()
+            << "|sembol=" << bookSnapshots.count()
+            << "|rol=" << replicationRole << endl;
+        return out.str();
+    }
+    
+    bool allBooks = command == "DEFTERLER";
+    if (allBooks || command.substr(0, 7) == "DEFTER|") {
+        stringstream args(allBooks ? "" : command.substr(7));
+        string symbol, depthStr;
+        getline(args, symbol, '|');
+        getline(args, depthStr, '|');
+        int depth = depthStr.empty() ? 5 : atoi(depthStr.c_str());
+        
+        bool found = false;
+        BookSnapshot snapshot;
+        out << fixed << setprecision(2);
+        for (int slot = 0; slot < bookSnapshots.count(); slot++) {
+            if (!bookSnapshots.read(slot, snapshot)) continue;
+            if (allBooks) {
+                out << "UST|" << snapshot.symbol << "|" 
+                    << (snapshot.bidCount > 0 ? snapshot.bids[0].price : 0) << "|" 
+                    << (snapshot.bidCount > 0 ? snapshot.bids[0].quantity : 0) << "|" 
+                    << (snapshot.askCount > 0 ? snapshot.asks[0].price : 0) << "|" 
+                    << (snapshot.askCount > 0 ? snapshot.asks[0].quantity : 0) << "|" 
+                    << snapshot.version << endl;
+                continue;
             }
+            if (symbol != snapshot.symbol) continue;
             
-            cout << "[" << getTimestamp() << "] EMİR - Client #" << clientId 
-                << ": " << symbol << " " << type << " " 
-                << price << " TL x " << quantity << " adet" << endl;
-            
-            pthread_mutex_lock(&orderBookMutex);
-            
-            OrderBook& book = orderBooks[symbol];
-            
-            if (order.type == "AL") {
-                while (!book.sellOrders.empty() && order.remainingQuantity > 0) {
-                    Order& sellOrder = book.sellOrders.front();
-                    
-                    if (order.price >= sellOrder.price) {
-                        int tradeQuantity = min(order.remainingQuantity, sellOrder.remainingQuantity);
-                        double tradePrice = sellOrder.price;
-                        
-                        Trade trade;
-                        trade.tradeId = generateTradeId();
-                        trade.buyOrderId = order.orderId;
-                        trade.sellOrderId = sellOrder.orderId;
-                        trade.buyerClientId = order.clientId;
-                        trade.sellerClientId = sellOrder.clientId;
-                        trade.stockSymbol = symbol;
-                        trade.price = tradePrice;
-                        trade.quantity = tradeQuantity;
-                        trade.timestamp = getTimestamp();
-                        
-                        pthread_mutex_lock(&tradeMutex);
-                        trades.push_back(trade);
-                        pthread_mutex_unlock(&tradeMutex);
-                        
-                        order.remainingQuantity -= tradeQuantity;
-                        sellOrder.remainingQuantity -= tradeQuantity;
-                        
-                        pthread_mutex_lock(&clientSocketMutex);
-                        
-                        if (clientSockets.find(order.clientId) != clientSockets.end()) {
-                            stringstream buyMsg;
-                            buyMsg << "TRADE|" << trade.tradeId << "|ALIM|" 
-                                  << symbol << "|" << fixed << setprecision(2) << tradePrice 
-                                  << "|" << tradeQuantity << "|" << order.orderId;
-                            sendToClient(clientSockets[order.clientId], buyMsg.str());
-                        }
-                        
-                        if (clientSockets.find(sellOrder.clientId) != clientSockets.end()) {
-                            stringstream sellMsg;
-                            sellMsg << "TRADE|" << trade.tradeId << "|SATIM|" 
-                                   << symbol << "|" << fixed << setprecision(2) << tradePrice 
-                                   << "|" << tradeQuantity << "|" << sellOrder.orderId;
-                            sendToClient(clientSockets[sellOrder.clientId], sellMsg.str());
-                        }
-                        
-                        pthread_mutex_unlock(&clientSocketMutex);
-                        
-                        cout << "[" << getTimestamp() << "] İŞLEM - " << symbol 
-                             << " " << tradeQuantity << " adet @ " << fixed << setprecision(2) 
-                             << tradePrice << " TL (Alıcı: Client#" << order.clientId 
-                             << ", Satıcı: Client#" << sellOrder.clientId << ")" << endl;
-                        
-                        ofstream tradeFile("trades.log", ios::app);
-                        if (tradeFile.is_open()) {
-                            tradeFile << getDateStamp() << " " << getTimestamp() 
-                                     << "|" << trade.tradeId << "|" << symbol 
-                                     << "|" << tradePrice << "|" << tradeQuantity
-                                     << "|Client#" << order.clientId << "|Client#" << sellOrder.clientId << endl;
-                            tradeFile.close();
-                        }
-                        
-                        if (sellOrder.remainingQuantity == 0) {
-                            book.sellOrders.pop_front();
-                        }
-                    } else {
-                        break;
-                    }
-                }
-            } else {
-                while (!book.buyOrders.empty() && order.remainingQuantity > 0) {
-                    Order& buyOrder = book.buyOrders.front();
-                    
-                    if (buyOrder.price >= order.price) {
-                        int tradeQuantity = min(order.remainingQuantity, buyOrder.remainingQuantity);
-                        double tradePrice = order.price;
-                        
-                        Trade trade;
-                        trade.tradeId = generateTradeId();
-                        trade.buyOrderId = buyOrder.orderId;
-                        trade.sellOrderId = order.orderId;
-                        trade.buyerClientId = buyOrder.clientId;
-                        trade.sellerClientId = order.clientId;
-                        trade.stockSymbol = symbol;
-                        trade.price = tradePrice;
-                        trade.quantity = tradeQuantity;
-                        trade.timestamp = getTimestamp();
-                        
-                        pthread_mutex_lock(&tradeMutex);
-                        trades.push_back(trade);
-                        pthread_mutex_unlock(&tradeMutex);
-                        
-                        order.remainingQuantity -= tradeQuantity;
-                        buyOrder.remainingQuantity -= tradeQuantity;
-                        
-                        pthread_mutex_lock(&clientSocketMutex);
-                        
-                        if (clientSockets.find(buyOrder.clientId) != clientSockets.end()) {
-                            stringstream buyMsg;
-                            buyMsg << "TRADE|" << trade.tradeId << "|ALIM|" 
-                                  << symbol << "|" << fixed << setprecision(2) << tradePrice 
-                                  << "|" << tradeQuantity << "|" << buyOrder.orderId;
-                            sendToClient(clientSockets[buyOrder.clientId], buyMsg.str());
-                        }
-                        
-                        if (clientSockets.find(order.clientId) != clientSockets.end()) {
-                            stringstream sellMsg;
-                            sellMsg << "TRADE|" << trade.tradeId << "|SATIM|" 
-                                   << symbol << "|" << fixed << setprecision(2) << tradePrice 
-                                   << "|" << tradeQuantity << "|" << order.orderId;
-                            sendToClient(clientSockets[order.clientId], sellMsg.str());
-                        }
-                        
-                        pthread_mutex_unlock(&clientSocketMutex);
-                        
-                        cout << "[" << getTimestamp() << "] İŞLEM - " << symbol 
-                             << " " << tradeQuantity << " adet @ " << fixed << setprecision(2) 
-                             << tradePrice << " TL (Alıcı: Client#" << buyOrder.clientId 
-                             << ", Satıcı: Client#" << order.clientId << ")" << endl;
-                        
-                        ofstream tradeFile("trades.log", ios::app);
-                        if (tradeFile.is_open()) {
-                            tradeFile << getDateStamp() << " " << getTimestamp() 
-                                     << "|" << trade.tradeId << "|" << symbol 
-                                     << "|" << tradePrice << "|" << tradeQuantity
-                                     << "|Client#" << buyOrder.clientId << "|Client#" << order.clientId << endl;
-                            tradeFile.close();
-                        }
-                        
-                        if (buyOrder.remainingQuantity == 0) {
-                            book.buyOrders.pop_front();
-                        }
-                    } else {
-                        break;
-                    }
-                }
+            found = true;
+            out << "DEFTER|" << snapshot.symbol << "|" << snapshot.version << "|" << snapshot.timestampNs << endl;
+            for (int i = 0; i < snapshot.bidCount && i < depth; i++) {
+                out << "ALIS|" << snapshot.bids[i].price << "|" << snapshot.bids[i].quantity 
+                    << "|" << snapshot.bids[i].orderCount << endl;
             }
-            
-            if (order.remainingQuantity > 0) {
-                if (order.type == "AL") {
-                    deque<Order>::iterator it = book.buyOrders.begin();
-                    while (it != book.buyOrders.end() && it->price > order.price) {
-                        ++it;
-                    }
-                    book.buyOrders.insert(it, order);
-                } else {
-                    deque<Order>::iterator it = book.sellOrders.begin();
-                    while (it != book.sellOrders.end() && it->price < order.price) {
-                        ++it;
-                    }
-                    book.sellOrders.insert(it, order);
-                }
+            for (int i = 0; i < snapshot.askCount && i < depth; i++) {
+                out << "SATIS|" << snapshot.asks[i].price << "|" << snapshot.asks[i].quantity 
+                    << "|" << snapshot.asks[i].orderCount << endl;
             }
-            
-            pthread_mutex_unlock(&orderBookMutex);
-            saveOrderBook();
-            
-            string response = "ORDER_ACCEPTED|" + order.orderId + "\n";
-            send(clientSocket, response.c_str(), response.length(), 0);
-        } else {
-            string response = "OK\n";
-            send(clientSocket, response.c_str(), response.length(), 0);
+            break;
+        }
+        if (!allBooks && !found) {
+            out << "HATA|Sembol bulunamadi: " << symbol << endl;
         }
+        return out.str();
     }
     
-    pthread_mutex_lock(&clientSocketMutex);
-    clientSockets.erase(clientId);
-    pthread_mutex_unlock(&clientSocketMutex);
-
-    close(clientSocket);
-    
-    pthread_mutex_lock(&clientCountMutex);
-    activeClients--;
-    cout << "[" << getTimestamp() << "] Client #" << clientId 
-         << " ayrıldı (Aktif: " << activeClients << ")" << endl;
-    pthread_mutex_unlock(&clientCountMutex);
-    
-    delete clientData;
-    return NULL;
+    runCommand(command, out);
+    return out.str();
 }
 
-void showHelp() {
-    cout << "\n=== SERVER KOMUTLARI ===" << endl;
-    cout << "  emirler  - Son emirleri göster" << endl;
-    cout << "  ozet     - Günlük özet raporu" << endl;
-    cout << "  aktif    - Aktif client sayısı" << endl;
-    cout << "  temizle  - Ekranı temizle" << endl;
-    cout << "  bekleyen - Order book durumu (alış/satış emirleri)" << endl;
-    cout << "  islemler - Günün gerçekleşen işlemlerini göster" << endl;
-    cout << "  cikis    - Server'ı kapat" << endl;
-    cout << "========================" << endl;
-}
+AdminChannel adminChannel(handleAdminCommand);
 
 void* commandHandler(void* arg) {
     string command;
-    while (serverRunning) {
-        getline(cin, command);
-        
-        if (command == "emirler") {
-            displayServerOrders();
-        } else if (command == "ozet") {
-            displayDailySummary();
-        } else if (command == "aktif") {
-            pthread_mutex_lock(&clientCountMutex);
-            cout << "\nAktif client sayısı: " << activeClients << endl;
-            pthread_mutex_unlock(&clientCountMutex);
-        } else if (command == "temizle") {
-            system("clear");
-        } else if (command == "bekleyen") {
-            displayOrderBook();
-        } else if (command == "islemler") {
-            displayTradeSummary();
-        } else if (command == "yardim") {
-            showHelp();
-        } else if (command == "cikis") {
-            cout << "\nServer kapatılıyor..." << endl;
-            saveOrderBook();
-            serverRunning = false;
-            close(globalServerSocket);
-            exit(0);
-        } else if (!command.empty()) {
-            cout << "Bilinmeyen komut. 'yardim' yazarak komutları görebilirsiniz." << endl;
-        }
+    // Arka planda (stdin kapalı) çalışırken komutlar yalnızca yönetim kanalından gelir.
+    while (serverRunning && getline(cin, command)) {
+        runCommand(command, cout);
     }
     return NULL;
 }
+
 int main() {
     ConfigReader config;
     config.load("config.ini");
     
     int port = config.getInt("server", "port", 5001);
     int maxClients = config.getInt("server", "max_clients", 10);
+    serverStartNs = getNanos();
+    
+    flightRecorder.configure(config.getInt("flight", "records_per_thread", 4096));
+    if (flightRecorder.enabled()) {
+        flightRecorder.installSignalHandlers(config.get("flight", "file", "flight_recorder.bin"));
+    }
     
     int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
     if (serverSocket < 0) {
@@ -930,7 +3256,58 @@ int main() {
         return 1;
     }
 
-    initStockPriceLimitsFromJson("stocks_config.json");
+    stocksConfigFile = config.get("stocks", "file", "stocks_config.json");
+    reloadStockConfig(stocksConfigFile);
+
+    for (int i = 0; i < SOCKET_LOCK_STRIPES; i++) {
+        pthread_mutex_init(&socketWriteMutex[i], NULL);
+    }
+    
+    marketData.configure(config.getInt("marketdata", "max_queue", 512),
+                         config.getInt("marketdata", "socket_buffer", 65536));
+    
+    tradeStore.configure(config.getInt("trades", "segment_size", 4096),
+                         config.getInt("trades", "max_segments", 16),
+                         config.getInt("trades", "candle_interval", 60),
+                         config.get("trades", "spill_file", "trades_spill.bin"));
+    
+    loadThrottleLimits("config.ini");
+    cancelOnDisconnect = config.getInt("orders", "cancel_on_disconnect", 0) != 0;
+    defaultTimeInForce = config.get("tif", "default", "DAY");
+    sessionEnd = config.get("tif", "session_end", "18:00");
+    expiryWheel.start(time(0));
+    
+    replicationRole = config.get("replication", "role", "none");
+    int replicationPort = config.getInt("replication", "port", 5200);
+    
+    drainTimeoutMs = config.getInt("admin", "drain_timeout_ms", 5000);
+    string adminSocket = config.get("admin", "socket", "borsa_admin.sock");
+    if (!adminSocket.empty()) {
+        if (adminChannel.start(adminSocket)) {
+            cout << "Yönetim soketi: " << adminSocket << endl;
+        } else {
+            cerr << "Yönetim soketi açılamadı: " << adminSocket << endl;
+        }
+    }
+
+    pthread_t commandThread;
+    bool commandThreadStarted = false;
+    if (replicationRole == "standby") {
+        pthread_create(&commandThread, NULL, commandHandler, NULL);
+        pthread_detach(commandThread);
+        commandThreadStarted = true;
+        
+        marketData.start();
+        runStandby(config.get("replication", "primary_host", "127.0.0.1"), replicationPort,
+                   config.getInt("replication", "heartbeat_timeout_ms", 500));
+    }
+    
+    if (config.getInt("shm", "enabled", 0)) {
+        string shmName = config.get("shm", "name", "/borsa_md");
+        if (!mdRing.open(shmName, config.getInt("shm", "capacity", 65536))) {
+            cerr << "Paylaşımlı bellek halkası açılamadı: " << shmName << endl;
+        }
+    }
     
     globalServerSocket = serverSocket;
     
@@ -943,10 +3320,15 @@ int main() {
     serverAddress.sin_addr.s_addr = INADDR_ANY;
     serverAddress.sin_port = htons(port);
     
-   if (::bind(serverSocket, (struct sockaddr*)&serverAddress, sizeof(serverAddress)) < 0) {
-    cerr << "Port " << port << " kullanımda!" << endl;
-    close(serverSocket);
-    return 1;
+    // Devralan yedek, eski primary'nin portu bırakmasını kısa bir süre bekler.
+    int bindAttempts = failoverDetectedNs > 0 ? 50 : 1;
+    while (::bind(serverSocket, (struct sockaddr*)&serverAddress, sizeof(serverAddress)) < 0) {
+        if (--bindAttempts <= 0) {
+            cerr << "Port " << port << " kullanımda!" << endl;
+            close(serverSocket);
+            return 1;
+        }
+        usleep(100000);
     }
     
     if (listen(serverSocket, maxClients) < 0) {
@@ -961,18 +3343,76 @@ int main() {
     cout << "===================" << endl;
     cout << "\n'yardim' yazarak komutları görebilirsiniz.\n" << endl;
     
-    loadOrderBook();
+    if (failoverDetectedNs > 0) {
+        stringstream takeover;
+        takeover << fixed << setprecision(1) << (getNanos() - failoverDetectedNs) / 1000000.0;
+        failoverReport += ", devralma " + takeover.str() + " ms";
+        cout << "[" << getTimestamp() << "] Primary olarak hizmette (devralma " 
+             << takeover.str() << " ms)" << endl;
+    } else {
+        loadOrderBook();
+        loadPositions();
+        marketData.start();
+    }
+    
+    if (replicationRole == "primary") {
+        replication.start(config.get("replication", "mode", "async") == "ack",
+                          config.getInt("replication", "ack_timeout_ms", 200));
+        if (startReplicationPrimary(replicationPort)) {
+            cout << "Replikasyon portu: " << replicationPort << endl;
+        } else {
+            cerr << "Replikasyon portu " << replicationPort << " açılamadı!" << endl;
+        }
+    }
+    
+    int gatewayCount = config.getInt("gateway", "count", 0);
+    if (gatewayCount > 0) {
+        startGateways(gatewayCount, config.get("gateway", "queue_prefix", "/borsa_gw"),
+                      config.getInt("gateway", "queue_capacity", 4096));
+        cout << gatewayCount << " gateway kuyruğu hazır." << endl;
+    }
+
+    startAuctionScheduler(config.get("auction", "schedule", ""));
+    
+    simulator.configure(config.getInt("simulator", "threads", 2),
+                        config.getInt("simulator", "market_makers", 2),
+                        config.getInt("simulator", "momentum", 1),
+                        config.getInt("simulator", "noise", 2),
+                        config.getInt("simulator", "max_live_orders", 4));
+    if (config.getInt("simulator", "enabled", 0)) {
+        startSimulator(config.getInt("simulator", "rate", 0));
+        cout << "Simülatör başlatıldı." << endl;
+    }
+
+    pthread_t expiryThread;
+    pthread_create(&expiryThread, NULL, expiryTicker, NULL);
+    pthread_detach(expiryThread);
 
     pthread_t autoSaveThread;
     pthread_create(&autoSaveThread, NULL, autoSaveOrderBook, NULL);
     pthread_detach(autoSaveThread);
 
-    pthread_t commandThread;
-    pthread_create(&commandThread, NULL, commandHandler, NULL);
-    pthread_detach(commandThread);
-    
-    int clientCounter = 1;
+    sessions.setReplayLimit(config.getInt("session", "replay_buffer", 1024));
+    sessionResumeGrace = config.getInt("session", "resume_grace", 30);
+    if (cancelOnDisconnect) {
+        pthread_t sweeperThread;
+        pthread_create(&sweeperThread, NULL, sessionSweeper, NULL);
+        pthread_detach(sweeperThread);
+    }
+
+    int watchInterval = config.getInt("stocks", "watch_interval", 0);
+    if (watchInterval > 0) {
+        pthread_t watcherThread;
+        pthread_create(&watcherThread, NULL, stocksConfigWatcher, new int(watchInterval));
+        pthread_detach(watcherThread);
+    }
+
+    if (!commandThreadStarted) {
+        pthread_create(&commandThread, NULL, commandHandler, NULL);
+        pthread_detach(commandThread);
+    }
     
+    acceptLoopRunning = true;
     while (serverRunning) {
         struct sockaddr_in clientAddress;
         socklen_t clientAddressLength = sizeof(clientAddress);
@@ -986,15 +3426,25 @@ int main() {
             continue;
         }
         
+        if (draining.load()) {
+            string refusal = "Server kapanıyor, bağlantı kabul edilmiyor\n";
+            send(clientSocket, refusal.c_str(), refusal.length(), MSG_NOSIGNAL);
+            close(clientSocket);
+            continue;
+        }
+        
         ClientData* clientData = new ClientData;
         clientData->socket = clientSocket;
-        clientData->id = clientCounter++;
+        clientData->id = allocateClientId();
         
         pthread_t thread;
         pthread_create(&thread, NULL, handleClient, clientData);
         pthread_detach(thread);
     }
     
+    // Kapatmayı isteyen yönetim komutunun yanıtı gönderilsin.
+    adminChannel.stop(1000);
     close(serverSocket);
+    cout << "[" << getTimestamp() << "] Server kapatıldı." << endl;
     return 0;
 }
@@ -0,0 +1,223 @@
+#ifndef SESSION_REGISTRY_H
+#define SESSION_REGISTRY_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include "random_token.h"
+
+// Kalıcı anahtarla tanınan client oturumu. Server'dan client'a giden her mesaj
+// oturum sırasıyla numaralanır ve sınırlı bir tamponda tutulur; yeniden bağlanan
+// client son aldığı numarayı bildirir ve yalnızca kaçırdıklarını alır. Oturumu
+// sürdürmek için anahtarla birlikte açılışta verilen token da gösterilmelidir.
+struct ClientSession {
+    std::string key;
+    std::string token;
+    int clientId;
+    int socket;                 // -1: bağlı değil
+    int64_t detachedAt;         // epoch saniye
+    bool ordersCancelled;
+    uint64_t lastSeq;
+    std::deque<std::pair<uint64_t, std::string> > replay;
+    std::unordered_set<std::string> references;     // işlenmiş client emir referansları
+    std::deque<std::string> referenceOrder;
+};
+
+// Kilit tutmaz; çağıran clientSocketMutex altında kullanır.
+class SessionRegistry {
+private:
+    std::unordered_map<std::string, ClientSession*> byKey;
+    std::unordered_map<int, ClientSession*> byClient;
+    size_t replayLimit;
+
+    SessionRegistry(const SessionRegistry&);
+    SessionRegistry& operator=(const SessionRegistry&);
+
+public:
+    SessionRegistry() : replayLimit(1024) {}
+
+    ~SessionRegistry() {
+        for (std::unordered_map<std::string, ClientSession*>::iterator it = byKey.begin(); it != byKey.end(); ++it) {
+            delete it->second;
+        }
+    }
+
+    void setReplayLimit(size_t limit) {
+        replayLimit = limit > 0 ? limit : 1;
+    }
+
+    ClientSession* find(int clientId) {
+        std::unordered_map<int, ClientSession*>::iterator it = byClient.find(clientId);
+        return it != byClient.end() ? it->second : NULL;
+    }
+
+    // Anahtar yeniyse oturum clientId ile ve yeni bir token ile açılır, varsa eski
+    // client numarası korunur. Token tutmazsa (veya üretilemezse) NULL döner ve
+    // mevcut bağlantıya dokunulmaz. previousSocket hâlâ açık görünen eski bağlantıdır.
+    ClientSession* attach(const std::string& key, const std::string& token, int clientId, int socket,
+                          bool& resumed, int& previousSocket) {
+        resumed = false;
+        previousSocket = -1;
+        std::unordered_map<std::string, ClientSession*>::iterator it = byKey.find(key);
+        if (it == byKey.end()) {
+            std::string issued = randomToken();
+            if (issued.empty()) return NULL;
+            ClientSession* session = new ClientSession();
+            session->key = key;
+            session->token = issued;
+            session->clientId = clientId;
+            session->socket = socket;
+            session->detachedAt = 0;
+            session->ordersCancelled = false;
+            session->lastSeq = 0;
+            byKey[key] = session;
+            byClient[clientId] = session;
+            return session;
+        }
+
+        ClientSession* session = it->second;
+        if (token.empty() || token != session->token) return NULL;
+        previousSocket = session->socket != socket ? session->socket : -1;
+        session->socket = socket;
+        session->detachedAt = 0;
+        session->ordersCancelled = false;
+        resumed = true;
+        return session;
+    }
+
+    // Bağlantı oturumun güncel bağlantısı değilse (yerine yenisi geçtiyse) dokunulmaz.
+    void detach(ClientSession& session, int socket, int64_t now) {
+        if (session.socket != socket) return;
+        session.socket = -1;
+        session.detachedAt = now;
+    }
+
+    // Mesaja sıra numarası verip tampona yazar; gönderilecek satırı döner.
+    std::string sequence(ClientSession& session, const std::string& message) {
+        std::string line = "S|" + std::to_string(++session.lastSeq) + "|" + message;
+        session.replay.push_back(std::make_pair(session.lastSeq, line));
+        if (session.replay.size() > replayLimit) {
+            session.replay.pop_front();
+        }
+        return line;
+    }
+
+    // lastSeq'ten sonraki mesajlar; bir kısmı tampondan düşmüşse false döner.
+    bool replaySince(const ClientSession& session, uint64_t lastSeq, std::vector<std::string>& lines) const {
+        bool complete = session.replay.empty() ? lastSeq >= session.lastSeq
+                                               : lastSeq + 1 >= session.replay.front().first;
+        for (size_t i = 0; i < session.replay.size(); i++) {
+            if (session.replay[i].first > lastSeq) {
+                lines.push_back(session.replay[i].second);
+            }
+        }
+        return complete;
+    }
+
+    uint64_t firstAvailable(const ClientSession& session) const {
+        return session.replay.empty() ? session.lastSeq + 1 : session.replay.front().first;
+    }
+
+    // Aynı referansla yeniden gönderilen emir false döner ve işlenmez. Yanıtı
+    // tampondadır; client yeniden bağlanırken zaten alır.
+    bool claimReference(ClientSession& session, const std::string& reference) {
+        if (!session.references.insert(reference).second) return false;
+        session.referenceOrder.push_back(reference);
+        if (session.referenceOrder.size() > replayLimit) {
+            session.references.erase(session.referenceOrder.front());
+            session.referenceOrder.pop_front();
+        }
+        return true;
+    }
+
+    // Kalıcı kayıt ve yedek senkronu için: anahtar|token|clientId|lastSeq|ref|ref...
+    // Referanslar talep sırasıyla yazılır; referanslar '|' içeremez.
+    std::vector<std::string> records() const {
+        std::vector<std::string> result;
+        for (std::unordered_map<std::string, ClientSession*>::const_iterator it = byKey.begin(); it != byKey.end(); ++it) {
+            result.push_back(record(*it->second));
+        }
+        return result;
+    }
+
+    std::string record(const ClientSession& session) const {
+        std::string line = session.key + "|" + session.token + "|" + std::to_string(session.clientId)
+                           + "|" + std::to_string(session.lastSeq);
+        for (size_t i = 0; i < session.referenceOrder.size(); i++) {
+            line += "|" + session.referenceOrder[i];
+        }
+        return line;
+    }
+
+    // Kayıttan oturumu kopuk olarak kurar, aynı anahtarlı oturum varsa üzerine yazar.
+    // Emirleri yeniden başlatma yüzünden iptal edilmesin diye sweeper'a düşmez; client
+    // dönüp yeniden koparsa normal süre işler.
+    bool restore(const std::string& line, int64_t now) {
+        std::stringstream ss(line);
+        std::string key, token, clientIdStr, seqStr, reference;
+        std::getline(ss, key, '|');
+        std::getline(ss, token, '|');
+        std::getline(ss, clientIdStr, '|');
+        std::getline(ss, seqStr, '|');
+        int clientId = atoi(clientIdStr.c_str());
+        if (key.empty() || token.empty() || clientId <= 0) return false;
+
+        ClientSession* session;
+        std::unordered_map<std::string, ClientSession*>::iterator it = byKey.find(key);
+        if (it != byKey.end()) {
+            session = it->second;
+            if (session->socket >= 0) return false;
+            byClient.erase(session->clientId);
+            session->references.clear();
+            session->referenceOrder.clear();
+        } else {
+            session = new ClientSession();
+            session->key = key;
+            session->socket = -1;
+            byKey[key] = session;
+        }
+        session->token = token;
+        session->clientId = clientId;
+        session->detachedAt = now;
+        session->ordersCancelled = true;
+        session->lastSeq = strtoull(seqStr.c_str(), NULL, 10);
+        session->replay.clear();
+        while (std::getline(ss, reference, '|')) {
+            if (!reference.empty()) claimReference(*session, reference);
+        }
+        byClient[clientId] = session;
+        return true;
+    }
+
+    // Bağlantısı grace saniyeden uzun süredir kopuk oturumlar; her oturum bir kez döner.
+    std::vector<int> abandoned(int64_t now, int grace) {
+        std::vector<int> result;
+        for (std::unordered_map<std::string, ClientSession*>::iterator it = byKey.begin(); it != byKey.end(); ++it) {
+            ClientSession* session = it->second;
+            if (session->socket < 0 && !session->ordersCancelled && now - session->detachedAt >= grace) {
+                session->ordersCancelled = true;
+                result.push_back(session->clientId);
+            }
+        }
+        return result;
+    }
+
+    size_t size() const {
+        return byKey.size();
+    }
+
+    size_t connected() const {
+        size_t count = 0;
+        for (std::unordered_map<std::string, ClientSession*>::const_iterator it = byKey.begin(); it != byKey.end(); ++it) {
+            if (it->second->socket >= 0) count++;
+        }
+        return count;
+    }
+};
+
+#endif
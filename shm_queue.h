@@ -0,0 +1,136 @@
+#ifndef SHM_QUEUE_H
+#define SHM_QUEUE_H
+
+#include <string>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const uint64_t SHM_QUEUE_MAGIC = 0x42525351554555ULL;
+
+// Paylaşımlı bellekte tek üretici / tek tüketici kuyruğu. T sabit boyutlu,
+// memcpy ile kopyalanabilir olmalıdır. head tüketici, tail üretici tarafından ilerletilir.
+template <typename T>
+class ShmSpscQueue {
+private:
+    struct Header {
+        uint64_t magic;
+        uint32_t capacity;
+        uint32_t itemSize;
+        alignas(64) std::atomic<uint64_t> head;
+        alignas(64) std::atomic<uint64_t> tail;
+    };
+
+    Header* header;
+    T* items;
+    size_t mappedSize;
+    uint64_t mask;
+    uint64_t cachedHead;
+    uint64_t cachedTail;
+
+    bool map(int fd, size_t size) {
+        void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (memory == MAP_FAILED) return false;
+
+        mappedSize = size;
+        header = (Header*)memory;
+        items = (T*)((char*)memory + sizeof(Header));
+        return true;
+    }
+
+public:
+    ShmSpscQueue() : header(NULL), items(NULL), mappedSize(0), mask(0), cachedHead(0), cachedTail(0) {}
+
+    ~ShmSpscQueue() {
+        close();
+    }
+
+    bool create(const std::string& name, uint32_t capacity) {
+        uint32_t size = 1;
+        while (size < capacity) size <<= 1;
+
+        int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+        if (fd < 0) return false;
+
+        size_t total = sizeof(Header) + (size_t)size * sizeof(T);
+        if (ftruncate(fd, total) != 0) {
+            ::close(fd);
+            return false;
+        }
+        if (!map(fd, total)) return false;
+
+        memset((void*)header, 0, total);
+        header->capacity = size;
+        header->itemSize = sizeof(T);
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = SHM_QUEUE_MAGIC;
+
+        mask = size - 1;
+        return true;
+    }
+
+    bool attach(const std::string& name) {
+        int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+            ::close(fd);
+            return false;
+        }
+        if (!map(fd, st.st_size)) return false;
+
+        if (header->magic != SHM_QUEUE_MAGIC || header->itemSize != sizeof(T)) {
+            close();
+            return false;
+        }
+
+        mask = header->capacity - 1;
+        cachedHead = header->head.load(std::memory_order_acquire);
+        cachedTail = header->tail.load(std::memory_order_acquire);
+        return true;
+    }
+
+    void close() {
+        if (header) {
+            munmap((void*)header, mappedSize);
+            header = NULL;
+            items = NULL;
+        }
+    }
+
+    bool isOpen() const {
+        return header != NULL;
+    }
+
+    bool push(const T& item) {
+        uint64_t tail = header->tail.load(std::memory_order_relaxed);
+        if (tail - cachedHead > mask) {
+            cachedHead = header->head.load(std::memory_order_acquire);
+            if (tail - cachedHead > mask) return false;
+        }
+
+        memcpy(&items[tail & mask], &item, sizeof(T));
+        header->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) {
+        uint64_t head = header->head.load(std::memory_order_relaxed);
+        if (head == cachedTail) {
+            cachedTail = header->tail.load(std::memory_order_acquire);
+            if (head == cachedTail) return false;
+        }
+
+        memcpy(&item, &items[head & mask], sizeof(T));
+        header->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+#endif
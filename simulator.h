@@ -0,0 +1,305 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <pthread.h>
+#include <unistd.h>
+#include "book_snapshot.h"
+
+struct SimInstrument {
+    std::string symbol;
+    double basePrice;
+    double tickSize;
+    double minPrice;
+    double maxPrice;
+    int snapshotSlot;
+};
+
+enum SimAgentType {
+    SIM_MARKET_MAKER = 0,
+    SIM_MOMENTUM = 1,
+    SIM_NOISE = 2
+};
+
+// Emir kitapta kalırsa emir numarasını, tamamen eşleştiyse boş string döner.
+typedef std::string (*SimSubmitFn)(int clientId, const std::string& symbol, bool buy,
+                                   double price, int quantity);
+typedef bool (*SimCancelFn)(const std::string& symbol, const std::string& orderId);
+
+// Sunucu içinde çalışan sentetik trader'lar. Emirler soket olmadan doğrudan
+// eşleştirme motoruna verilir; kitap durumu kilitsiz snapshot'lardan okunur.
+// Her ajan kitapta en fazla maxLive emir tutar, fazlasını en eskiden iptal eder.
+class MarketSimulator {
+private:
+    struct Agent {
+        int type;
+        int clientId;
+        int instrument;
+        double lastMid;
+        std::deque<std::string> live;
+    };
+
+    struct Worker {
+        MarketSimulator* owner;
+        std::vector<Agent> agents;
+        uint64_t seed;
+        pthread_t thread;
+    };
+
+    const SnapshotRegistry& registry;
+    SimSubmitFn submit;
+    SimCancelFn cancel;
+
+    int threadCount;
+    int makersPerSymbol;
+    int momentumPerSymbol;
+    int noisePerSymbol;
+    int maxLive;
+
+    std::vector<SimInstrument> instruments;
+    std::vector<Worker*> workers;
+    std::atomic<bool> running;
+    std::atomic<long long> targetRate;
+    std::atomic<long long> ordersSent;
+    std::atomic<long long> cancelsSent;
+    int64_t startedNs;
+
+    static int64_t monotonicNanos() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+
+    static uint64_t nextRandom(uint64_t& state) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    static double clampToTick(const SimInstrument& instrument, double price) {
+        double tick = instrument.tickSize > 0 ? instrument.tickSize : 0.01;
+        double low = std::ceil(instrument.minPrice / tick - 1e-9) * tick;
+        double high = std::floor(instrument.maxPrice / tick + 1e-9) * tick;
+        double rounded = std::round(price / tick) * tick;
+        if (rounded < low) rounded = low;
+        if (rounded > high) rounded = high;
+        return rounded;
+    }
+
+    void place(Agent& agent, const SimInstrument& instrument, bool buy, double price, int quantity) {
+        std::string orderId = submit(agent.clientId, instrument.symbol, buy,
+                                     clampToTick(instrument, price), quantity);
+        ordersSent.fetch_add(1, std::memory_order_relaxed);
+        if (!orderId.empty()) {
+            agent.live.push_back(orderId);
+        }
+
+        while ((int)agent.live.size() > maxLive) {
+            cancel(instrument.symbol, agent.live.front());
+            agent.live.pop_front();
+            cancelsSent.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Gönderilen emir sayısını döner.
+    int step(Agent& agent, uint64_t& seed) {
+        const SimInstrument& instrument = instruments[agent.instrument];
+        double tick = instrument.tickSize > 0 ? instrument.tickSize : 0.01;
+
+        BookSnapshot book;
+        double bestBid = 0, bestAsk = 0;
+        if (registry.read(instrument.snapshotSlot, book)) {
+            if (book.bidCount > 0) bestBid = book.bids[0].price;
+            if (book.askCount > 0) bestAsk = book.asks[0].price;
+        }
+
+        double mid = agent.lastMid;
+        if (bestBid > 0 && bestAsk > 0) mid = (bestBid + bestAsk) / 2;
+        else if (bestBid > 0) mid = bestBid + tick;
+        else if (bestAsk > 0) mid = bestAsk - tick;
+
+        uint64_t r = nextRandom(seed);
+        int placed = 0;
+
+        if (agent.type == SIM_MARKET_MAKER) {
+            // Adil değer baz fiyata doğru hafifçe geri çekilir, kotasyon etrafında kurulur.
+            double fair = mid + (instrument.basePrice - mid) * 0.01 + ((int)(r % 3) - 1) * tick;
+            double halfSpread = tick * (1 + (r >> 8) % 3);
+            int quantity = 10 * (1 + (int)((r >> 16) % 10));
+            double bid = std::floor((fair - halfSpread) / tick) * tick;
+            double ask = std::ceil((fair + halfSpread) / tick) * tick;
+            place(agent, instrument, true, bid, quantity);
+            place(agent, instrument, false, ask, quantity);
+            placed = 2;
+        } else if (agent.type == SIM_MOMENTUM) {
+            int quantity = 10 * (1 + (int)((r >> 16) % 5));
+            bool up = mid > agent.lastMid + tick / 2;
+            bool down = mid < agent.lastMid - tick / 2;
+            if (!up && !down && r % 8 == 0) {
+                up = (r >> 4) & 1;
+                down = !up;
+            }
+            if (up) {
+                place(agent, instrument, true, (bestAsk > 0 ? bestAsk : mid) + tick, quantity);
+                placed = 1;
+            } else if (down) {
+                place(agent, instrument, false, (bestBid > 0 ? bestBid : mid) - tick, quantity);
+                placed = 1;
+            }
+        } else {
+            bool buy = r & 1;
+            int offset = (int)((r >> 4) % 11) - 5;
+            int quantity = 10 * (1 + (int)((r >> 16) % 20));
+            place(agent, instrument, buy, mid + (buy ? -offset : offset) * tick, quantity);
+            placed = 1;
+        }
+
+        agent.lastMid = mid;
+        return placed;
+    }
+
+    static void* workerLoop(void* arg) {
+        Worker* worker = (Worker*)arg;
+        MarketSimulator* self = worker->owner;
+        if (worker->agents.empty()) return NULL;
+
+        int64_t started = monotonicNanos();
+        long long sent = 0;
+        long long steps = 0;
+        long long pacedRate = 0;
+        size_t next = 0;
+
+        while (self->running.load(std::memory_order_relaxed)) {
+            sent += self->step(worker->agents[next], worker->seed);
+            next = (next + 1) % worker->agents.size();
+
+            // Hedef hız verilmişse her 64 adımda bir programın önündeysek uyunur.
+            long long rate = self->targetRate.load(std::memory_order_relaxed);
+            if (rate != pacedRate) {
+                pacedRate = rate;
+                started = monotonicNanos();
+                sent = 0;
+            }
+            if (rate > 0 && (++steps & 63) == 0) {
+                double perThread = (double)rate / self->workers.size();
+                int64_t due = started + (int64_t)(sent / perThread * 1e9);
+                int64_t now = monotonicNanos();
+                if (due > now) {
+                    usleep((useconds_t)((due - now) / 1000));
+                } else if (now - due > 1000000000LL) {
+                    started = now;
+                    sent = 0;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < worker->agents.size(); i++) {
+            Agent& agent = worker->agents[i];
+            while (!agent.live.empty()) {
+                self->cancel(self->instruments[agent.instrument].symbol, agent.live.front());
+                agent.live.pop_front();
+            }
+        }
+        return NULL;
+    }
+
+public:
+    MarketSimulator(const SnapshotRegistry& snapshots, SimSubmitFn submitFn, SimCancelFn cancelFn)
+        : registry(snapshots), submit(submitFn), cancel(cancelFn), threadCount(2),
+          makersPerSymbol(2), momentumPerSymbol(1), noisePerSymbol(2), maxLive(4),
+          running(false), targetRate(0), ordersSent(0), cancelsSent(0), startedNs(0) {}
+
+    void configure(int threads, int makers, int momentum, int noise, int liveOrders) {
+        threadCount = threads > 0 ? threads : 1;
+        makersPerSymbol = makers;
+        momentumPerSymbol = momentum;
+        noisePerSymbol = noise;
+        maxLive = liveOrders > 0 ? liveOrders : 1;
+    }
+
+    // rate: saniyedeki toplam emir hedefi, 0 ise sınırsız.
+    bool start(const std::vector<SimInstrument>& universe, long long rate) {
+        if (running.load() || universe.empty()) return false;
+
+        instruments = universe;
+        targetRate.store(rate);
+        ordersSent.store(0);
+        cancelsSent.store(0);
+
+        for (int i = 0; i < threadCount; i++) {
+            Worker* worker = new Worker;
+            worker->owner = this;
+            worker->seed = 0x9E3779B97F4A7C15ULL * (i + 1) ^ (uint64_t)monotonicNanos();
+            workers.push_back(worker);
+        }
+
+        int agentCount = 0;
+        int counts[3] = { makersPerSymbol, momentumPerSymbol, noisePerSymbol };
+        for (size_t s = 0; s < instruments.size(); s++) {
+            for (int type = 0; type < 3; type++) {
+                for (int n = 0; n < counts[type]; n++) {
+                    Agent agent;
+                    agent.type = type;
+                    agent.clientId = -(agentCount + 1);
+                    agent.instrument = (int)s;
+                    agent.lastMid = instruments[s].basePrice;
+                    workers[agentCount % threadCount]->agents.push_back(agent);
+                    agentCount++;
+                }
+            }
+        }
+
+        running.store(true);
+        startedNs = monotonicNanos();
+        for (size_t i = 0; i < workers.size(); i++) {
+            pthread_create(&workers[i]->thread, NULL, workerLoop, workers[i]);
+        }
+        return true;
+    }
+
+    void stop() {
+        if (!running.exchange(false)) return;
+        for (size_t i = 0; i < workers.size(); i++) {
+            pthread_join(workers[i]->thread, NULL);
+            delete workers[i];
+        }
+        workers.clear();
+    }
+
+    void setRate(long long rate) {
+        targetRate.store(rate);
+    }
+
+    bool isRunning() const {
+        return running.load();
+    }
+
+    std::string status() const {
+        std::ostringstream out;
+        long long orders = ordersSent.load();
+        double seconds = running.load() ? (monotonicNanos() - startedNs) / 1e9 : 0;
+        long long rate = targetRate.load();
+
+        out << "Durum: " << (running.load() ? "çalışıyor" : "durdu") << "\n"
+            << "Thread: " << threadCount << ", sembol başına ajan: " << makersPerSymbol
+            << " piyasa yapıcı / " << momentumPerSymbol << " momentum / " << noisePerSymbol << " gürültü\n"
+            << "Hedef hız: " << (rate > 0 ? std::to_string(rate) + " emir/sn" : std::string("sınırsız")) << "\n"
+            << "Gönderilen emir: " << orders << ", iptal: " << cancelsSent.load();
+        if (seconds > 0) {
+            out << std::fixed << std::setprecision(0) << ", ortalama " << orders / seconds << " emir/sn";
+        }
+        out << "\n";
+        return out.str();
+    }
+};
+
+#endif
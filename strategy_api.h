@@ -0,0 +1,86 @@
+#ifndef STRATEGY_API_H
+#define STRATEGY_API_H
+
+#include <cstdint>
+
+// Otomatik strateji arayüzü. Geri çağrılar client'ın strateji thread'inde sırayla
+// çalışır; olaylar sabit boyutludur ve önceden ayrılmış kuyruktan gelir. Geri çağrı
+// yolunda (olay, emir, iptal) bellek ayrılmaz; stratejinin kendisi de ayırmamalıdır.
+//
+// Strateji client'a derlenmiş olarak ([strategy] name=momentum) ya da paylaşımlı
+// kütüphane olarak ([strategy] name=./benim.so) yüklenir. Kütüphane
+//   extern "C" Strategy* create_strategy(const char* params);
+// fonksiyonunu dışa açar ve şöyle derlenir: g++ -std=c++17 -O2 -shared -fPIC -o benim.so benim.cpp
+
+const int STRATEGY_SYMBOL_SIZE = 16;
+const int STRATEGY_ORDER_ID_SIZE = 32;
+
+enum MarketEventType {
+    MARKET_DEPTH = 1,       // kitap baştan kuruldu
+    MARKET_LEVEL = 2,       // seviye değişti
+    MARKET_TRADE = 3
+};
+
+// En iyi seviyeler olay işlendikten sonraki durumdur; taraf boşsa fiyat ve adet 0.
+struct MarketEvent {
+    int type;
+    char symbol[STRATEGY_SYMBOL_SIZE];
+    double bidPrice;
+    int bidQuantity;
+    double askPrice;
+    int askQuantity;
+    double tradePrice;      // yalnızca MARKET_TRADE
+    int tradeQuantity;
+    int64_t receivedNs;     // CLOCK_MONOTONIC, soketten okunduğu an
+};
+
+enum OrderEventType {
+    ORDER_ACCEPTED = 1,
+    ORDER_REJECTED = 2,
+    ORDER_FILLED = 3,       // kısmi veya tam dolum; quantity bu işlemin adedi
+    ORDER_CANCELLED = 4,    // quantity iptal edilen kalan
+    ORDER_EXPIRED = 5,
+    ORDER_CANCEL_REJECTED = 6   // emir artık kitapta değil
+};
+
+struct OrderEvent {
+    int type;
+    int ref;                // sendOrder dönüş değeri
+    char orderId[STRATEGY_ORDER_ID_SIZE];
+    char symbol[STRATEGY_SYMBOL_SIZE];
+    bool buy;
+    double price;           // dolumda işlem fiyatı, diğerlerinde emir fiyatı
+    int quantity;
+    int64_t receivedNs;
+};
+
+class StrategyContext {
+public:
+    virtual ~StrategyContext() {}
+
+    // Emir referansı döner; bağlantı yoksa veya gönderilemezse -1. tif NULL ise
+    // server varsayılanı (DAY, GTC, IOC, FOK, GTD:SS:DD).
+    virtual int sendOrder(const char* symbol, bool buy, double price, int quantity, const char* tif) = 0;
+    virtual bool cancelOrder(const char* orderId) = 0;
+    // onTimer çağrı aralığı; 0 kapatır.
+    virtual void setTimer(int intervalMs) = 0;
+    virtual int64_t nowNs() const = 0;
+};
+
+class Strategy {
+public:
+    virtual ~Strategy() {}
+    virtual void onStart(StrategyContext&) {}
+    virtual void onMarketData(StrategyContext&, const MarketEvent&) {}
+    virtual void onOrder(StrategyContext&, const OrderEvent&) {}
+    virtual void onTimer(StrategyContext&, int64_t) {}
+    virtual void onStop(StrategyContext&) {}
+};
+
+extern "C" {
+    typedef Strategy* (*CreateStrategyFn)(const char* params);
+}
+
+#define STRATEGY_FACTORY_SYMBOL "create_strategy"
+
+#endif
@@ -0,0 +1,363 @@
+#ifndef STRATEGY_RUNNER_H
+#define STRATEGY_RUNNER_H
+
+#include <atomic>
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <ctime>
+#include <pthread.h>
+#include <unistd.h>
+#include "strategy_api.h"
+
+// Nanosaniye gecikmeleri için 2'nin kuvveti kovalı histogram; kayıt ayırmasızdır.
+// Yüzdelikler kova üst sınırı olarak raporlanır (en fazla 2 kat yanılır).
+class LatencyHistogram {
+private:
+    static const int BUCKETS = 48;
+    std::atomic<uint64_t> buckets[BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<int64_t> sumNs;
+    std::atomic<int64_t> minNs;
+    std::atomic<int64_t> maxNs;
+
+public:
+    LatencyHistogram() {
+        reset();
+    }
+
+    void reset() {
+        for (int i = 0; i < BUCKETS; i++) {
+            buckets[i].store(0);
+        }
+        total.store(0);
+        sumNs.store(0);
+        minNs.store(INT64_MAX);
+        maxNs.store(0);
+    }
+
+    // Tek yazar (strateji thread'i); okuyucular yaklaşık değer görebilir.
+    void record(int64_t ns) {
+        if (ns < 0) ns = 0;
+        int bucket = 0;
+        while (bucket < BUCKETS - 1 && (int64_t)1 << (bucket + 1) <= ns) bucket++;
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        sumNs.fetch_add(ns, std::memory_order_relaxed);
+        if (ns < minNs.load(std::memory_order_relaxed)) minNs.store(ns, std::memory_order_relaxed);
+        if (ns > maxNs.load(std::memory_order_relaxed)) maxNs.store(ns, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const {
+        return total.load();
+    }
+
+    int64_t minimum() const {
+        return count() > 0 ? minNs.load() : 0;
+    }
+
+    int64_t maximum() const {
+        return maxNs.load();
+    }
+
+    int64_t average() const {
+        uint64_t n = count();
+        return n > 0 ? sumNs.load() / (int64_t)n : 0;
+    }
+
+    int64_t percentile(double p) const {
+        uint64_t n = count();
+        if (n == 0) return 0;
+        uint64_t target = (uint64_t)(p * n);
+        if (target >= n) target = n - 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += buckets[i].load();
+            if (seen > target) {
+                int64_t upper = (int64_t)1 << (i + 1);
+                return upper < maximum() ? upper : maximum();
+            }
+        }
+        return maximum();
+    }
+};
+
+// Okuma thread'inden strateji thread'ine olay taşıyan tek üreticili/tek tüketicili
+// halka. Piyasa verisi halkanın dörtte üçünü doldurunca düşürülür ve sayılır; kalan
+// yer emir olaylarınındır. Emir olayları (kabul, red, dolum, iptal) hiç düşmez: halka
+// tamamen doluysa kilitli bir taşma kuyruğuna yazılır. Okuma thread'i beklemez, çünkü
+// stateMutex'i tutar ve strateji geri çağrıları aynı kilidi ister.
+// Tüketici yalnızca kuyruk boşken uyur; üretici yalnızca tüketici uyuyorsa sinyal verir.
+class StrategyRunner {
+public:
+    struct Event {
+        int kind;               // EVENT_MARKET veya EVENT_ORDER
+        MarketEvent market;
+        OrderEvent order;
+    };
+
+    enum { EVENT_MARKET = 1, EVENT_ORDER = 2 };
+
+private:
+    static const int64_t SPIN_NS = 50000;
+
+    Strategy* strategy;
+    StrategyContext* context;
+    std::vector<Event> ring;
+    uint64_t mask;
+    uint64_t marketLimit;       // piyasa olaylarının kullanabileceği en fazla yuva
+    alignas(64) std::atomic<uint64_t> head;     // üretici
+    alignas(64) std::atomic<uint64_t> tail;     // tüketici
+    // Taşma varken üretici halkaya yazmaz; tüketici halkayı bitirince taşmayı alır,
+    // böylece emir olaylarının sırası korunur.
+    std::atomic<bool> overflowing;
+    pthread_mutex_t overflowMutex;
+    std::deque<Event> overflow;
+    std::atomic<bool> sleeping;
+    std::atomic<bool> running;
+    pthread_mutex_t wakeMutex;
+    pthread_cond_t wake;
+    pthread_t thread;
+    bool started;
+    int64_t spinNs;
+
+    int64_t timerIntervalNs;
+    int64_t nextTimerNs;
+    int64_t currentEventNs;     // işlenen olayın geliş anı; zamanlayıcıda 0
+
+    std::atomic<uint64_t> processed;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> overflowed;
+    LatencyHistogram tickToOrder;
+    LatencyHistogram queueDelay;
+
+    StrategyRunner(const StrategyRunner&);
+    StrategyRunner& operator=(const StrategyRunner&);
+
+    static void* threadMain(void* arg) {
+        ((StrategyRunner*)arg)->loop();
+        return NULL;
+    }
+
+    void dispatch(const Event& event) {
+        int64_t receivedNs = event.kind == EVENT_MARKET ? event.market.receivedNs : event.order.receivedNs;
+        currentEventNs = receivedNs;
+        queueDelay.record(monotonicNanos() - receivedNs);
+        if (event.kind == EVENT_MARKET) {
+            strategy->onMarketData(*context, event.market);
+        } else {
+            strategy->onOrder(*context, event.order);
+        }
+        currentEventNs = 0;
+        processed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void drainOverflow() {
+        std::deque<Event> events;
+        pthread_mutex_lock(&overflowMutex);
+        events.swap(overflow);
+        overflowing.store(false, std::memory_order_release);
+        pthread_mutex_unlock(&overflowMutex);
+        for (size_t i = 0; i < events.size() && running.load(); i++) {
+            dispatch(events[i]);
+        }
+    }
+
+    bool pending() const {
+        return head.load(std::memory_order_acquire) != tail.load(std::memory_order_relaxed)
+               || overflowing.load(std::memory_order_acquire);
+    }
+
+    void signal() {
+        if (sleeping.load()) {
+            pthread_mutex_lock(&wakeMutex);
+            pthread_cond_signal(&wake);
+            pthread_mutex_unlock(&wakeMutex);
+        }
+    }
+
+    void runTimer() {
+        if (timerIntervalNs <= 0) return;
+        int64_t now = monotonicNanos();
+        if (now < nextTimerNs) return;
+        nextTimerNs = now + timerIntervalNs;
+        strategy->onTimer(*context, now);
+    }
+
+    // Uyumadan önce kısa süre kuyruğu yoklar; sık gelen olaylarda uyandırma gecikmesi
+    // ve üreticinin sinyal maliyeti ödenmez. Tek çekirdekte yoklama üreticiyi bekletir.
+    void waitForEvent() {
+        int64_t spinUntil = monotonicNanos() + spinNs;
+        while (monotonicNanos() < spinUntil) {
+            if (pending()) return;
+        }
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        int64_t waitNs = timerIntervalNs > 0 ? nextTimerNs - monotonicNanos() : 100000000;
+        if (waitNs <= 0) return;
+        deadline.tv_sec += waitNs / 1000000000;
+        deadline.tv_nsec += waitNs % 1000000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        pthread_mutex_lock(&wakeMutex);
+        sleeping.store(true);
+        if (!pending() && running.load()) {
+            pthread_cond_timedwait(&wake, &wakeMutex, &deadline);
+        }
+        sleeping.store(false);
+        pthread_mutex_unlock(&wakeMutex);
+    }
+
+    void loop() {
+        strategy->onStart(*context);
+        while (running.load()) {
+            uint64_t position = tail.load(std::memory_order_relaxed);
+            if (position != head.load(std::memory_order_acquire)) {
+                dispatch(ring[position & mask]);
+                tail.store(position + 1, std::memory_order_release);
+            } else if (overflowing.load(std::memory_order_acquire)) {
+                drainOverflow();
+            } else {
+                waitForEvent();
+            }
+            runTimer();
+        }
+        strategy->onStop(*context);
+    }
+
+public:
+    explicit StrategyRunner(size_t capacity = 4096)
+        : strategy(NULL), context(NULL), head(0), tail(0), overflowing(false), sleeping(false), running(false),
+          started(false), spinNs(sysconf(_SC_NPROCESSORS_ONLN) > 1 ? SPIN_NS : 0),
+          timerIntervalNs(0), nextTimerNs(0), currentEventNs(0), processed(0), dropped(0), overflowed(0) {
+        size_t size = 4;
+        while (size < capacity) size <<= 1;
+        ring.resize(size);
+        mask = size - 1;
+        marketLimit = size - size / 4;
+        pthread_mutex_init(&overflowMutex, NULL);
+
+        pthread_condattr_t attributes;
+        pthread_condattr_init(&attributes);
+        pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+        pthread_cond_init(&wake, &attributes);
+        pthread_condattr_destroy(&attributes);
+        pthread_mutex_init(&wakeMutex, NULL);
+    }
+
+    ~StrategyRunner() {
+        stop();
+        pthread_mutex_destroy(&wakeMutex);
+        pthread_cond_destroy(&wake);
+        pthread_mutex_destroy(&overflowMutex);
+    }
+
+    static int64_t monotonicNanos() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+
+    bool start(Strategy* instance, StrategyContext* owner) {
+        if (started) return false;
+        strategy = instance;
+        context = owner;
+        running.store(true);
+        if (pthread_create(&thread, NULL, threadMain, this) != 0) {
+            running.store(false);
+            return false;
+        }
+        started = true;
+        return true;
+    }
+
+    // Kalan olaylar işlenmez; onStop strateji thread'inde çağrılır.
+    void stop() {
+        if (!started) return;
+        running.store(false);
+        pthread_mutex_lock(&wakeMutex);
+        pthread_cond_signal(&wake);
+        pthread_mutex_unlock(&wakeMutex);
+        pthread_join(thread, NULL);
+        started = false;
+    }
+
+    bool active() const {
+        return started;
+    }
+
+    // Yalnızca okuma thread'i çağırır, piyasa olayları içindir. Yazılacak yuvayı döner;
+    // emir olaylarına ayrılan yere girilecekse veya taşma bekliyorsa olay düşer (NULL).
+    Event* reserve() {
+        uint64_t position = head.load(std::memory_order_relaxed);
+        if (overflowing.load(std::memory_order_acquire)
+            || position - tail.load(std::memory_order_acquire) >= marketLimit) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return NULL;
+        }
+        return &ring[position & mask];
+    }
+
+    void publish() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+        signal();
+    }
+
+    // Yalnızca okuma thread'i çağırır. Emir olayı halkaya, halka doluysa taşma kuyruğuna
+    // kopyalanır; kaybolmaz ve sırası korunur.
+    void publishOrder(const Event& event) {
+        if (!overflowing.load(std::memory_order_acquire)) {
+            uint64_t position = head.load(std::memory_order_relaxed);
+            if (position - tail.load(std::memory_order_acquire) <= mask) {
+                ring[position & mask] = event;
+                publish();
+                return;
+            }
+        }
+        pthread_mutex_lock(&overflowMutex);
+        overflow.push_back(event);
+        overflowing.store(true, std::memory_order_seq_cst);
+        pthread_mutex_unlock(&overflowMutex);
+        overflowed.fetch_add(1, std::memory_order_relaxed);
+        signal();
+    }
+
+    // Strateji thread'inden; bir olayın geri çağrısında gönderilen her emir ve iptal için
+    // olayın soketten okunmasından mesajın sokete yazılmasına kadar geçen süre kaydedilir.
+    void orderSent(int64_t sentNs) {
+        if (currentEventNs > 0) {
+            tickToOrder.record(sentNs - currentEventNs);
+        }
+    }
+
+    void setTimer(int intervalMs) {
+        timerIntervalNs = intervalMs > 0 ? (int64_t)intervalMs * 1000000 : 0;
+        nextTimerNs = monotonicNanos() + timerIntervalNs;
+    }
+
+    uint64_t processedCount() const {
+        return processed.load();
+    }
+
+    uint64_t droppedCount() const {
+        return dropped.load();
+    }
+
+    uint64_t overflowCount() const {
+        return overflowed.load();
+    }
+
+    const LatencyHistogram& latency() const {
+        return tickToOrder;
+    }
+
+    const LatencyHistogram& queueLatency() const {
+        return queueDelay;
+    }
+};
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef TERMINAL_SCREEN_H
+#define TERMINAL_SCREEN_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+
+enum CellStyle {
+    STYLE_NORMAL = 0,
+    STYLE_BOLD,
+    STYLE_DIM,
+    STYLE_UP,       // yeşil
+    STYLE_DOWN,     // kırmızı
+    STYLE_HEADER,   // ters renk
+    STYLE_COUNT
+};
+
+// Hücre tabanlı terminal ekranı. Çizim arka tampona yapılır; render() ön tamponla
+// karşılaştırıp yalnızca değişen hücreler için ANSI imleç konumlandırma, stil ve
+// karakter yazar. Ardışık değişen hücrelerde imleç yeniden konumlandırılmaz, stil
+// yalnızca değiştiğinde yazılır. Her karakterin tek sütun kapladığı varsayılır.
+class TerminalScreen {
+private:
+    struct Cell {
+        uint32_t ch;
+        uint8_t style;
+
+        bool operator==(const Cell& other) const {
+            return ch == other.ch && style == other.style;
+        }
+    };
+
+    int rows;
+    int cols;
+    std::vector<Cell> front;
+    std::vector<Cell> back;
+    bool fullRedraw;
+
+    static Cell blank() {
+        Cell cell = { ' ', STYLE_NORMAL };
+        return cell;
+    }
+
+    // Geçersiz UTF-8 baytı '?' olarak alınır.
+    static uint32_t decode(const std::string& text, size_t& i) {
+        unsigned char c = text[i++];
+        if (c < 0x80) return c;
+
+        int extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : -1;
+        if (extra < 0 || i + extra > text.size()) return '?';
+        uint32_t code = c & (0x3F >> extra);
+        for (int k = 0; k < extra; k++) {
+            code = (code << 6) | (text[i++] & 0x3F);
+        }
+        return code;
+    }
+
+    static void encode(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out += (char)code;
+        } else if (code < 0x800) {
+            out += (char)(0xC0 | (code >> 6));
+            out += (char)(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += (char)(0xE0 | (code >> 12));
+            out += (char)(0x80 | ((code >> 6) & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        } else {
+            out += (char)(0xF0 | (code >> 18));
+            out += (char)(0x80 | ((code >> 12) & 0x3F));
+            out += (char)(0x80 | ((code >> 6) & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+    }
+
+    static const char* styleSequence(int style) {
+        static const char* sequences[STYLE_COUNT] = {
+            "\x1b[0m", "\x1b[0;1m", "\x1b[0;2m", "\x1b[0;32m", "\x1b[0;31m", "\x1b[0;7m"
+        };
+        return style >= 0 && style < STYLE_COUNT ? sequences[style] : sequences[0];
+    }
+
+public:
+    TerminalScreen() : rows(0), cols(0), fullRedraw(true) {}
+
+    // Boyut değişirse bir sonraki render ekranı temizleyip baştan çizer.
+    void resize(int newRows, int newCols) {
+        if (newRows == rows && newCols == cols) return;
+        rows = newRows;
+        cols = newCols;
+        back.assign(rows * cols, blank());
+        front.assign(rows * cols, blank());
+        fullRedraw = true;
+    }
+
+    int height() const {
+        return rows;
+    }
+
+    int width() const {
+        return cols;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < back.size(); i++) {
+            back[i] = blank();
+        }
+    }
+
+    // Satır sonunda kırpılır; yazılan sütun sayısı döner.
+    int put(int row, int col, const std::string& text, int style = STYLE_NORMAL) {
+        if (row < 0 || row >= rows || col >= cols) return 0;
+
+        int written = 0;
+        size_t i = 0;
+        while (i < text.size() && col + written < cols) {
+            Cell cell;
+            cell.ch = decode(text, i);
+            cell.style = (uint8_t)style;
+            if (col + written >= 0) {
+                back[row * cols + col + written] = cell;
+            }
+            written++;
+        }
+        return written;
+    }
+
+    // Satırın kalanını stil ile doldurur (başlık çubukları için).
+    void fill(int row, int col, int style) {
+        if (row < 0 || row >= rows) return;
+        for (int c = col < 0 ? 0 : col; c < cols; c++) {
+            back[row * cols + c].style = (uint8_t)style;
+        }
+    }
+
+    // Değişiklik yoksa out boş kalır.
+    void render(std::string& out) {
+        if (fullRedraw) {
+            out += "\x1b[0m\x1b[2J";
+            for (size_t i = 0; i < front.size(); i++) {
+                front[i] = blank();
+            }
+            fullRedraw = false;
+        }
+
+        int cursor = -1;
+        int currentStyle = -1;
+        char position[32];
+        for (int i = 0; i < rows * cols; i++) {
+            if (back[i] == front[i]) continue;
+
+            if (i != cursor) {
+                snprintf(position, sizeof(position), "\x1b[%d;%dH", i / cols + 1, i % cols + 1);
+                out += position;
+            }
+            if (back[i].style != currentStyle) {
+                currentStyle = back[i].style;
+                out += styleSequence(currentStyle);
+            }
+            encode(out, back[i].ch);
+            front[i] = back[i];
+            // Son sütuna yazınca terminal imleci satır başına taşımayabilir.
+            cursor = (i + 1) % cols == 0 ? -1 : i + 1;
+        }
+        if (currentStyle > STYLE_NORMAL) {
+            out += styleSequence(STYLE_NORMAL);
+        }
+    }
+};
+
+#endif
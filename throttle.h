@@ -0,0 +1,314 @@
+#ifndef THROTTLE_H
+#define THROTTLE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <atomic>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <pthread.h>
+#include <unistd.h>
+
+enum ThrottleVerdict {
+    THROTTLE_PASS = 0,
+    THROTTLE_REJECT,
+    THROTTLE_DISCONNECT
+};
+
+struct ThrottleLimits {
+    double ordersPerSecond;     // 0: sınırsız
+    double orderBurst;
+    double messagesPerSecond;
+    double messageBurst;
+    bool delay;                 // true: token birikene kadar beklet, false: reddet
+    int maxDelayMs;             // bekleme bundan uzun sürecekse reddedilir
+    int disconnectAfter;        // art arda bu kadar aşımda bağlantı kesilir; 0: kesilmez
+};
+
+// Bir mesajın maliyeti sabittir: birikimi hesaplamak için bir çarpma ve karşılaştırma.
+class TokenBucket {
+private:
+    double rate;
+    double burst;
+    double tokens;
+    int64_t lastNs;
+
+public:
+    TokenBucket() : rate(0), burst(1), tokens(1), lastNs(0) {}
+
+    void configure(double perSecond, double capacity, int64_t nowNs) {
+        rate = perSecond;
+        burst = capacity >= 1 ? capacity : 1;
+        tokens = burst;
+        lastNs = nowNs;
+    }
+
+    // Token varsa harcar ve 0 döner; yoksa bir tokenın birikmesine kalan süre (ns).
+    int64_t take(int64_t nowNs) {
+        if (rate <= 0) return 0;
+        tokens = std::min(burst, tokens + (nowNs - lastNs) * rate / 1e9);
+        lastNs = nowNs;
+        if (tokens >= 1) {
+            tokens -= 1;
+            return 0;
+        }
+        return (int64_t)((1 - tokens) * 1e9 / rate) + 1;
+    }
+
+    // Önceki bağlantının kovasından devam eder; limit değiştiyse yeni kapasiteye kırpılır.
+    void resume(const TokenBucket& previous) {
+        tokens = std::min(burst, previous.tokens);
+        lastNs = previous.lastNs;
+    }
+
+    bool fullAt(int64_t nowNs) const {
+        return rate <= 0 || tokens + (nowNs - lastNs) * rate / 1e9 >= burst;
+    }
+};
+
+struct ThrottleCounters {
+    std::atomic<long long> messages;
+    std::atomic<long long> rejected;
+    std::atomic<long long> delayed;
+    std::atomic<long long> delayNs;
+    std::atomic<long long> disconnects;
+
+    ThrottleCounters() : messages(0), rejected(0), delayed(0), delayNs(0), disconnects(0) {}
+};
+
+// Kopan bağlantının kova durumu; aynı client numarası yeniden bağlanınca sürer.
+struct ThrottleState {
+    TokenBucket orderBucket;
+    TokenBucket messageBucket;
+    int consecutive;
+};
+
+// Bir bağlantının kovaları. Yalnızca bağlantının kendi thread'i admit çağırır;
+// sayaçlar atomiktir, konsoldan okunabilir. Bekletme yalnızca bu thread'i uyutur,
+// kilit tutulmadığından diğer client'lar etkilenmez.
+class ClientThrottle {
+private:
+    ThrottleLimits limits;
+    TokenBucket orderBucket;
+    TokenBucket messageBucket;
+    int consecutive;
+    ThrottleCounters* classCounters;
+    ThrottleCounters* totals;
+
+    ClientThrottle(const ClientThrottle&);
+    ClientThrottle& operator=(const ClientThrottle&);
+
+    int64_t waitFor(TokenBucket& bucket, bool mayDelay) {
+        int64_t waitNs = bucket.take(now());
+        if (waitNs == 0) return 0;
+        if (!mayDelay || !limits.delay || waitNs > (int64_t)limits.maxDelayMs * 1000000) return -1;
+
+        usleep((useconds_t)((waitNs + 999) / 1000));
+        counters.delayed.fetch_add(1, std::memory_order_relaxed);
+        counters.delayNs.fetch_add(waitNs, std::memory_order_relaxed);
+        classCounters->delayed.fetch_add(1, std::memory_order_relaxed);
+        classCounters->delayNs.fetch_add(waitNs, std::memory_order_relaxed);
+        totals->delayed.fetch_add(1, std::memory_order_relaxed);
+        return bucket.take(now()) == 0 ? waitNs : -1;
+    }
+
+public:
+    int clientId;
+    std::string className;
+    ThrottleCounters counters;
+
+    ClientThrottle() : consecutive(0), classCounters(NULL), totals(NULL), clientId(0) {
+        limits.ordersPerSecond = 0;
+        limits.orderBurst = 1;
+        limits.messagesPerSecond = 0;
+        limits.messageBurst = 1;
+        limits.delay = false;
+        limits.maxDelayMs = 0;
+        limits.disconnectAfter = 0;
+    }
+
+    static int64_t now() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+
+    // previous verilirse kovalar dolu başlamaz, önceki bağlantıdan kaldığı yerden sürer.
+    void configure(int id, const std::string& name, const ThrottleLimits& classLimits,
+                   ThrottleCounters* perClass, ThrottleCounters* all, const ThrottleState* previous) {
+        clientId = id;
+        className = name;
+        limits = classLimits;
+        classCounters = perClass;
+        totals = all;
+        int64_t start = now();
+        orderBucket.configure(limits.ordersPerSecond, limits.orderBurst, start);
+        messageBucket.configure(limits.messagesPerSecond, limits.messageBurst, start);
+        consecutive = 0;
+        if (previous != NULL) {
+            orderBucket.resume(previous->orderBucket);
+            messageBucket.resume(previous->messageBucket);
+            consecutive = previous->consecutive;
+        }
+    }
+
+    ThrottleState state() const {
+        ThrottleState saved = { orderBucket, messageBucket, consecutive };
+        return saved;
+    }
+
+    // Emirler (yeni emir, stop, iptal) hem mesaj hem emir kovasından harcar.
+    int admit(bool isOrder, bool mayDelay) {
+        counters.messages.fetch_add(1, std::memory_order_relaxed);
+        if (waitFor(messageBucket, mayDelay) >= 0 && (!isOrder || waitFor(orderBucket, mayDelay) >= 0)) {
+            consecutive = 0;
+            return THROTTLE_PASS;
+        }
+
+        counters.rejected.fetch_add(1, std::memory_order_relaxed);
+        classCounters->rejected.fetch_add(1, std::memory_order_relaxed);
+        totals->rejected.fetch_add(1, std::memory_order_relaxed);
+        if (limits.disconnectAfter > 0 && ++consecutive >= limits.disconnectAfter) {
+            counters.disconnects.fetch_add(1, std::memory_order_relaxed);
+            classCounters->disconnects.fetch_add(1, std::memory_order_relaxed);
+            totals->disconnects.fetch_add(1, std::memory_order_relaxed);
+            return THROTTLE_DISCONNECT;
+        }
+        return THROTTLE_REJECT;
+    }
+};
+
+// Sınıf tabloları ve bağlı client'ların kovaları. Tablolar ve bağlantı listesi
+// yalnızca bağlanma/ayrılma ve konsolda kilitlenir; mesaj yolunda kilit yoktur.
+// Yeni limitler sonraki bağlantılardan itibaren geçerlidir.
+class ThrottleRegistry {
+private:
+    struct ClassEntry {
+        ThrottleLimits limits;
+        ThrottleCounters* counters;     // yeniden yüklemede korunur, silinmez
+    };
+
+    pthread_mutex_t mutex;
+    std::map<std::string, ClassEntry> classes;
+    std::map<int, std::string> clientClasses;
+    std::string gatewayClass;
+    std::set<ClientThrottle*> active;
+    std::map<int, ThrottleState> detached;      // kovaları henüz dolmamış kopuk client'lar
+    ThrottleCounters totalCounters;
+    std::map<std::string, ThrottleCounters*> retired;
+
+    static bool moreRejected(const ClientThrottle* a, const ClientThrottle* b) {
+        return a->counters.rejected.load() > b->counters.rejected.load();
+    }
+
+public:
+    static const char* defaultClass() {
+        return "varsayilan";
+    }
+
+    ThrottleRegistry() {
+        pthread_mutex_init(&mutex, NULL);
+        ThrottleLimits unlimited = { 0, 1, 0, 1, false, 0, 0 };
+        ClassEntry entry = { unlimited, new ThrottleCounters() };
+        classes[defaultClass()] = entry;
+    }
+
+    // perClass varsayılan sınıfı da içerir; clientClasses client numarasından sınıf adına.
+    void configure(const std::map<std::string, ThrottleLimits>& perClass,
+                   const std::map<int, std::string>& perClient, const std::string& gateway) {
+        pthread_mutex_lock(&mutex);
+        for (std::map<std::string, ClassEntry>::iterator it = classes.begin(); it != classes.end(); ++it) {
+            retired[it->first] = it->second.counters;
+        }
+        classes.clear();
+        for (std::map<std::string, ThrottleLimits>::const_iterator it = perClass.begin(); it != perClass.end(); ++it) {
+            std::map<std::string, ThrottleCounters*>::iterator old = retired.find(it->first);
+            ClassEntry entry = { it->second, old != retired.end() ? old->second : new ThrottleCounters() };
+            if (old != retired.end()) retired.erase(old);
+            classes[it->first] = entry;
+        }
+        clientClasses = perClient;
+        gatewayClass = gateway;
+        pthread_mutex_unlock(&mutex);
+    }
+
+    // Oturum sürdürülüp client numarası değiştiğinde de çağrılır. Aynı numaranın kopuk
+    // bağlantısından kalan kova durumu varsa oradan sürer; yeniden bağlanmak kovaları
+    // doldurmaz ve art arda aşım sayısını sıfırlamaz.
+    void attach(ClientThrottle& throttle, int clientId, bool gateway) {
+        pthread_mutex_lock(&mutex);
+        std::string name = defaultClass();
+        std::map<int, std::string>::const_iterator assigned = clientClasses.find(clientId);
+        if (assigned != clientClasses.end() && classes.count(assigned->second)) {
+            name = assigned->second;
+        } else if (gateway && !gatewayClass.empty() && classes.count(gatewayClass)) {
+            name = gatewayClass;
+        }
+        ClassEntry& entry = classes[name];
+        std::map<int, ThrottleState>::iterator previous = detached.find(clientId);
+        throttle.configure(clientId, name, entry.limits, entry.counters, &totalCounters,
+                           previous != detached.end() ? &previous->second : NULL);
+        if (previous != detached.end()) detached.erase(previous);
+        active.insert(&throttle);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    // Kova durumu saklanır; dolmuş kovalar yeni bağlantıyla aynı olduğundan atılır.
+    void detach(ClientThrottle& throttle) {
+        pthread_mutex_lock(&mutex);
+        active.erase(&throttle);
+        detached[throttle.clientId] = throttle.state();
+        int64_t now = ClientThrottle::now();
+        for (std::map<int, ThrottleState>::iterator it = detached.begin(); it != detached.end();) {
+            if (it->second.orderBucket.fullAt(now) && it->second.messageBucket.fullAt(now)) {
+                detached.erase(it++);
+            } else {
+                ++it;
+            }
+        }
+        pthread_mutex_unlock(&mutex);
+    }
+
+    const ThrottleCounters& totals() const {
+        return totalCounters;
+    }
+
+    std::string status(int topClients) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(0);
+        pthread_mutex_lock(&mutex);
+        for (std::map<std::string, ClassEntry>::const_iterator it = classes.begin(); it != classes.end(); ++it) {
+            const ThrottleLimits& limits = it->second.limits;
+            const ThrottleCounters& counters = *it->second.counters;
+            out << it->first << ": emir ";
+            if (limits.ordersPerSecond > 0) out << limits.ordersPerSecond << "/sn (" << limits.orderBurst << ")";
+            else out << "sınırsız";
+            out << ", mesaj ";
+            if (limits.messagesPerSecond > 0) out << limits.messagesPerSecond << "/sn (" << limits.messageBurst << ")";
+            else out << "sınırsız";
+            out << ", " << (limits.delay ? "beklet (en çok " + std::to_string(limits.maxDelayMs) + " ms)" : std::string("reddet"));
+            if (limits.disconnectAfter > 0) out << ", " << limits.disconnectAfter << " ardışık aşımda kes";
+            out << "\n    red=" << counters.rejected.load() << " bekletme=" << counters.delayed.load()
+                << " (" << counters.delayNs.load() / 1000000 << " ms) kesilen=" << counters.disconnects.load() << "\n";
+        }
+
+        std::vector<ClientThrottle*> clients(active.begin(), active.end());
+        std::sort(clients.begin(), clients.end(), moreRejected);
+        for (size_t i = 0; i < clients.size() && (int)i < topClients; i++) {
+            const ClientThrottle* client = clients[i];
+            if (client->counters.rejected.load() == 0 && client->counters.delayed.load() == 0) break;
+            out << "  Client#" << client->clientId << " [" << client->className << "] mesaj="
+                << client->counters.messages.load() << " red=" << client->counters.rejected.load()
+                << " bekletme=" << client->counters.delayed.load() << "\n";
+        }
+        pthread_mutex_unlock(&mutex);
+        return out.str();
+    }
+};
+
+#endif
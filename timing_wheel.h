@@ -0,0 +1,97 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct TimerEntry {
+    int64_t expiresAt;      // epoch saniye
+    std::string symbol;
+    std::string orderId;
+};
+
+// Saniye çözünürlüklü hiyerarşik zamanlayıcı çarkı: 4 seviye x 64 yuva
+// (64 sn, ~68 dk, ~3 gün, ~194 gün). Ekleme O(1); advance() yalnızca süresi
+// dolan yuvalara ve seviye sınırlarında bir üst yuvanın aşağı dağıtımına dokunur,
+// bekleyen toplam kayıt sayısından bağımsızdır. İptal yoktur: dolan kaydın emri
+// artık kitapta değilse çağıran tarafından yok sayılır.
+class TimingWheel {
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const int64_t SLOT_MASK = SLOTS - 1;
+
+    std::vector<TimerEntry> slots[LEVELS][SLOTS];
+    std::vector<TimerEntry> overflow;
+    int64_t current;
+    size_t pending;
+
+    void place(const TimerEntry& entry) {
+        int64_t expiresAt = entry.expiresAt > current ? entry.expiresAt : current + 1;
+        int64_t delta = expiresAt - current;
+
+        for (int level = 0; level < LEVELS; level++) {
+            if (delta < ((int64_t)1 << (SLOT_BITS * (level + 1)))) {
+                slots[level][(expiresAt >> (SLOT_BITS * level)) & SLOT_MASK].push_back(entry);
+                return;
+            }
+        }
+        overflow.push_back(entry);
+    }
+
+    void cascade(int level) {
+        std::vector<TimerEntry> entries;
+        entries.swap(slots[level][(current >> (SLOT_BITS * level)) & SLOT_MASK]);
+        for (size_t i = 0; i < entries.size(); i++) {
+            place(entries[i]);
+        }
+
+        if (level == LEVELS - 1 && !overflow.empty()) {
+            std::vector<TimerEntry> far;
+            far.swap(overflow);
+            for (size_t i = 0; i < far.size(); i++) {
+                place(far[i]);
+            }
+        }
+    }
+
+public:
+    TimingWheel() : current(0), pending(0) {}
+
+    void start(int64_t now) {
+        current = now;
+    }
+
+    // Geçmiş bir zaman verilirse kayıt bir sonraki advance()'te döner.
+    void add(const TimerEntry& entry) {
+        place(entry);
+        pending++;
+    }
+
+    void advance(int64_t now, std::vector<TimerEntry>& expired) {
+        while (current < now) {
+            current++;
+
+            for (int level = LEVELS - 1; level > 0; level--) {
+                if ((current & (((int64_t)1 << (SLOT_BITS * level)) - 1)) == 0) {
+                    cascade(level);
+                }
+            }
+
+            std::vector<TimerEntry>& slot = slots[0][current & SLOT_MASK];
+            for (size_t i = 0; i < slot.size(); i++) {
+                expired.push_back(slot[i]);
+            }
+            pending -= slot.size();
+            slot.clear();
+        }
+    }
+
+    size_t size() const {
+        return pending;
+    }
+};
+
+#endif
@@ -0,0 +1,260 @@
+#ifndef TRADE_STORE_H
+#define TRADE_STORE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <fstream>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+
+struct SymbolStats {
+    double open;
+    double high;
+    double low;
+    double last;
+    long long volume;
+    double notional;
+    long long tradeCount;
+
+    SymbolStats() : open(0), high(0), low(0), last(0), volume(0), notional(0), tradeCount(0) {}
+
+    double vwap() const {
+        return volume > 0 ? notional / volume : 0;
+    }
+};
+
+struct Candle {
+    int64_t bucketStart;
+    double open;
+    double high;
+    double low;
+    double close;
+    long long volume;
+    double notional;
+    int tradeCount;
+};
+
+struct TradeRecord {
+    uint64_t seq;
+    uint32_t symbolId;
+    double price;
+    int quantity;
+    int buyerClientId;
+    int sellerClientId;
+    int64_t timestampNs;
+};
+
+// İşlemler sütunlar halinde, sabit boyutlu segmentlerde tutulur.
+// max_segments aşıldığında en eski segment diske yazılıp bellekten atılır.
+class TradeSegment {
+public:
+    uint64_t firstSeq;
+    std::vector<double> price;
+    std::vector<int> quantity;
+    std::vector<uint32_t> symbolId;
+    std::vector<int> buyer;
+    std::vector<int> seller;
+    std::vector<int64_t> timestampNs;
+
+    TradeSegment(uint64_t first, size_t capacity) : firstSeq(first) {
+        price.reserve(capacity);
+        quantity.reserve(capacity);
+        symbolId.reserve(capacity);
+        buyer.reserve(capacity);
+        seller.reserve(capacity);
+        timestampNs.reserve(capacity);
+    }
+
+    size_t size() const {
+        return price.size();
+    }
+};
+
+class TradeStore {
+private:
+    size_t segmentSize;
+    size_t maxSegments;
+    int64_t candleIntervalNs;
+    size_t maxCandles;
+    std::string spillFile;
+
+    std::deque<std::unique_ptr<TradeSegment> > segments;
+    uint64_t nextSeq;
+    uint64_t spilledCount;
+
+    std::map<std::string, uint32_t> symbolIds;
+    std::vector<std::string> symbolNames;
+    std::vector<SymbolStats> stats;
+    std::vector<std::deque<Candle> > candles;
+
+    void spill(const TradeSegment& segment) {
+        if (spillFile.empty()) return;
+
+        std::ofstream file(spillFile, std::ios::app | std::ios::binary);
+        if (!file.is_open()) return;
+
+        uint64_t count = segment.size();
+        file.write((const char*)&segment.firstSeq, sizeof(segment.firstSeq));
+        file.write((const char*)&count, sizeof(count));
+        file.write((const char*)segment.price.data(), count * sizeof(double));
+        file.write((const char*)segment.quantity.data(), count * sizeof(int));
+        file.write((const char*)segment.symbolId.data(), count * sizeof(uint32_t));
+        file.write((const char*)segment.buyer.data(), count * sizeof(int));
+        file.write((const char*)segment.seller.data(), count * sizeof(int));
+        file.write((const char*)segment.timestampNs.data(), count * sizeof(int64_t));
+        file.close();
+    }
+
+    void updateCandle(uint32_t id, double price, int quantity, int64_t timestampNs) {
+        std::deque<Candle>& series = candles[id];
+        int64_t bucket = timestampNs - (timestampNs % candleIntervalNs);
+
+        if (series.empty() || series.back().bucketStart != bucket) {
+            Candle candle;
+            candle.bucketStart = bucket;
+            candle.open = candle.high = candle.low = candle.close = price;
+            candle.volume = 0;
+            candle.notional = 0;
+            candle.tradeCount = 0;
+            series.push_back(candle);
+            if (series.size() > maxCandles) {
+                series.pop_front();
+            }
+        }
+
+        Candle& current = series.back();
+        current.high = std::max(current.high, price);
+        current.low = std::min(current.low, price);
+        current.close = price;
+        current.volume += quantity;
+        current.notional += price * quantity;
+        current.tradeCount++;
+    }
+
+public:
+    TradeStore(size_t segSize = 4096, size_t maxSegs = 16, int candleIntervalSec = 60,
+               const std::string& spillPath = "")
+        : segmentSize(segSize), maxSegments(maxSegs),
+          candleIntervalNs((int64_t)candleIntervalSec * 1000000000LL), maxCandles(240),
+          spillFile(spillPath), nextSeq(1), spilledCount(0) {}
+
+    void configure(size_t segSize, size_t maxSegs, int candleIntervalSec, const std::string& spillPath) {
+        segmentSize = std::max<size_t>(segSize, 1);
+        maxSegments = std::max<size_t>(maxSegs, 1);
+        candleIntervalNs = (int64_t)std::max(candleIntervalSec, 1) * 1000000000LL;
+        spillFile = spillPath;
+    }
+
+    uint32_t symbolId(const std::string& symbol) {
+        std::map<std::string, uint32_t>::iterator it = symbolIds.find(symbol);
+        if (it != symbolIds.end()) return it->second;
+
+        uint32_t id = symbolNames.size();
+        symbolIds[symbol] = id;
+        symbolNames.push_back(symbol);
+        stats.push_back(SymbolStats());
+        candles.push_back(std::deque<Candle>());
+        return id;
+    }
+
+    const std::string& symbolName(uint32_t id) const {
+        return symbolNames[id];
+    }
+
+    uint64_t append(const std::string& symbol, double price, int quantity,
+                    int buyerClientId, int sellerClientId, int64_t timestampNs) {
+        uint32_t id = symbolId(symbol);
+
+        if (segments.empty() || segments.back()->size() >= segmentSize) {
+            segments.push_back(std::unique_ptr<TradeSegment>(new TradeSegment(nextSeq, segmentSize)));
+            if (segments.size() > maxSegments) {
+                spill(*segments.front());
+                spilledCount += segments.front()->size();
+                segments.pop_front();
+            }
+        }
+
+        TradeSegment& segment = *segments.back();
+        segment.price.push_back(price);
+        segment.quantity.push_back(quantity);
+        segment.symbolId.push_back(id);
+        segment.buyer.push_back(buyerClientId);
+        segment.seller.push_back(sellerClientId);
+        segment.timestampNs.push_back(timestampNs);
+
+        SymbolStats& s = stats[id];
+        if (s.tradeCount == 0) {
+            s.open = s.high = s.low = price;
+        }
+        s.high = std::max(s.high, price);
+        s.low = std::min(s.low, price);
+        s.last = price;
+        s.volume += quantity;
+        s.notional += price * quantity;
+        s.tradeCount++;
+
+        updateCandle(id, price, quantity, timestampNs);
+
+        return nextSeq++;
+    }
+
+    bool getStats(const std::string& symbol, SymbolStats& out) const {
+        std::map<std::string, uint32_t>::const_iterator it = symbolIds.find(symbol);
+        if (it == symbolIds.end()) return false;
+        out = stats[it->second];
+        return true;
+    }
+
+    std::map<std::string, SymbolStats> allStats() const {
+        std::map<std::string, SymbolStats> result;
+        for (size_t i = 0; i < symbolNames.size(); i++) {
+            result[symbolNames[i]] = stats[i];
+        }
+        return result;
+    }
+
+    std::vector<Candle> getCandles(const std::string& symbol, size_t n) const {
+        std::vector<Candle> result;
+        std::map<std::string, uint32_t>::const_iterator it = symbolIds.find(symbol);
+        if (it == symbolIds.end()) return result;
+
+        const std::deque<Candle>& series = candles[it->second];
+        size_t start = series.size() > n ? series.size() - n : 0;
+        result.assign(series.begin() + start, series.end());
+        return result;
+    }
+
+    std::vector<TradeRecord> recentTrades(size_t n) const {
+        std::vector<TradeRecord> result;
+        for (std::deque<std::unique_ptr<TradeSegment> >::const_reverse_iterator it = segments.rbegin();
+             it != segments.rend() && result.size() < n; ++it) {
+            const TradeSegment& segment = **it;
+            for (size_t i = segment.size(); i > 0 && result.size() < n; i--) {
+                TradeRecord record;
+                record.seq = segment.firstSeq + i - 1;
+                record.symbolId = segment.symbolId[i - 1];
+                record.price = segment.price[i - 1];
+                record.quantity = segment.quantity[i - 1];
+                record.buyerClientId = segment.buyer[i - 1];
+                record.sellerClientId = segment.seller[i - 1];
+                record.timestampNs = segment.timestampNs[i - 1];
+                result.push_back(record);
+            }
+        }
+        std::reverse(result.begin(), result.end());
+        return result;
+    }
+
+    uint64_t totalTrades() const {
+        return nextSeq - 1;
+    }
+
+    uint64_t retainedTrades() const {
+        return totalTrades() - spilledCount;
+    }
+};
+
+#endif